@@ -37,8 +37,7 @@ void Label::onRender()
 	{
 		xpos = align(TextHAlign, Size.x, font->getFontWidth(lines.front()));
 
-		auto textImage = font->getString(lines.front());
-		fw().renderer->draw(textImage, Vec2<float>{xpos, ypos});
+		font->drawString(*fw().renderer, lines.front(), Vec2<float>{xpos, ypos});
 
 		lines.pop_front();
 		ypos += font->getFontHeight();
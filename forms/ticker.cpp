@@ -33,24 +33,21 @@ void Ticker::onRender()
 		xpos = align(TextHAlign, Size.x, font->getFontWidth(text));
 		ypos = 0;
 
-		auto textImage = font->getString(text);
-		fw().renderer->draw(textImage, Vec2<float>{xpos, ypos});
+		font->drawString(*fw().renderer, text, Vec2<float>{xpos, ypos});
 	}
 	else
 	{
 		UString out = text;
 		xpos = align(TextHAlign, Size.x, font->getFontWidth(out));
 		ypos = 0 - animTimer / 4;
-		auto outImage = font->getString(out);
-		fw().renderer->draw(outImage, Vec2<float>{xpos, ypos});
+		font->drawString(*fw().renderer, out, Vec2<float>{xpos, ypos});
 
 		if (!messages.empty())
 		{
 			UString in = messages.front();
 			xpos = align(TextHAlign, Size.x, font->getFontWidth(in));
 			ypos = 15 - animTimer / 4;
-			auto inImage = font->getString(in);
-			fw().renderer->draw(inImage, Vec2<float>{xpos, ypos});
+			font->drawString(*fw().renderer, in, Vec2<float>{xpos, ypos});
 		}
 	}
 }
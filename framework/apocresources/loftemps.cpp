@@ -93,4 +93,15 @@ sp<VoxelSlice> LOFTemps::getSlice(unsigned int idx)
 	return this->slices[idx];
 }
 
+size_t LOFTemps::getMemorySize() const
+{
+	size_t size = sizeof(*this);
+	for (auto &slice : this->slices)
+	{
+		// std::vector<bool> is packed, so 1 bit per voxel
+		size += sizeof(*slice) + slice->bits.size() / 8;
+	}
+	return size;
+}
+
 }; // namespace OpenApoc
@@ -17,5 +17,6 @@ class LOFTemps
   public:
 	LOFTemps(IFile &datFile, IFile &tabFile);
 	sp<VoxelSlice> getSlice(unsigned int idx);
+	size_t getMemorySize() const;
 };
 }; // namespace OpenApoc
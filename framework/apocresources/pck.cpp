@@ -5,13 +5,20 @@
 #include "framework/logger.h"
 #include "framework/trace.h"
 #include "library/sp.h"
+#include <algorithm>
+#include <cstring>
+#include <functional>
 #include <istream>
+#include <mutex>
 #include <vector>
 
 namespace OpenApoc
 {
 
 static const unsigned int IMAGE_STRIDE = 640;
+// The number of frames decoded by each thread pool task, as most frames are small enough that
+// a task per frame would spend more time queueing than decoding
+static const unsigned int FRAMES_PER_TASK = 32;
 
 #pragma pack(push, 1)
 struct PckHeader
@@ -37,17 +44,47 @@ struct PckRLE1Header
 #pragma pack(pop)
 static_assert(sizeof(struct PckRLE1Header) == 8, "RLE1Header not 8 bytes");
 
-static sp<PaletteImage> readPckCompression1(std::istream &input, Vec2<unsigned> size)
+namespace
+{
+
+// A read-only view of a whole PCK file in memory, so frames can be decoded concurrently without
+// sharing a stream position
+class PckBlob
+{
+  public:
+	const uint8_t *data;
+	size_t size;
+
+	PckBlob(const char *data, size_t size)
+	    : data(reinterpret_cast<const uint8_t *>(data)), size(size)
+	{
+	}
+
+	template <typename T> bool read(size_t &offset, T &out) const
+	{
+		if (offset > this->size || this->size - offset < sizeof(T))
+			return false;
+		memcpy(&out, this->data + offset, sizeof(T));
+		offset += sizeof(T);
+		return true;
+	}
+};
+
+} // anonymous namespace
+
+static sp<PaletteImage> readPckCompression1(const PckBlob &input, size_t offset,
+                                            Vec2<unsigned> size)
 {
 	auto img = mksp<PaletteImage>(size);
 
 	struct PckRLE1Header header;
 
-	input.read(reinterpret_cast<char *>(&header), sizeof(header));
+	bool valid = input.read(offset, header);
 
 	PaletteImageLock l(img, ImageLockUse::Write);
+	auto *indices = static_cast<uint8_t *>(l.getData());
 
-	while (input && header.pixelSkip != 0xffffffff)
+	while (valid && header.pixelSkip != 0xffffffff)
 	{
 		unsigned int col = header.pixelSkip % IMAGE_STRIDE;
 
@@ -58,21 +95,34 @@ static sp<PaletteImage> readPckCompression1(std::istream &input, Vec2<unsigned>
 			return nullptr;
 		}
 
-		for (unsigned int i = 0; i < header.pixelCount; i++)
+		if (offset > input.size || input.size - offset < header.pixelCount)
 		{
-			unsigned int x = (i + header.pixelSkip) % IMAGE_STRIDE;
-			unsigned int y = (i + header.pixelSkip) / IMAGE_STRIDE;
-			uint8_t idx = 0;
-			input.read(reinterpret_cast<char *>(&idx), sizeof(idx));
-			if (!input)
+			LogWarning("Unexpected EOF reading Pck RLE data");
+			return nullptr;
+		}
+
+		// A run can wrap past the end of the 640-pixel stride onto the next row, so copy it a row
+		// at a time, clipping anything outside the image
+		const uint8_t *src = input.data + offset;
+		unsigned int position = header.pixelSkip;
+		unsigned int remaining = header.pixelCount;
+		while (remaining > 0)
+		{
+			unsigned int x = position % IMAGE_STRIDE;
+			unsigned int y = position / IMAGE_STRIDE;
+			unsigned int runLength = std::min(remaining, IMAGE_STRIDE - x);
+			if (x < size.x && y < size.y)
 			{
-				LogWarning("Unexpected EOF reading Pck RLE data");
-				return nullptr;
+				unsigned int copyLength = std::min(runLength, size.x - x);
+				memcpy(indices + y * size.x + x, src, copyLength);
 			}
-			if (x < size.x && y < size.y)
-				l.set({x, y}, idx);
+			src += runLength;
+			position += runLength;
+			remaining -= runLength;
 		}
-		input.read(reinterpret_cast<char *>(&header), sizeof(header));
+		offset += header.pixelCount;
+
+		valid = input.read(offset, header);
 	}
 	return img;
 }
@@ -98,41 +148,64 @@ struct PckBlkSubHeader
 #pragma pack(pop)
 static_assert(sizeof(struct PckBlkSubHeader) == 5, "BlkSubHeader not 5 bytes");
 
-static sp<PaletteImage> readPckCompression3(std::istream &input, Vec2<unsigned> size)
+namespace
+{
+
+// xcom.blk is shared by every compression mode 3 frame, so it's loaded once the first time any
+// of them is decoded
+class BlkData
 {
-	static size_t blkSize;
-	static up<char[]> blkData;
+  public:
+	size_t size = 0;
+	up<char[]> data;
 
-	if (!blkData)
+	static const BlkData &get()
 	{
-		auto blkFile = fw().data->fs.open("xcom3/tacdata/xcom.blk");
-		if (!blkFile)
-		{
-			LogWarning("Failed to open xcom.blk");
-			return nullptr;
-		}
-		blkSize = blkFile.size();
-		blkData = std::move(blkFile.readAll());
-		LogInfo("Loaded %zu bytes of xcom.blk", blkSize);
+		static BlkData blk;
+		static std::once_flag loaded;
+		std::call_once(loaded, []() {
+			auto blkFile = fw().data->fs.open("xcom3/tacdata/xcom.blk");
+			if (!blkFile)
+			{
+				LogWarning("Failed to open xcom.blk");
+				return;
+			}
+			blk.size = blkFile.size();
+			blk.data = std::move(blkFile.readAll());
+			LogInfo("Loaded %zu bytes of xcom.blk", blk.size);
+		});
+		return blk;
+	}
+};
+
+} // anonymous namespace
+
+static sp<PaletteImage> readPckCompression3(const PckBlob &input, size_t offset,
+                                            Vec2<unsigned> size)
+{
+	auto &blk = BlkData::get();
+	if (!blk.data)
+	{
+		return nullptr;
 	}
 
 	auto img = mksp<PaletteImage>(size);
 
 	PaletteImageLock l(img, ImageLockUse::Write);
+	auto *indices = static_cast<uint8_t *>(l.getData());
 
 	struct PckBlkHeader header;
 
-	input.read(reinterpret_cast<char *>(&header), sizeof(header));
+	bool valid = input.read(offset, header);
 
-	while (input && header.rowRecords != 0xff && header.unknown != 0xffff && header.row != 0xff)
+	while (valid && header.rowRecords != 0xff && header.unknown != 0xffff && header.row != 0xff)
 	{
 		unsigned col = 0;
 		unsigned row = header.row;
 		for (unsigned record = 0; record < header.rowRecords; record++)
 		{
 			struct PckBlkSubHeader subHeader;
-			input.read(reinterpret_cast<char *>(&subHeader), sizeof(subHeader));
-			if (!input)
+			if (!input.read(offset, subHeader))
 			{
 				LogWarning("Unexpected EOF reading row header");
 				return nullptr;
@@ -141,57 +214,48 @@ static sp<PaletteImage> readPckCompression3(std::istream &input, Vec2<unsigned>
 			blkOffset =
 			    subHeader.blkOffset[0] | subHeader.blkOffset[1] << 8 | subHeader.blkOffset[2] << 16;
 			col += subHeader.pixelSkip;
-			for (unsigned i = 0; i < subHeader.pixelCount; i++)
+
+			unsigned count = subHeader.pixelCount;
+			if (blkOffset + count > blk.size)
 			{
-				if (blkOffset >= blkSize)
-				{
-					LogWarning("BLKOffset %u too large for xcom.blk size", blkOffset);
-				}
-				else
-				{
-					if (row < size.y && col < size.x)
-					{
-						l.set({col, row}, blkData[blkOffset]);
-					}
-					else
-					{
-						LogWarning("{%d,%d} out of bounds", col, row);
-					}
-				}
-				blkOffset++;
-				col++;
+				LogWarning("BLKOffset %u+%u too large for xcom.blk size", blkOffset, count);
+				count = blkOffset < blk.size ? blk.size - blkOffset : 0;
 			}
+			if (row >= size.y || col + count > size.x)
+			{
+				LogWarning("{%u,%u}+%u out of bounds", col, row, count);
+			}
+			if (row < size.y && col < size.x)
+			{
+				unsigned copyLength = std::min(count, size.x - col);
+				memcpy(indices + row * size.x + col, blk.data.get() + blkOffset, copyLength);
+			}
+			col += subHeader.pixelCount;
 		}
 
-		input.read(reinterpret_cast<char *>(&header), sizeof(header));
+		valid = input.read(offset, header);
 	}
 	return img;
 }
 
-static unsigned int guessTabMultiplier(IFile &pckFile, IFile &tabFile)
+static unsigned int guessTabMultiplier(size_t pckSize, const PckBlob &tab)
 {
 	// This tries to guess if the tab file contains (offset) or (offset/4) based on the last entry,
 	// if multiplying it by 4 is greater than the pck file size it's (offset), otherwise (offset/4)
-	auto pckSize = pckFile.size();
-	auto tabSize = tabFile.size();
-	if (tabSize < 4)
+	if (tab.size < 4)
 	{
-		LogWarning("Tab size %zu too small for a single entry?", tabSize);
+		LogWarning("Tab size %zu too small for a single entry?", tab.size);
 		return 0;
 	}
 
-	// Store the tab offset so we can restore the file state
-	auto tabOffset = tabFile.tellg();
-	tabFile.seekg(tabSize - 4);
+	size_t lastEntry = tab.size - 4;
 	uint32_t lastOffset;
-	tabFile.read(reinterpret_cast<char *>(&lastOffset), sizeof(lastOffset));
-	if (!tabFile)
+	if (!tab.read(lastEntry, lastOffset))
 	{
 		LogWarning("Failed to read last tab offset");
 		return 0;
 	}
-	tabFile.seekg(tabOffset);
-	if (lastOffset * 4 >= pckSize)
+	if ((size_t)lastOffset * 4 >= pckSize)
 	{
 		return 1;
 	}
@@ -201,23 +265,66 @@ static unsigned int guessTabMultiplier(IFile &pckFile, IFile &tabFile)
 	}
 }
 
+static sp<PaletteImage> readPckImage(const PckBlob &pck, size_t offset, const PckHeader &header,
+                                     unsigned int index)
+{
+	sp<PaletteImage> img;
+	switch (header.compressionMode)
+	{
+		case 0:
+			// 0 appears to mean a missing image?
+			img = mksp<PaletteImage>(Vec2<unsigned>{1, 1});
+			break;
+		case 1:
+			img = readPckCompression1(pck, offset, {header.rightClip, header.bottomClip});
+			break;
+		case 3:
+			img = readPckCompression3(pck, offset, {header.rightClip, header.bottomClip});
+			break;
+		default:
+			LogWarning("Unknown compression mode %u", (unsigned)header.compressionMode);
+			break;
+	}
+	if (!img)
+	{
+		LogInfo("No image at PCK index %u", index);
+		return nullptr;
+	}
+	img->calculateBounds();
+	return img;
+}
+
 sp<ImageSet> PCKLoader::load(Data &d, UString PckFilename, UString TabFilename)
 {
+	TRACE_FN_ARGS1("PckFilename", PckFilename);
 	auto imageSet = mksp<ImageSet>();
-	auto pck = d.fs.open(PckFilename);
-	if (!pck)
+	auto pckFile = d.fs.open(PckFilename);
+	if (!pckFile)
 	{
 		LogError("Failed to open PCK file \"%s\"", PckFilename);
 		return nullptr;
 	}
-	auto tab = d.fs.open(TabFilename);
-	if (!tab)
+	auto tabFile = d.fs.open(TabFilename);
+	if (!tabFile)
 	{
 		LogError("Failed to open TAB file \"%s\"", TabFilename);
 		return nullptr;
 	}
 
-	auto tabMultiplier = guessTabMultiplier(pck, tab);
+	// Pull both files into memory once, the decoders then only ever touch these buffers
+	auto pckSize = pckFile.size();
+	auto pckData = pckFile.readAll();
+	auto tabSize = tabFile.size();
+	auto tabData = tabFile.readAll();
+	if (!pckData || !tabData)
+	{
+		LogError("Failed to read \"%s\" / \"%s\"", PckFilename, TabFilename);
+		return nullptr;
+	}
+	PckBlob pck(pckData.get(), pckSize);
+	PckBlob tab(tabData.get(), tabSize);
+
+	auto tabMultiplier = guessTabMultiplier(pck.size, tab);
 	if (tabMultiplier == 0)
 	{
 		LogWarning("Failed to guess tab file type for \"%s\"", TabFilename);
@@ -226,56 +333,63 @@ sp<ImageSet> PCKLoader::load(Data &d, UString PckFilename, UString TabFilename)
 
 	LogInfo("Reading \"%s\" with tab multiplier %u", TabFilename, tabMultiplier);
 
-	unsigned int endIdx = (tab.size() / 4);
+	unsigned int endIdx = (tab.size / 4);
 
 	imageSet->images.resize(endIdx);
 	imageSet->maxSize = {0, 0};
 
+	// Read all the frame headers first, so the decoding can be split between threads
+	std::vector<size_t> frameOffsets;
+	std::vector<PckHeader> frameHeaders;
+	frameOffsets.reserve(endIdx);
+	frameHeaders.reserve(endIdx);
 	for (unsigned i = 0; i < endIdx; i++)
 	{
-		uint32_t pckOffset = 0;
-		tab.seekg(i * 4, std::ios_base::beg);
-		tab.read(reinterpret_cast<char *>(&pckOffset), sizeof(pckOffset));
-		if (!tab)
+		uint32_t tabOffset = 0;
+		size_t tabPosition = i * 4;
+		if (!tab.read(tabPosition, tabOffset))
 		{
 			LogWarning("Reached EOF reading tab index %u", i);
 			return nullptr;
 		}
-		pckOffset *= tabMultiplier;
+		size_t pckOffset = (size_t)tabOffset * tabMultiplier;
 		struct PckHeader header;
-		pck.seekg(pckOffset, std::ios_base::beg);
-		pck.read(reinterpret_cast<char *>(&header), sizeof(header));
-		if (!pck)
+		if (!pck.read(pckOffset, header))
 		{
 			LogInfo("Reached EOF reading PCK header at tab index %u", i);
 			break;
 		}
-		sp<PaletteImage> img;
+		frameOffsets.push_back(pckOffset);
+		frameHeaders.push_back(header);
+	}
 
-		switch (header.compressionMode)
-		{
-			case 0:
-				// 0 appears to mean a missing image?
-				img = mksp<PaletteImage>(Vec2<unsigned>{1, 1});
-				break;
-			case 1:
-				img = readPckCompression1(pck, {header.rightClip, header.bottomClip});
-				break;
-			case 3:
-				img = readPckCompression3(pck, {header.rightClip, header.bottomClip});
-				break;
-			default:
-				LogWarning("Unknown compression mode %u", (unsigned)header.compressionMode);
-				break;
-		}
+	// Each task writes only to its own slots in imageSet->images
+	unsigned int frameCount = frameHeaders.size();
+	std::vector<std::function<void()>> decodes;
+	for (unsigned int first = 0; first < frameCount; first += FRAMES_PER_TASK)
+	{
+		unsigned int last = std::min(first + FRAMES_PER_TASK, frameCount);
+		decodes.push_back([&pck, &frameOffsets, &frameHeaders, &imageSet, first, last]() {
+			for (unsigned int i = first; i < last; i++)
+			{
+				imageSet->images[i] = readPckImage(pck, frameOffsets[i], frameHeaders[i], i);
+			}
+		});
+	}
+	if (decodes.size() == 1)
+	{
+		decodes[0]();
+	}
+	else if (!decodes.empty())
+	{
+		d.prefetch(std::move(decodes))->wait();
+	}
+
+	for (auto &img : imageSet->images)
+	{
 		if (!img)
-		{
-			LogInfo("No image at PCK index %u", i);
 			continue;
-		}
-		img->calculateBounds();
 		img->owningSet = imageSet;
-		imageSet->images[i] = img;
 
 		if (img->size.x > imageSet->maxSize.x)
 			imageSet->maxSize.x = img->size.x;
@@ -6,75 +6,122 @@
 #include "framework/apocresources/rawimage.h"
 #include "framework/configfile.h"
 #include "framework/filesystem.h"
+#include "framework/framework.h"
 #include "framework/image.h"
 #include "framework/imageloader_interface.h"
 #include "framework/logger.h"
 #include "framework/musicloader_interface.h"
 #include "framework/palette.h"
+#include "framework/resourcecache.h"
 #include "framework/sampleloader_interface.h"
+#include "framework/sound.h"
 #include "framework/trace.h"
 #include "framework/video.h"
 #include "library/sp.h"
 #include "library/strings.h"
 #include "library/voxel.h"
+#include <atomic>
+#include <condition_variable>
 #include <fstream>
 #include <map>
 #include <mutex>
-#include <queue>
 
 using namespace OpenApoc;
 
 namespace OpenApoc
 {
 
-ConfigOptionInt imageCacheSize("Framework.Data", "ImageCacheSize",
-                               "Number of Images to keep in data cache", 100);
-ConfigOptionInt imageSetCacheSize("Framework.Data", "ImageSetCacheSize",
-                                  "Number of ImageSets to keep in data cache", 10);
-ConfigOptionInt voxelCacheSize("Framework.Data", "VoxelCacheSize",
-                               "Number of VoxelMaps to keep in data cache", 1);
-ConfigOptionInt fontStringCacheSize("Framework.Data", "FontStringCacheSize",
-                                    "Number of rendered font stings to keep in data cache", 100);
-ConfigOptionInt paletteCacheSize("Framework.Data", "PaletteCacheSize",
-                                 "Number of Palettes to keep in data cache", 10);
+ConfigOptionInt imageCacheSize("Framework.Data", "ImageCacheSizeMB",
+                               "Megabytes of Images to keep in data cache", 64);
+ConfigOptionInt imageSetCacheSize("Framework.Data", "ImageSetCacheSizeMB",
+                                  "Megabytes of ImageSets to keep in data cache", 64);
+ConfigOptionInt sampleCacheSize("Framework.Data", "SampleCacheSizeMB",
+                                "Megabytes of Samples to keep in data cache", 32);
+ConfigOptionInt voxelCacheSize("Framework.Data", "VoxelCacheSizeMB",
+                               "Megabytes of VoxelMaps to keep in data cache", 8);
+ConfigOptionInt fontStringCacheSize("Framework.Data", "FontStringCacheSizeMB",
+                                    "Megabytes of rendered font stings to keep in data cache", 4);
+ConfigOptionInt paletteCacheSize("Framework.Data", "PaletteCacheSizeMB",
+                                 "Megabytes of Palettes to keep in data cache", 1);
+
+namespace
+{
+
+size_t megabytes(int size) { return static_cast<size_t>(size) * 1024 * 1024; }
+
+size_t imageMemorySize(const Image &img)
+{
+	if (dynamic_cast<const PaletteImage *>(&img))
+		return img.size.x * img.size.y * sizeof(uint8_t);
+	if (dynamic_cast<const RGBImage *>(&img))
+		return img.size.x * img.size.y * sizeof(Colour);
+	return sizeof(img);
+}
+
+size_t imageSetMemorySize(const ImageSet &set)
+{
+	size_t size = sizeof(set);
+	for (auto &img : set.images)
+	{
+		if (img)
+			size += imageMemorySize(*img);
+	}
+	return size;
+}
+
+size_t sampleMemorySize(const Sample &sample)
+{
+	size_t bytesPerSample = 0;
+	switch (sample.format.format)
+	{
+		case AudioFormat::SampleFormat::PCM_SINT16:
+			bytesPerSample = 2;
+			break;
+		case AudioFormat::SampleFormat::PCM_UINT8:
+			bytesPerSample = 1;
+			break;
+	}
+	return sizeof(sample) + sample.sampleCount * sample.format.channels * bytesPerSample;
+}
+
+size_t paletteMemorySize(const Palette &pal)
+{
+	return sizeof(pal) + pal.colours.size() * sizeof(Colour);
+}
+
+size_t lofTempsMemorySize(const LOFTemps &lofTemps) { return lofTemps.getMemorySize(); }
+
+} // anonymous namespace
 
 class DataImpl final : public Data
 {
 
   private:
-	std::map<UString, std::weak_ptr<Image>> imageCache;
-	std::map<UString, std::weak_ptr<Image>> imageCacheLazy;
+	// The caches have their own internal locks - the *CacheLock mutexes are held over the whole
+	// load so the same resource isn't loaded twice at the same time
+	ResourceCache<Image> imageCache;
 	std::map<UString, UString> imageAliases;
 	std::recursive_mutex imageCacheLock;
-	std::map<UString, std::weak_ptr<ImageSet>> imageSetCache;
+	ResourceCache<ImageSet> imageSetCache;
 	std::map<UString, UString> imageSetAliases;
 	std::recursive_mutex imageSetCacheLock;
 
-	std::map<UString, std::weak_ptr<Sample>> sampleCache;
+	ResourceCache<Sample> sampleCache;
 	std::map<UString, UString> sampleAliases;
 	std::recursive_mutex sampleCacheLock;
-	std::map<UString, std::weak_ptr<MusicTrack>> musicCache;
 	std::map<UString, UString> musicAliases;
 	std::recursive_mutex musicCacheLock;
-	std::map<UString, std::weak_ptr<LOFTemps>> LOFVoxelCache;
+	ResourceCache<LOFTemps> LOFVoxelCache;
 	std::map<UString, UString> voxelAliases;
 	std::recursive_mutex voxelCacheLock;
 
-	std::map<UString, std::weak_ptr<Palette>> paletteCache;
+	ResourceCache<Palette> paletteCache;
 	std::map<UString, UString> paletteAliases;
 	std::recursive_mutex paletteCacheLock;
 
-	// The cache is organised in <font name , <text, image>>
-	std::map<UString, std::map<UString, std::weak_ptr<PaletteImage>>> fontStringCache;
-	std::recursive_mutex fontStringCacheLock;
-
-	// Pin open 'imageCacheSize' images
-	std::queue<sp<Image>> pinnedImages;
-	// Pin open 'imageSetCacheSize' image sets
-	std::queue<sp<ImageSet>> pinnedImageSets;
-	std::queue<sp<LOFTemps>> pinnedLOFVoxels;
-	std::queue<sp<PaletteImage>> pinnedFontStrings;
-	std::queue<sp<Palette>> pinnedPalettes;
+	// Keyed by "font name\ntext"
+	ResourceCache<PaletteImage> fontStringCache;
+
 	std::list<std::unique_ptr<ImageLoader>> imageLoaders;
 	std::list<std::unique_ptr<SampleLoader>> sampleLoaders;
 	std::list<std::unique_ptr<MusicLoader>> musicLoaders;
@@ -113,11 +160,20 @@ class DataImpl final : public Data
 	                             sp<PaletteImage> &img) override;
 
 	bool writeImage(UString systemPath, sp<Image> image, sp<Palette> palette = nullptr) override;
+
+	std::vector<ResourceCacheStats> getCacheStats() override;
+	std::vector<sp<Sample>> getLoadedSamples() override;
 };
 
 Data *Data::createData(std::vector<UString> paths) { return new DataImpl(paths); }
 
-DataImpl::DataImpl(std::vector<UString> paths) : Data(paths)
+DataImpl::DataImpl(std::vector<UString> paths)
+    : Data(paths), imageCache("Image", megabytes(imageCacheSize.get()), imageMemorySize),
+      imageSetCache("ImageSet", megabytes(imageSetCacheSize.get()), imageSetMemorySize),
+      sampleCache("Sample", megabytes(sampleCacheSize.get()), sampleMemorySize),
+      LOFVoxelCache("LOFVoxel", megabytes(voxelCacheSize.get()), lofTempsMemorySize),
+      paletteCache("Palette", megabytes(paletteCacheSize.get()), paletteMemorySize),
+      fontStringCache("FontString", megabytes(fontStringCacheSize.get()), imageMemorySize)
 {
 	registeredImageBackends["lodepng"].reset(getLodePNGImageLoaderFactory());
 	registeredImageBackends["pcx"].reset(getPCXImageLoaderFactory());
@@ -176,17 +232,6 @@ DataImpl::DataImpl(std::vector<UString> paths) : Data(paths)
 		else
 			LogWarning("Failed to load music loader %s", t);
 	}
-	for (int i = 0; i < imageCacheSize.get(); i++)
-		pinnedImages.push(nullptr);
-	for (int i = 0; i < imageSetCacheSize.get(); i++)
-		pinnedImageSets.push(nullptr);
-	for (int i = 0; i < voxelCacheSize.get(); i++)
-		pinnedLOFVoxels.push(nullptr);
-	for (int i = 0; i < fontStringCacheSize.get(); i++)
-		pinnedFontStrings.push(nullptr);
-	for (int i = 0; i < paletteCacheSize.get(); i++)
-		pinnedPalettes.push(nullptr);
-
 	this->readAliases();
 }
 
@@ -218,7 +263,7 @@ sp<VoxelSlice> DataImpl::loadVoxelSlice(const UString &path)
 		// Cut off the index to get the LOFTemps file
 		UString cacheKey = splitString[0] + splitString[1] + splitString[2];
 		cacheKey = cacheKey.toUpper();
-		sp<LOFTemps> lofTemps = this->LOFVoxelCache[cacheKey].lock();
+		sp<LOFTemps> lofTemps = this->LOFVoxelCache.get(cacheKey);
 		if (!lofTemps)
 		{
 			TRACE_FN_ARGS1("path", path);
@@ -235,9 +280,7 @@ sp<VoxelSlice> DataImpl::loadVoxelSlice(const UString &path)
 				return nullptr;
 			}
 			lofTemps = mksp<LOFTemps>(datFile, tabFile);
-			this->LOFVoxelCache[cacheKey] = lofTemps;
-			this->pinnedLOFVoxels.push(lofTemps);
-			this->pinnedLOFVoxels.pop();
+			this->LOFVoxelCache.put(cacheKey, lofTemps);
 		}
 		int idx = Strings::toInteger(splitString[3]);
 		slice = lofTemps->getSlice(idx);
@@ -268,7 +311,7 @@ sp<ImageSet> DataImpl::loadImageSet(const UString &path)
 	}
 
 	UString cacheKey = path.toUpper();
-	sp<ImageSet> imgSet = this->imageSetCache[cacheKey].lock();
+	sp<ImageSet> imgSet = this->imageSetCache.get(cacheKey);
 	if (imgSet)
 	{
 		return imgSet;
@@ -306,11 +349,13 @@ sp<ImageSet> DataImpl::loadImageSet(const UString &path)
 		return nullptr;
 	}
 
-	this->pinnedImageSets.push(imgSet);
-	this->pinnedImageSets.pop();
-
-	this->imageSetCache[cacheKey] = imgSet;
+	if (!imgSet)
+	{
+		LogError("Failed to load image set \"%s\"", path);
+		return nullptr;
+	}
 	imgSet->path = path;
+	this->imageSetCache.put(cacheKey, imgSet);
 	return imgSet;
 }
 
@@ -326,7 +371,7 @@ sp<Sample> DataImpl::loadSample(UString path)
 	}
 
 	UString cacheKey = path.toUpper();
-	sp<Sample> sample = this->sampleCache[cacheKey].lock();
+	sp<Sample> sample = this->sampleCache.get(cacheKey);
 	if (sample)
 		return sample;
 
@@ -342,8 +387,8 @@ sp<Sample> DataImpl::loadSample(UString path)
 		LogInfo("Failed to load sample \"%s\"", path);
 		return nullptr;
 	}
-	this->sampleCache[cacheKey] = sample;
 	sample->path = path;
+	this->sampleCache.put(cacheKey, sample);
 	return sample;
 }
 
@@ -395,7 +440,7 @@ sp<Image> DataImpl::loadImage(const UString &path, bool lazy)
 	// wrapper
 	if (!lazy)
 	{
-		img = this->imageCache[cacheKey].lock();
+		img = this->imageCache.get(cacheKey);
 	}
 	if (img)
 	{
@@ -638,14 +683,11 @@ sp<Image> DataImpl::loadImage(const UString &path, bool lazy)
 		return nullptr;
 	}
 
-	this->pinnedImages.push(img);
-	this->pinnedImages.pop();
-
+	img->path = path;
 	if (!lazy)
 	{
-		this->imageCache[cacheKey] = img;
+		this->imageCache.put(cacheKey, img);
 	}
-	img->path = path;
 	return img;
 }
 
@@ -668,7 +710,7 @@ sp<Palette> DataImpl::loadPalette(const UString &path)
 	// Use an uppercase version of the path for the cache key
 	UString cacheKey = path.toUpper();
 
-	auto pal = this->paletteCache[cacheKey].lock();
+	auto pal = this->paletteCache.get(cacheKey);
 	if (pal)
 	{
 		return pal;
@@ -678,18 +720,14 @@ sp<Palette> DataImpl::loadPalette(const UString &path)
 	if (pal)
 	{
 		LogInfo("Read \"%s\" as PCX palette", path);
-		this->paletteCache[cacheKey] = pal;
-		this->pinnedPalettes.push(pal);
-		this->pinnedPalettes.pop();
+		this->paletteCache.put(cacheKey, pal);
 		return pal;
 	}
 	pal = loadPNGPalette(*this, path);
 	if (pal)
 	{
 		LogInfo("Read \"%s\" as PNG palette", path);
-		this->paletteCache[cacheKey] = pal;
-		this->pinnedPalettes.push(pal);
-		this->pinnedPalettes.pop();
+		this->paletteCache.put(cacheKey, pal);
 		return pal;
 	}
 
@@ -709,9 +747,7 @@ sp<Palette> DataImpl::loadPalette(const UString &path)
 			}
 		}
 		LogInfo("Read \"%s\" as Image palette", path);
-		this->paletteCache[cacheKey] = pal;
-		this->pinnedPalettes.push(pal);
-		this->pinnedPalettes.pop();
+		this->paletteCache.put(cacheKey, p);
 		return p;
 	}
 
@@ -719,9 +755,7 @@ sp<Palette> DataImpl::loadPalette(const UString &path)
 	if (pal)
 	{
 		LogInfo("Read \"%s\" as RAW palette", path);
-		this->paletteCache[cacheKey] = pal;
-		this->pinnedPalettes.push(pal);
-		this->pinnedPalettes.pop();
+		this->paletteCache.put(cacheKey, pal);
 		return pal;
 	}
 	LogError("Failed to open palette \"%s\"", path);
@@ -830,7 +864,6 @@ bool DataImpl::writeImage(UString systemPath, sp<Image> image, sp<Palette> palet
 
 sp<PaletteImage> DataImpl::getFontStringCacheEntry(const UString &font_name, const UString &string)
 {
-	std::lock_guard<std::recursive_mutex> l(this->fontStringCacheLock);
 	if (font_name == "")
 	{
 		LogError("invalid font_name");
@@ -841,14 +874,12 @@ sp<PaletteImage> DataImpl::getFontStringCacheEntry(const UString &font_name, con
 		// LogWarning("Empty string");
 		return nullptr;
 	}
-	auto img = this->fontStringCache[font_name][string].lock();
-	return img;
+	return this->fontStringCache.get(font_name + "\n" + string);
 }
 
 void DataImpl::putFontStringCacheEntry(const UString &font_name, const UString &string,
                                        sp<PaletteImage> &img)
 {
-	std::lock_guard<std::recursive_mutex> l(this->fontStringCacheLock);
 	if (font_name == "")
 	{
 		LogError("invalid font_name");
@@ -859,9 +890,113 @@ void DataImpl::putFontStringCacheEntry(const UString &font_name, const UString &
 		// LogWarning("Empty string");
 		return;
 	}
-	this->fontStringCache[font_name][string] = img;
-	this->pinnedFontStrings.push(img);
-	this->pinnedFontStrings.pop();
+	this->fontStringCache.put(font_name + "\n" + string, img);
+}
+
+std::vector<ResourceCacheStats> DataImpl::getCacheStats()
+{
+	return {this->imageCache.getStats(),    this->imageSetCache.getStats(),
+	        this->sampleCache.getStats(),   this->LOFVoxelCache.getStats(),
+	        this->paletteCache.getStats(),  this->fontStringCache.getStats()};
+}
+
+std::vector<sp<Sample>> DataImpl::getLoadedSamples() { return this->sampleCache.getLoaded(); }
+
+class PrefetchJobState
+{
+  public:
+	class Load
+	{
+	  public:
+		std::function<void()> function;
+		std::atomic<bool> claimed;
+		Load(std::function<void()> function) : function(std::move(function)), claimed(false) {}
+	};
+	std::vector<up<Load>> loads;
+	unsigned int completed = 0;
+	mutable std::mutex lock;
+	std::condition_variable loadCompleted;
+
+	void run(Load &load)
+	{
+		if (load.claimed.exchange(true))
+			return;
+		try
+		{
+			load.function();
+		}
+		catch (std::exception &e)
+		{
+			LogError("Exception occurred in prefetch: %s", e.what());
+		}
+		std::lock_guard<std::mutex> l(this->lock);
+		this->completed++;
+		this->loadCompleted.notify_all();
+	}
+};
+
+PrefetchJob::PrefetchJob(std::vector<std::function<void()>> loads) : state(mksp<PrefetchJobState>())
+{
+	for (auto &load : loads)
+	{
+		this->state->loads.emplace_back(new PrefetchJobState::Load(std::move(load)));
+	}
+	auto jobState = this->state;
+	for (auto &load : this->state->loads)
+	{
+		auto *l = load.get();
+		// The pool task holds a reference to the state, so it's still there for tasks that only
+		// get to run after the job's gone (and find their load already claimed)
+		fw().threadPoolTaskEnqueue([jobState, l]() { jobState->run(*l); });
+	}
+}
+
+PrefetchJob::~PrefetchJob()
+{
+	unsigned int dropped = 0;
+	for (auto &load : this->state->loads)
+	{
+		if (!load->claimed.exchange(true))
+			dropped++;
+	}
+	std::unique_lock<std::mutex> l(this->state->lock);
+	this->state->completed += dropped;
+	this->state->loadCompleted.wait(
+	    l, [this]() { return this->state->completed == this->state->loads.size(); });
+}
+
+unsigned int PrefetchJob::getTotal() const { return this->state->loads.size(); }
+
+unsigned int PrefetchJob::getCompleted() const
+{
+	std::lock_guard<std::mutex> l(this->state->lock);
+	return this->state->completed;
+}
+
+float PrefetchJob::getProgress() const
+{
+	if (this->getTotal() == 0)
+		return 1.0f;
+	return static_cast<float>(this->getCompleted()) / static_cast<float>(this->getTotal());
+}
+
+bool PrefetchJob::isComplete() const { return this->getCompleted() == this->getTotal(); }
+
+void PrefetchJob::wait()
+{
+	TRACE_FN;
+	for (auto &load : this->state->loads)
+	{
+		this->state->run(*load);
+	}
+	std::unique_lock<std::mutex> l(this->state->lock);
+	this->state->loadCompleted.wait(
+	    l, [this]() { return this->state->completed == this->state->loads.size(); });
+}
+
+sp<PrefetchJob> Data::prefetch(std::vector<std::function<void()>> loads)
+{
+	return mksp<PrefetchJob>(std::move(loads));
 }
 
 void DataImpl::addSampleAlias(const UString &name, const UString &value)
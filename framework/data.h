@@ -2,6 +2,7 @@
 
 #include "framework/fs.h"
 #include "library/sp.h"
+#include <functional>
 #include <vector>
 
 namespace OpenApoc
@@ -16,7 +17,30 @@ class Palette;
 class VoxelSlice;
 class Video;
 class PaletteImage;
+class ResourceCacheStats;
 class UString;
+class PrefetchJobState;
+
+// A group of resource loads running in the background on the thread pool.
+// Each load is run exactly once - wait() runs any load a pool thread hasn't started yet itself,
+// so it's safe to wait from within a thread pool task.
+// Destroying the job drops any loads that haven't started, and waits for the ones that have, so
+// the loads can safely refer to things that go away with the job's owner.
+class PrefetchJob
+{
+  private:
+	sp<PrefetchJobState> state;
+
+  public:
+	PrefetchJob(std::vector<std::function<void()>> loads);
+	~PrefetchJob();
+	unsigned int getTotal() const;
+	unsigned int getCompleted() const;
+	// Returns 0.0 (nothing loaded) to 1.0 (all loads complete)
+	float getProgress() const;
+	bool isComplete() const;
+	void wait();
+};
 
 class Data
 {
@@ -48,6 +72,12 @@ class Data
 	                                     sp<PaletteImage> &img) = 0;
 
 	virtual bool writeImage(UString systemPath, sp<Image> image, sp<Palette> palette = nullptr) = 0;
+
+	virtual std::vector<ResourceCacheStats> getCacheStats() = 0;
+	virtual std::vector<sp<Sample>> getLoadedSamples() = 0;
+
+	// Starts running 'loads' on the thread pool, returning a job that can be polled for progress
+	sp<PrefetchJob> prefetch(std::vector<std::function<void()>> loads);
 };
 
 } // namespace OpenApoc
@@ -1,7 +1,9 @@
 #include "framework/font.h"
 #include "framework/data.h"
 #include "framework/framework.h"
+#include "framework/configfile.h"
 #include "framework/image.h"
+#include "framework/renderer.h"
 #include "library/sp.h"
 
 // Disable automatic #pragma linking for boost - only enabled in msvc and that should provide boost
@@ -12,43 +14,98 @@
 namespace OpenApoc
 {
 
+ConfigOptionInt fontLayoutCacheSize("Framework.Font", "LayoutCacheSize",
+                                    "Number of text layouts to keep cached per font", 500);
+
 BitmapFont::~BitmapFont() = default;
 
 sp<PaletteImage> BitmapFont::getString(const UString &Text)
 {
-	int height = this->getFontHeight();
-	int width = this->getFontWidth(Text);
-	int pos = 0;
-
 	auto img = fw().data->getFontStringCacheEntry(this->name, Text);
 	if (img)
 		return img;
 
-	img = mksp<PaletteImage>(Vec2<int>{width, height});
+	auto layout = this->getLayout(Text);
+	img = mksp<PaletteImage>(layout->size);
+
+	for (auto &g : layout->glyphs)
+	{
+		PaletteImage::blit(g.glyph, img, {0, 0}, {g.offset.x, g.offset.y});
+	}
+
+	fw().data->putFontStringCacheEntry(this->name, Text, img);
+
+	return img;
+}
+
+sp<TextLayout> BitmapFont::createLayout(const UString &Text)
+{
+	auto layout = mksp<TextLayout>();
+	int pos = 0;
 
 	auto u8Str = Text.str();
 	auto pointString = boost::locale::conv::utf_to_utf<UniChar>(u8Str);
+	layout->glyphs.reserve(pointString.length());
 
 	for (size_t i = 0; i < pointString.length(); i++)
 	{
-		UniChar c = pointString[i];
-		auto glyph = this->getGlyph(c);
-		PaletteImage::blit(glyph, img, {0, 0}, {pos, 0});
+		auto glyph = this->getGlyph(pointString[i]);
+		layout->glyphs.push_back({glyph, Vec2<int>{pos, 0}});
 		pos += glyph->size.x;
 	}
+	layout->size = {pos, this->getFontHeight()};
 
-	fw().data->putFontStringCacheEntry(this->name, Text, img);
+	return layout;
+}
 
-	return img;
+sp<TextLayout> BitmapFont::getLayout(const UString &Text)
+{
+	auto it = this->layoutCacheEntries.find(Text);
+	if (it != this->layoutCacheEntries.end())
+	{
+		// Move to the front of the LRU list
+		this->layoutCache.splice(this->layoutCache.begin(), this->layoutCache, it->second);
+		return it->second->second;
+	}
+
+	auto layout = this->createLayout(Text);
+	this->layoutCache.emplace_front(Text, layout);
+	this->layoutCacheEntries[Text] = this->layoutCache.begin();
+
+	while (this->layoutCache.size() > static_cast<size_t>(fontLayoutCacheSize.get()))
+	{
+		this->layoutCacheEntries.erase(this->layoutCache.back().first);
+		this->layoutCache.pop_back();
+	}
+	return layout;
+}
+
+void BitmapFont::drawString(Renderer &r, const UString &Text, Vec2<float> position)
+{
+	if (Text.empty())
+		return;
+	auto layout = this->getLayout(Text);
+	for (auto &g : layout->glyphs)
+	{
+		r.draw(g.glyph, position + Vec2<float>{g.offset});
+	}
 }
 
 int BitmapFont::getFontWidth(const UString &Text)
 {
+	// Don't add to the layout cache here, as wordWrapText() measures lots of partial lines that
+	// are never drawn
+	auto it = this->layoutCacheEntries.find(Text);
+	if (it != this->layoutCacheEntries.end())
+	{
+		return it->second->second->size.x;
+	}
+
 	int textlen = 0;
 	auto u8Str = Text.str();
 	auto pointString = boost::locale::conv::utf_to_utf<UniChar>(u8Str);
 
-	for (size_t i = 0; i < Text.length(); i++)
+	for (size_t i = 0; i < pointString.length(); i++)
 	{
 		auto glyph = this->getGlyph(pointString[i]);
 		textlen += glyph->size.x;
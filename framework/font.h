@@ -2,13 +2,33 @@
 
 #include "library/sp.h"
 #include "library/strings.h"
+#include "library/vec.h"
+#include <list>
 #include <map>
+#include <vector>
 
 namespace OpenApoc
 {
 
 class PaletteImage;
 class Palette;
+class Renderer;
+
+// The position of every glyph in a string, relative to the top-left of the string. Drawing a
+// layout just draws each glyph image, so (as the glyphs are shared by the font and only uploaded
+// to the renderer once) no new image has to be created for each string
+class TextLayout
+{
+  public:
+	class PositionedGlyph
+	{
+	  public:
+		sp<PaletteImage> glyph;
+		Vec2<int> offset;
+	};
+	std::vector<PositionedGlyph> glyphs;
+	Vec2<int> size;
+};
 
 class BitmapFont
 {
@@ -20,10 +40,18 @@ class BitmapFont
 	UString name;
 	sp<Palette> palette;
 
+	// Most-recently-used layouts are at the front of the list
+	std::list<std::pair<UString, sp<TextLayout>>> layoutCache;
+	std::map<UString, std::list<std::pair<UString, sp<TextLayout>>>::iterator> layoutCacheEntries;
+
+	sp<TextLayout> createLayout(const UString &Text);
+
   public:
 	virtual ~BitmapFont();
 	virtual sp<PaletteImage> getGlyph(UniChar codepoint);
 	virtual sp<PaletteImage> getString(const UString &Text);
+	virtual sp<TextLayout> getLayout(const UString &Text);
+	virtual void drawString(Renderer &r, const UString &Text, Vec2<float> position);
 	virtual int getFontWidth(const UString &Text);
 	virtual int getFontHeight() const;
 	virtual int getFontHeight(const UString &Text, int MaxWidth);
@@ -13,8 +13,13 @@
 #include "library/sp.h"
 #include <SDL.h>
 #include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
 #include <list>
 #include <map>
+#include <mutex>
+#include <thread>
 #include <vector>
 
 // SDL_syswm includes windows.h on windows, which does all kinds of polluting
@@ -88,6 +93,127 @@ ConfigOptionInt frameLimit("Framework", "FrameLimit", "Quit after this many fram
                            0);
 ConfigOptionInt swapInterval("Framework", "SwapInterval",
                              "Swap interval (0 = tear, 1 = wait for vsync", 0);
+ConfigOptionInt tickRateOption("Framework", "TickRate",
+                               "Stage updates per second, whatever the frame rate (0 = one update "
+                               "per frame)",
+                               60);
+ConfigOptionInt maxTicksPerFrameOption(
+    "Framework", "MaxTicksPerFrame",
+    "Most updates to run before drawing a frame when catching up, any more are dropped", 4);
+// Not safe yet - an image or surface the updates drop the last reference to frees its renderer
+// data on the update thread, which has no GL context
+ConfigOptionBool threadedUpdateOption("Framework", "ThreadedUpdate",
+                                      "Experimental and unsafe: run the next frame's updates on "
+                                      "their own thread while the last frame is swapped to the "
+                                      "screen (drawing still waits for them to finish). Renderer "
+                                      "data freed by the updates is freed without a GL context",
+                                      false);
+ConfigOptionBool waitForTickOption("Framework", "WaitForTick",
+                                   "Without vsync, wait for the next update before drawing another "
+                                   "frame (caps the frame rate at the tick rate)",
+                                   false);
+
+// How long frames and ticks took, counted into buckets, so the spread (and not just the average)
+// shows up as a Trace counter
+class TimeHistogram
+{
+  public:
+	TimeHistogram(const UString &name) : name(name), counts(BUCKET_COUNT, 0) {}
+
+	void add(std::chrono::high_resolution_clock::duration time)
+	{
+		auto ms = std::chrono::duration<float, std::milli>(time).count();
+		int bucket = 0;
+		while (bucket < BUCKET_COUNT - 1 && ms >= BUCKET_LIMITS_MS[bucket])
+			bucket++;
+		counts[bucket]++;
+	}
+
+	// Reports the counts since the last report
+	void report()
+	{
+		if (Trace::enabled)
+		{
+			std::vector<std::pair<UString, UString>> values;
+			for (int i = 0; i < BUCKET_COUNT; i++)
+			{
+				values.emplace_back(BUCKET_NAMES[i], Strings::fromInteger(counts[i]));
+			}
+			Trace::counter(name, values);
+		}
+		std::fill(counts.begin(), counts.end(), 0);
+	}
+
+  private:
+	static const int BUCKET_COUNT = 7;
+	static const float BUCKET_LIMITS_MS[BUCKET_COUNT - 1];
+	static const char *const BUCKET_NAMES[BUCKET_COUNT];
+	UString name;
+	std::vector<int> counts;
+};
+
+const float TimeHistogram::BUCKET_LIMITS_MS[] = {4, 8, 17, 33, 50, 100};
+const char *const TimeHistogram::BUCKET_NAMES[] = {"<4ms",  "<8ms",   "<17ms",  "<33ms",
+                                                   "<50ms", "<100ms", ">=100ms"};
+
+const std::chrono::seconds HISTOGRAM_REPORT_INTERVAL(1);
+
+// Runs the threaded updates. This can't use the thread pool, as the updates themselves queue work
+// on the pool and wait for it, which would never finish with a single pool thread
+class UpdateThread
+{
+  public:
+	UpdateThread() : stopping(false), thread([this]() { this->loop(); }) {}
+	~UpdateThread()
+	{
+		{
+			std::lock_guard<std::mutex> l(this->lock);
+			this->stopping = true;
+		}
+		this->wakeUp.notify_one();
+		this->thread.join();
+	}
+
+	void start(std::function<void()> work)
+	{
+		{
+			std::lock_guard<std::mutex> l(this->lock);
+			this->work = std::move(work);
+		}
+		this->wakeUp.notify_one();
+	}
+
+	void wait()
+	{
+		std::unique_lock<std::mutex> l(this->lock);
+		this->finished.wait(l, [this]() { return !this->work; });
+	}
+
+  private:
+	void loop()
+	{
+		std::unique_lock<std::mutex> l(this->lock);
+		while (true)
+		{
+			this->wakeUp.wait(l, [this]() { return this->stopping || this->work; });
+			if (this->stopping)
+				return;
+			auto work = this->work;
+			l.unlock();
+			work();
+			l.lock();
+			this->work = nullptr;
+			this->finished.notify_all();
+		}
+	}
+
+	std::mutex lock;
+	std::condition_variable wakeUp, finished;
+	std::function<void()> work;
+	bool stopping;
+	// Last, so everything else is set up before it starts
+	std::thread thread;
+};
 
 } // anonymous namespace
 
@@ -367,10 +493,63 @@ void Framework::run(sp<Stage> initialStage)
 
 	this->renderer->setPalette(this->data->loadPalette("xcom3/ufodata/pal_06.dat"));
 
+	using clock = std::chrono::high_resolution_clock;
+	// With no tick rate, every frame gets exactly one update
+	auto tickRate = std::max(0, tickRateOption.get());
+	auto tickLength = tickRate ? clock::duration(std::chrono::seconds(1)) / tickRate
+	                           : clock::duration::zero();
+	auto maxTicksPerFrame = std::max(1, maxTicksPerFrameOption.get());
+	bool threadedUpdate = threadedUpdateOption.get();
+	// Without vsync nothing holds rendering back, so optionally wait for the next tick instead
+	bool waitForTick = tickRate && swapInterval.get() == 0 && waitForTickOption.get();
+	auto nextTick = clock::now();
+
+	TimeHistogram frameTimes("Frame time"), tickTimes("Tick time");
+	auto nextReport = clock::now() + HISTOGRAM_REPORT_INTERVAL;
+
+	// Runs 'ticks' updates of the current stage, stopping early if it asks for the stage stack to
+	// change (as the commands can only be acted on from this thread)
+	auto runTicks = [this, &tickTimes](unsigned int ticks) {
+		for (unsigned int i = 0; i < ticks && !p->ProgramStages.isEmpty(); i++)
+		{
+			auto tickStart = clock::now();
+			{
+				TraceObj updateObj("Update");
+				p->ProgramStages.current()->update();
+			}
+			tickTimes.add(clock::now() - tickStart);
+			if (!stageCommands.empty())
+				break;
+		}
+	};
+	// How many ticks are due, catching up by at most maxTicksPerFrame. If it's further behind than
+	// that (say after a long load) the rest are dropped, rather than running a burst of them
+	auto ticksDue = [&]() -> unsigned int {
+		if (!tickRate)
+			return 1;
+		auto now = clock::now();
+		unsigned int ticks = 0;
+		while (now >= nextTick && ticks < (unsigned int)maxTicksPerFrame)
+		{
+			ticks++;
+			nextTick += tickLength;
+		}
+		if (now >= nextTick)
+			nextTick = now + tickLength;
+		return ticks;
+	};
+	// Runs the next frame's ticks while this frame is swapped to the screen
+	up<UpdateThread> updateThread;
+	if (threadedUpdate)
+		updateThread.reset(new UpdateThread());
+
 	while (!p->quitProgram)
 	{
 		frame++;
-		TraceObj obj{"Frame", {{"frame", Strings::fromInteger(frame)}}};
+		TraceObj obj("Frame", [frame]() {
+			return std::vector<std::pair<UString, UString>>{{"frame", Strings::fromInteger(frame)}};
+		});
+		auto frameStart = clock::now();
 
 		processEvents();
 
@@ -378,42 +557,16 @@ void Framework::run(sp<Stage> initialStage)
 		{
 			break;
 		}
+		// Threaded updates happen after drawing, but the first stage still needs an update first
+		if (!threadedUpdate || frame == 1)
 		{
-			TraceObj updateObj("Update");
-			p->ProgramStages.current()->update();
-		}
-
-		for (StageCmd cmd : stageCommands)
-		{
-			switch (cmd.cmd)
+			auto ticks = ticksDue();
+			for (unsigned int i = 0; i < ticks && !p->quitProgram; i++)
 			{
-				case StageCmd::Command::CONTINUE:
-					break;
-				case StageCmd::Command::REPLACE:
-					p->ProgramStages.pop();
-					p->ProgramStages.push(cmd.nextStage);
-					break;
-				case StageCmd::Command::REPLACEALL:
-					p->ProgramStages.clear();
-					p->ProgramStages.push(cmd.nextStage);
-					break;
-				case StageCmd::Command::PUSH:
-					p->ProgramStages.push(cmd.nextStage);
-					break;
-				case StageCmd::Command::POP:
-					p->ProgramStages.pop();
-					break;
-				case StageCmd::Command::QUIT:
-					p->quitProgram = true;
-					p->ProgramStages.clear();
-					break;
-			}
-			if (p->quitProgram)
-			{
-				break;
+				runTicks(1);
+				applyStageCommands();
 			}
 		}
-		stageCommands.clear();
 
 		auto surface = p->scaleSurface ? p->scaleSurface : p->defaultSurface;
 		RendererSurfaceBinding b(*this->renderer, surface);
@@ -433,12 +586,46 @@ void Framework::run(sp<Stage> initialStage)
 				this->renderer->clear();
 				this->renderer->drawScaled(p->scaleSurface, {0, 0}, p->windowSize);
 			}
+			this->renderer->flush();
+			// Everything's been drawn, so the next ticks can run while the frame is swapped. The
+			// first frame's ticks have already run above
+			bool ticksPending = threadedUpdate && frame != 1;
+			if (ticksPending)
+			{
+				auto ticks = ticksDue();
+				updateThread->start([&runTicks, ticks]() { runTicks(ticks); });
+			}
 			{
 				TraceObj flipObj("Flip");
-				this->renderer->flush();
 				this->renderer->newFrame();
 				SDL_GL_SwapWindow(p->window);
 			}
+			if (ticksPending)
+			{
+				{
+					TraceObj waitObj("Wait for update");
+					updateThread->wait();
+				}
+				applyStageCommands();
+			}
+		}
+		// Samples played by all of this frame's ticks are mixed together
+		if (this->soundBackend)
+		{
+			this->soundBackend->flushPositionalSamples();
+		}
+		if (waitForTick)
+		{
+			std::this_thread::sleep_until(nextTick);
+		}
+
+		auto frameEnd = clock::now();
+		frameTimes.add(frameEnd - frameStart);
+		if (frameEnd >= nextReport)
+		{
+			frameTimes.report();
+			tickTimes.report();
+			nextReport = frameEnd + HISTOGRAM_REPORT_INTERVAL;
 		}
 		if (frameCount && frame == frameCount)
 		{
@@ -448,6 +635,41 @@ void Framework::run(sp<Stage> initialStage)
 	}
 }
 
+void Framework::applyStageCommands()
+{
+	for (StageCmd cmd : stageCommands)
+	{
+		switch (cmd.cmd)
+		{
+			case StageCmd::Command::CONTINUE:
+				break;
+			case StageCmd::Command::REPLACE:
+				p->ProgramStages.pop();
+				p->ProgramStages.push(cmd.nextStage);
+				break;
+			case StageCmd::Command::REPLACEALL:
+				p->ProgramStages.clear();
+				p->ProgramStages.push(cmd.nextStage);
+				break;
+			case StageCmd::Command::PUSH:
+				p->ProgramStages.push(cmd.nextStage);
+				break;
+			case StageCmd::Command::POP:
+				p->ProgramStages.pop();
+				break;
+			case StageCmd::Command::QUIT:
+				p->quitProgram = true;
+				p->ProgramStages.clear();
+				break;
+		}
+		if (p->quitProgram)
+		{
+			break;
+		}
+	}
+	stageCommands.clear();
+}
+
 void Framework::processEvents()
 {
 	TRACE_FN;
@@ -36,6 +36,8 @@ class Framework
 	up<ApocCursor> cursor;
 
 	std::list<StageCmd> stageCommands;
+	// Acts on the stage commands queued by the last updates
+	void applyStageCommands();
 
   public:
 	std::unique_ptr<Data> data;
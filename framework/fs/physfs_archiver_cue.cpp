@@ -7,24 +7,45 @@
 #include <inttypes.h>
 #endif
 
+#include "framework/configfile.h"
 #include "framework/filesystem.h"
 #include "framework/fs/physfs_archiver_cue.h"
 #include "framework/logger.h"
 #include "library/sp.h"
 #include "library/strings.h"
 #include <SDL_endian.h> // endianness check
+#include <algorithm>
 #include <cstddef>
 #include <cstring> // for std::memcmp
 #include <fstream>
 #include <inttypes.h>
+#include <list>
 #include <map>
+#include <mutex>
 #include <physfs.h>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define CUE_USE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 using namespace OpenApoc;
 
 namespace
 {
 
+ConfigOptionInt cueCacheSectorsOption("Framework", "CueCacheSectors",
+                                      "Number of sectors read from .cue/.bin images to keep cached",
+                                      1024);
+ConfigOptionBool cueMapImageOption("Framework", "CueMapImage",
+                                   "Map .cue/.bin images into memory rather than reading them, "
+                                   "where supported",
+                                   true);
+
 // We actually only use BINARY here, but just for the sake of completion
 enum class CueFileType
 {
@@ -445,62 +466,68 @@ static_assert(sizeof(Sint32LsbMsb) == 8, "Unexpedted int16_lsb_msb_size!");
 static_assert(sizeof(DecDatetime) == 17, "Unexpected dec_datetime size!");
 static_assert(sizeof(DirDatetime) == 7, "Unexpected dir_datetime size!");
 
-class CueIO
+// The binary file behind a cuesheet, shared by every stream opened from it.
+// Reads are served a sector at a time with the headers stripped off. Where the file can be mapped
+// into memory they're copied straight out of the mapping, otherwise runs of sectors are read in
+// one go and kept in a small LRU cache, as most reads are small and land in the same few sectors.
+class CueImage
 {
-  private:
-	friend class CueArchiver;
-
-	UString imageFile;  // For stream duplication
-	int32_t lbaStart;   // Starting LBA for this stream
-	int32_t lbaCurrent; // Current block for this stream
-	int32_t posInLba;   // Current position in lba
-	int64_t length;     // Allowed length of the stream
-	CueFileType fileType;
-	CueTrackMode trackMode;
-	std::ifstream fileStream;
+  public:
+	// Sectors read from the file at a time when it isn't mapped
+	static const int SECTORS_PER_RUN = 16;
+	// Extra runs read when a stream is reading sequentially (say streaming music)
+	static const int READ_AHEAD_RUNS = 3;
 
-	CueIO(const UString &fileName, uint32_t lbaStart, int64_t length,
-	      CueFileType fileType = CueFileType::FT_BINARY,
-	      CueTrackMode trackMode = CueTrackMode::MODE1_2048)
-	    : imageFile(fileName), lbaStart(lbaStart), lbaCurrent(lbaStart), posInLba(0),
-	      length(length), fileType(fileType), trackMode(trackMode)
+	CueImage(const UString &fileName, CueTrackMode trackMode)
+	    : fileName(fileName), trackMode(trackMode), mapping(nullptr), fileSize(0), maxRuns(0)
 	{
+#ifdef CUE_USE_MMAP
+		if (cueMapImageOption.get())
+		{
+			int fd = ::open(fileName.cStr(), O_RDONLY);
+			if (fd != -1)
+			{
+				struct stat fileStat;
+				if (fstat(fd, &fileStat) == 0 && fileStat.st_size > 0)
+				{
+					void *map = mmap(nullptr, fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+					if (map != MAP_FAILED)
+					{
+						mapping = (const char *)map;
+						fileSize = fileStat.st_size;
+					}
+				}
+				// The mapping keeps its own reference to the file
+				::close(fd);
+			}
+			if (mapping)
+			{
+				LogInfo("Mapped \"%s\" into memory", fileName);
+				return;
+			}
+			LogWarning("Could not map \"%s\", reading it instead", fileName);
+		}
+#endif
 		fileStream.open(fileName.str(), std::ios::in | std::ios::binary);
-		fileStream.seekg(lbaToByteOffset(lbaStart));
+		fileStream.seekg(0, std::ios::end);
+		fileSize = fileStream.tellg();
+		fileStream.seekg(0, std::ios::beg);
+		// Always leave room for a full read-ahead
+		maxRuns = std::max(cueCacheSectorsOption.get() / SECTORS_PER_RUN, 1 + READ_AHEAD_RUNS);
 	}
 
-	// Convert LBA to actual position in the stream
-	int64_t lbaToByteOffset(uint32_t lba)
+	~CueImage()
 	{
-		switch (trackMode)
-		{
-			// Each block is 2048 bytes, translation is trivial
-			case CueTrackMode::MODE1_2048:
-			case CueTrackMode::MODE2_2048:
-				return lba * 2048;
-			// Each block is 2048 bytes, but there's a prefix and
-			// a postfix area for each sector
-			case CueTrackMode::MODE1_2352:
-				return lba * 2352 + 12 + 4; // 12 sync bytes, 4 header bytes
-			// FIXME: Reality check?
-			// For mode2, each block might be slightly larger than for mode1
-			// These cases are dealing with "cooked" data
-			case CueTrackMode::MODE2_2324:
-				return lba * 2324; // Each sector is 2324 bytes
-			// Strangely enough, mode2/2336 is the same as mode2/2352 without header?
-			case CueTrackMode::MODE2_2336:
-				return lba * 2336 + 8;
-			case CueTrackMode::MODE2_2352:
-				return lba * 2048 + 12 + 4 + 8;
-			default:
-				LogError("Unknown track mode set!");
-				// Return negative offset to indicate error
-				return -1;
-		}
+#ifdef CUE_USE_MMAP
+		if (mapping)
+			munmap((void *)mapping, fileSize);
+#endif
 	}
 
+	bool isOpen() const { return mapping || fileStream.is_open(); }
+
 	// Get the "user data" block size
-	int32_t blockSize()
+	int32_t blockSize() const
 	{
 		// FIXME: Reality check?
 		switch (trackMode)
@@ -523,7 +550,7 @@ class CueIO
 	}
 
 	// Get the "binary" block size
-	int32_t binBlockSize()
+	int32_t binBlockSize() const
 	{
 		switch (trackMode)
 		{
@@ -545,7 +572,7 @@ class CueIO
 	}
 
 	// Offset of the user data portion of the block
-	int32_t binDataOffset()
+	int32_t binDataOffset() const
 	{
 		switch (trackMode)
 		{
@@ -568,6 +595,147 @@ class CueIO
 		return -1;
 	}
 
+	// Copies 'len' bytes of the user data in sector 'lba', starting 'offset' bytes in, to 'buf'.
+	// 'offset + len' must be within the block. Returns the number of bytes copied, which is only
+	// short if the file ends first
+	int64_t readSector(uint32_t lba, int32_t offset, char *buf, int64_t len, bool sequential)
+	{
+		if (mapping)
+		{
+			int64_t start = (int64_t)lba * binBlockSize() + binDataOffset() + offset;
+			if (start >= fileSize)
+				return 0;
+			len = std::min(len, fileSize - start);
+			std::memcpy(buf, mapping + start, len);
+			return len;
+		}
+
+		std::lock_guard<std::mutex> l(cacheLock);
+		uint32_t runIndex = lba / SECTORS_PER_RUN;
+		auto run = runs.find(runIndex);
+		const std::vector<char> *data;
+		if (run != runs.end())
+		{
+			lru.splice(lru.begin(), lru, run->second.lruPosition);
+			data = &run->second.data;
+		}
+		else
+		{
+			data = loadRuns(runIndex, sequential ? 1 + READ_AHEAD_RUNS : 1);
+			if (!data)
+				return 0;
+		}
+		int64_t start = (int64_t)(lba % SECTORS_PER_RUN) * blockSize() + offset;
+		if (start >= (int64_t)data->size())
+			return 0;
+		len = std::min(len, (int64_t)data->size() - start);
+		std::memcpy(buf, data->data() + start, len);
+		return len;
+	}
+
+  private:
+	class Run
+	{
+	  public:
+		// The user data of each sector, one after another
+		std::vector<char> data;
+		std::list<uint32_t>::iterator lruPosition;
+	};
+
+	UString fileName;
+	CueTrackMode trackMode;
+	const char *mapping;
+	int64_t fileSize;
+
+	// Everything below is only used when the file isn't mapped, and guarded by cacheLock
+	std::mutex cacheLock;
+	std::ifstream fileStream;
+	std::vector<char> rawBuffer;
+	std::map<uint32_t, Run> runs;
+	// Most recently used first
+	std::list<uint32_t> lru;
+	int maxRuns;
+
+	// Reads 'count' runs from 'firstRun' on in one go, returning the first one's data, or nullptr
+	// if it's past the end of the file
+	const std::vector<char> *loadRuns(uint32_t firstRun, int count)
+	{
+		int64_t rawRunSize = (int64_t)SECTORS_PER_RUN * binBlockSize();
+		int64_t rawStart = (int64_t)firstRun * rawRunSize;
+		if (rawStart >= fileSize)
+			return nullptr;
+		int64_t rawLength = std::min(count * rawRunSize, fileSize - rawStart);
+		rawBuffer.resize(rawLength);
+		fileStream.clear();
+		fileStream.seekg(rawStart, std::ios::beg);
+		fileStream.read(rawBuffer.data(), rawLength);
+		if (fileStream.gcount() != rawLength)
+		{
+			LogWarning("Read buffer underrun! Wanted %" PRId64 " bytes, got %" PRId64, rawLength,
+			           (int64_t)fileStream.gcount());
+			rawLength = fileStream.gcount();
+			if (rawLength <= 0)
+				return nullptr;
+		}
+
+		// Added last first, so the one asked for ends up most recently used
+		for (int i = count - 1; i >= 0; i--)
+		{
+			int64_t runStart = i * rawRunSize;
+			if (runStart >= rawLength)
+				continue;
+			auto existing = runs.find(firstRun + i);
+			if (existing != runs.end())
+			{
+				lru.erase(existing->second.lruPosition);
+				runs.erase(existing);
+			}
+			auto &run = runs[firstRun + i];
+			run.data.reserve(SECTORS_PER_RUN * blockSize());
+			for (int sector = 0; sector < SECTORS_PER_RUN; sector++)
+			{
+				int64_t sectorStart = runStart + sector * binBlockSize() + binDataOffset();
+				if (sectorStart >= rawLength)
+					break;
+				int64_t sectorLength = std::min((int64_t)blockSize(), rawLength - sectorStart);
+				run.data.insert(run.data.end(), rawBuffer.data() + sectorStart,
+				                rawBuffer.data() + sectorStart + sectorLength);
+			}
+			lru.push_front(firstRun + i);
+			run.lruPosition = lru.begin();
+		}
+		while ((int)runs.size() > maxRuns)
+		{
+			runs.erase(lru.back());
+			lru.pop_back();
+		}
+		return &runs[firstRun].data;
+	}
+};
+
+class CueIO
+{
+  private:
+	friend class CueArchiver;
+
+	sp<CueImage> image; // Shared with every other stream from the same image
+	int32_t lbaStart;   // Starting LBA for this stream
+	int32_t lbaCurrent; // Current block for this stream
+	int32_t posInLba;   // Current position in lba
+	int64_t length;     // Allowed length of the stream
+	CueFileType fileType;
+	// Where the last read finished, reads starting here are taken to be sequential
+	int64_t lastReadEnd;
+
+	CueIO(sp<CueImage> image, uint32_t lbaStart, int64_t length,
+	      CueFileType fileType = CueFileType::FT_BINARY)
+	    : image(image), lbaStart(lbaStart), lbaCurrent(lbaStart), posInLba(0), length(length),
+	      fileType(fileType), lastReadEnd(0)
+	{
+	}
+
+	int32_t blockSize() { return image->blockSize(); }
+
 	int64_t read(void *buf, int64_t len)
 	{
 		// Ignore size 0 reads
@@ -576,19 +744,7 @@ class CueIO
 		// Since we probably will have to read in parts,
 		// we have to make the buffer seekable
 		char *bufWrite = (char *)buf;
-#if 0 // FIXME: This code won't work, actually.
-        // If the data is "cooked", just read it.
-        if (trackMode == CUE_TrackMode::MODE1_2048 ||
-            trackMode == CUE_TrackMode::MODE2_2048)
-        {
-            // FIXME: This won't correctly handle multi-extent files
-            lbaCurrent += len / 2048;
-            int64_t start = fileStream.tellg();
-            fileStream.read(bufWrite, len);
-            return fileStream.tellg() - start;
-        }
-#endif
-		int64_t remainLength = length - (lbaCurrent - lbaStart) * blockSize() - posInLba;
+		int64_t remainLength = length - tell();
 		if (remainLength < 0)
 		{
 			LogError("Trying to read past end of stream!");
@@ -602,27 +758,28 @@ class CueIO
 			//           len, remainLength);
 			len = remainLength;
 		}
+		bool sequential = tell() == lastReadEnd;
 		int64_t totalRead = 0;
-		do
+		while (len > totalRead)
 		{
 			int64_t readSize = std::min(len - totalRead, int64_t(blockSize() - posInLba));
-			fileStream.read(bufWrite + totalRead, readSize);
-			totalRead += fileStream.gcount();
-			if (fileStream.gcount() != readSize)
-			{
-				LogWarning("Read buffer underrun! Wanted %" PRId64 " bytes, got %" PRId64, readSize,
-				           fileStream.gcount());
-				return totalRead;
-			}
-			posInLba += readSize;
+			int64_t sectorRead =
+			    image->readSector(lbaCurrent, posInLba, bufWrite + totalRead, readSize, sequential);
+			totalRead += sectorRead;
+			posInLba += sectorRead;
 			if (posInLba >= blockSize())
 			{
 				posInLba = 0;
 				lbaCurrent += 1;
-				// fileStream.seekg(lbaToByteOffset(lbaCurrent), std::ios::beg);
-				seek((lbaCurrent - lbaStart) * blockSize());
 			}
-		} while (len > totalRead);
+			if (sectorRead != readSize)
+			{
+				LogWarning("Read buffer underrun! Wanted %" PRId64 " bytes, got %" PRId64, readSize,
+				           sectorRead);
+				break;
+			}
+		}
+		lastReadEnd = tell();
 		return totalRead;
 	}
 
@@ -638,27 +795,12 @@ class CueIO
 
 		lbaCurrent = lbaStart + blockOffset;
 		posInLba = posInBlock;
-		uint64_t binOffset = lbaToByteOffset(lbaCurrent) + posInLba;
-		fileStream.seekg(binOffset, std::ios::beg);
-		return fileStream.good();
-	}
-
-	PHYSFS_sint64 tell()
-	{
-		// return lbaToByteOffset(lbaCurrent - lbaStart) + posInLba;
-		return blockSize() * (lbaCurrent - lbaStart) + posInLba;
+		return 1;
 	}
 
-	CueIO(const CueIO &other)
-	    : imageFile(other.imageFile), lbaStart(other.lbaStart), lbaCurrent(other.lbaCurrent),
-	      posInLba(other.posInLba), length(other.length), fileType(other.fileType),
-	      trackMode(other.trackMode)
-	{
-		fileStream.open(imageFile.str(), std::ios::in | std::ios::binary);
-		fileStream.seekg(lbaToByteOffset(lbaStart) + posInLba);
-	}
+	PHYSFS_sint64 tell() { return (int64_t)blockSize() * (lbaCurrent - lbaStart) + posInLba; }
 
-	~CueIO() { fileStream.close(); }
+	CueIO(const CueIO &other) = default;
 
 	static PHYSFS_Io *createIo()
 	{
@@ -709,10 +851,10 @@ class CueIO
 	static PHYSFS_Io *cueIoDuplicate(PHYSFS_Io *io)
 	{
 		CueIO *cio = (CueIO *)io->opaque;
-		// Just go ahead and construct a new file stream
+		// The image is shared, so this only copies the position
 		PHYSFS_Io *retval = createIo();
 		// Set the appropriate fields
-		io->opaque = new CueIO(*cio);
+		retval->opaque = new CueIO(*cio);
 		return retval;
 	}
 
@@ -729,17 +871,14 @@ class CueIO
 		delete io;
 	}
 
-	static PHYSFS_Io *getIo(UString fileName, uint32_t lba, int64_t length, CueFileType ftype,
-	                        CueTrackMode tmode)
+	static PHYSFS_Io *getIo(sp<CueImage> image, uint32_t lba, int64_t length, CueFileType ftype)
 	{
-		auto cio = new CueIO(fileName, lba, length, ftype, tmode);
-		if (!cio->fileStream)
+		if (!image->isOpen())
 		{
-			delete cio;
 			return nullptr;
 		}
 		PHYSFS_Io *io = createIo();
-		io->opaque = cio;
+		io->opaque = new CueIO(image, lba, length, ftype);
 		return io;
 	}
 };
@@ -752,6 +891,7 @@ class CueArchiver
 	CueFileType fileType;
 	CueTrackMode trackMode;
 
+	sp<CueImage> image;
 	CueIO *cio;
 
 	struct IsoVolumeDescriptor
@@ -960,8 +1100,9 @@ class CueArchiver
 		// (mode1_2048)
 		uint64_t fsize = fs::file_size(filePath);
 		LogInfo("Opening file %s of size %" PRIu64, fileName, fsize);
-		cio = new CueIO(fileName, 0, fsize, ftype, tmode);
-		if (!cio->fileStream)
+		image = mksp<CueImage>(fileName, tmode);
+		cio = new CueIO(image, 0, fsize, ftype);
+		if (!image->isOpen())
 		{
 			LogError("Could not open file: bad stream!");
 		}
@@ -1030,7 +1171,7 @@ class CueArchiver
 		{
 			return nullptr;
 		}
-		return CueIO::getIo(imageFile, entry->offset, entry->length, fileType, trackMode);
+		return CueIO::getIo(image, entry->offset, entry->length, fileType);
 	}
 
 	int stat(const char *name, PHYSFS_Stat *stat)
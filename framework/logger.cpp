@@ -8,9 +8,15 @@
 #include "framework/configfile.h"
 #include "framework/framework.h"
 #include "library/sp.h"
+#include "library/spscqueue.h"
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
 #include <cstdarg>
 #include <mutex>
+#include <thread>
+#include <vector>
 #ifdef BACKTRACE_LIBUNWIND
 #ifndef _GNU_SOURCE
 #define _GNU_SOURCE
@@ -74,6 +80,12 @@ ConfigOptionInt backtraceLogLevelOption(
     1);
 ConfigOptionString logFileOption("Logger", "File", "File to write log to", LOG_PATH LOGFILE);
 ConfigOptionBool showDialogOnErrorOption("Logger", "ShowDialog", "Show dialog on error", true);
+#if !defined(BROKEN_THREAD_LOCAL)
+ConfigOptionBool asyncLogOption("Logger", "Async",
+                                "Write info and warning messages from a background thread (they "
+                                "may be lost if the game crashes)",
+                                true);
+#endif
 
 #if defined(BACKTRACE_LIBUNWIND)
 static void print_backtrace(FILE *f)
@@ -175,15 +187,160 @@ LogLevel fileLogLevel;
 LogLevel backtraceLogLevel;
 bool showDialogOnError;
 
-bool loggerInited = false;
+// Let everything through until the options have been read
+std::atomic<int> logLevelWanted(4);
 
-static std::mutex logMutex;
+static std::once_flag loggerInitFlag;
+// Held while writing to the outputs, and while popping from the thread queues
+static std::mutex writeMutex;
 static std::chrono::time_point<std::chrono::high_resolution_clock> timeInit =
     std::chrono::high_resolution_clock::now();
 
+namespace
+{
+
+class LogEntry
+{
+  public:
+	LogLevel level = LogLevel::Nothing;
+	unsigned long long clockns = 0;
+	const char *prefix = nullptr;
+	UString text;
+};
+
+// Only the thread that owns a queue pushes to it, and only whoever holds writeMutex pops
+class ThreadLogQueue
+{
+  public:
+	static const int QUEUE_SIZE = 1024;
+	SPSCQueue<LogEntry> entries;
+	// Set once the thread has gone, so the queue can be dropped after it's been emptied
+	std::atomic<bool> threadExited;
+	ThreadLogQueue() : entries(QUEUE_SIZE), threadExited(false) {}
+};
+
+#if !defined(BROKEN_THREAD_LOCAL)
+class ThreadLogQueueOwner
+{
+  public:
+	sp<ThreadLogQueue> queue;
+	~ThreadLogQueueOwner()
+	{
+		if (queue)
+			queue->threadExited = true;
+	}
+};
+#endif
+
+} // anonymous namespace
+
+// Every thread that's queued something, guarded by writeMutex
+static std::vector<sp<ThreadLogQueue>> threadQueues;
+// Entries popped from all the queues, waiting to be sorted and written
+static std::vector<LogEntry> pending;
+
+static void writeEntry(FILE *f, const LogEntry &entry)
+{
+	const char *level_prefix;
+	switch (entry.level)
+	{
+		case LogLevel::Info:
+			level_prefix = "I";
+			break;
+		case LogLevel::Warning:
+			level_prefix = "W";
+			break;
+		default:
+			level_prefix = "E";
+			break;
+	}
+	fprintf(f, "%s %llu %s: %s\n", level_prefix, entry.clockns, entry.prefix, entry.text.cStr());
+}
+
+// Writes out everything queued so far. Must be called with writeMutex held
+static void drainQueues()
+{
+	LogEntry entry;
+	for (auto it = threadQueues.begin(); it != threadQueues.end();)
+	{
+		auto &queue = *it;
+		// Checked before popping, so anything the thread pushed before it exited is still written
+		bool exited = queue->threadExited;
+		while (queue->entries.tryPop(entry))
+		{
+			pending.push_back(std::move(entry));
+		}
+		if (exited)
+			it = threadQueues.erase(it);
+		else
+			it++;
+	}
+	if (pending.empty())
+		return;
+
+	// Each queue is in order already, but they need interleaving
+	std::stable_sort(pending.begin(), pending.end(), [](const LogEntry &a, const LogEntry &b) {
+		return a.clockns < b.clockns;
+	});
+	for (auto &e : pending)
+	{
+		if (e.level <= fileLogLevel)
+			writeEntry(outFile, e);
+		if (e.level <= stderrLogLevel)
+			writeEntry(stderr, e);
+	}
+	pending.clear();
+	if (outFile)
+		fflush(outFile);
+	fflush(stderr);
+}
+
+#if !defined(BROKEN_THREAD_LOCAL)
+static thread_local ThreadLogQueueOwner threadQueue;
+
+// How often the writer wakes to empty the queues if nothing fills one first
+static const int WRITE_INTERVAL_MS = 50;
+static std::atomic<bool> writerRunning(false);
+static std::thread writerThread;
+static std::mutex writerWakeMutex;
+static std::condition_variable writerWake;
+static bool writerStopping = false;
+
+static void writerLoop()
+{
+	std::unique_lock<std::mutex> wakeLock(writerWakeMutex);
+	while (!writerStopping)
+	{
+		writerWake.wait_for(wakeLock, std::chrono::milliseconds(WRITE_INTERVAL_MS));
+		wakeLock.unlock();
+		{
+			std::lock_guard<std::mutex> l(writeMutex);
+			drainQueues();
+		}
+		wakeLock.lock();
+	}
+}
+
+// Run at exit, anything logged after this is written straight away
+static void stopWriter()
+{
+	// Cleared before the last drain, and fenced against the check after queueing in Log(), so
+	// anything queued either gets drained here or is drained by whoever queued it
+	writerRunning = false;
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	{
+		std::lock_guard<std::mutex> wakeLock(writerWakeMutex);
+		writerStopping = true;
+	}
+	writerWake.notify_one();
+	writerThread.join();
+	std::lock_guard<std::mutex> l(writeMutex);
+	drainQueues();
+}
+#endif
+
 static void initLogger()
 {
-	loggerInited = true;
 	outFile = NULL;
 
 	stderrLogLevel = (LogLevel)stderrLogLevelOption.get();
@@ -196,34 +353,40 @@ static void initLogger()
 	{
 		// No log file set, disabling logging to file
 		fileLogLevel = LogLevel::Nothing;
-		return;
 	}
-	outFile = fopen(logFilePath.cStr(), "w");
-	if (!outFile)
+	else
 	{
-		// Failed to open log file, disabling logging to file
-		fileLogLevel = LogLevel::Nothing;
-		return;
+		outFile = fopen(logFilePath.cStr(), "w");
+		if (!outFile)
+		{
+			// Failed to open log file, disabling logging to file
+			fileLogLevel = LogLevel::Nothing;
+		}
+	}
+	logLevelWanted = std::max((int)stderrLogLevel, (int)fileLogLevel);
+
+#if !defined(BROKEN_THREAD_LOCAL)
+	// Without thread_local there's nowhere to keep each thread's queue, so everything gets written
+	// straight away
+	if (asyncLogOption.get())
+	{
+		writerRunning = true;
+		writerThread = std::thread(writerLoop);
+		atexit(stopWriter);
 	}
+#endif
 }
 
 void _logAssert(UString prefix, UString string, int line, UString file)
 {
-	Log(LogLevel::Error, prefix,
+	Log(LogLevel::Error, prefix.cStr(),
 	    ::OpenApoc::format("Assertion \"%s\" failed at %s:%d", string.cStr(), file.cStr(), line));
 	exit(EXIT_FAILURE);
 }
 
-void Log(LogLevel level, UString prefix, const UString &text)
+void Log(LogLevel level, const char *prefix, const UString &text)
 {
-	bool exit_app = false;
-	const char *level_prefix;
-
-	logMutex.lock();
-	if (!loggerInited)
-	{
-		initLogger();
-	}
+	std::call_once(loggerInitFlag, initLogger);
 
 	bool writeToFile = (level <= fileLogLevel);
 	bool writeToStderr = (level <= stderrLogLevel);
@@ -233,37 +396,67 @@ void Log(LogLevel level, UString prefix, const UString &text)
 		return;
 	}
 
+	LogEntry entry;
+	entry.level = level;
+	entry.prefix = prefix;
+	entry.text = text;
 	auto timeNow = std::chrono::high_resolution_clock::now();
-	unsigned long long clockns =
+	entry.clockns =
 	    std::chrono::duration<unsigned long long, std::nano>(timeNow - timeInit).count();
 
-	switch (level)
+	bool backtrace = (level <= backtraceLogLevel);
+#if !defined(BROKEN_THREAD_LOCAL)
+	if (writerRunning && level != LogLevel::Error && !backtrace)
 	{
-		case LogLevel::Info:
-			level_prefix = "I";
-			break;
-		case LogLevel::Warning:
-			level_prefix = "W";
-			break;
-		default:
-			level_prefix = "E";
-			exit_app = true;
-			break;
+		auto &queue = threadQueue.queue;
+		if (!queue)
+		{
+			queue = mksp<ThreadLogQueue>();
+			std::lock_guard<std::mutex> l(writeMutex);
+			threadQueues.push_back(queue);
+		}
+		while (!queue->entries.tryPush(std::move(entry)))
+		{
+			if (!writerRunning)
+			{
+				// Full, and the writer might already have gone, so empty it here
+				std::lock_guard<std::mutex> l(writeMutex);
+				drainQueues();
+				continue;
+			}
+			// Full, so hurry the writer along
+			writerWake.notify_one();
+			std::this_thread::yield();
+		}
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (!writerRunning)
+		{
+			// The writer stopped while this was being queued, so it might have missed it
+			std::lock_guard<std::mutex> l(writeMutex);
+			drainQueues();
+		}
+		return;
 	}
+#endif
+
+	bool exit_app = (level == LogLevel::Error);
+	std::unique_lock<std::mutex> l(writeMutex);
+	// So this comes after everything logged before it
+	drainQueues();
 
 	if (writeToFile)
 	{
-		fprintf(outFile, "%s %llu %s: %s\n", level_prefix, clockns, prefix.cStr(), text.cStr());
+		writeEntry(outFile, entry);
 		// On error print a backtrace to the log file
-		if (level <= backtraceLogLevel)
+		if (backtrace)
 			print_backtrace(outFile);
 		fflush(outFile);
 	}
 
 	if (writeToStderr)
 	{
-		fprintf(stderr, "%s %llu %s: %s\n", level_prefix, clockns, prefix.cStr(), text.cStr());
-		if (level <= backtraceLogLevel)
+		writeEntry(stderr, entry);
+		if (backtrace)
 			print_backtrace(stderr);
 		fflush(stderr);
 	}
@@ -312,7 +505,7 @@ void Log(LogLevel level, UString prefix, const UString &text)
 	}
 #endif
 
-	logMutex.unlock();
+	l.unlock();
 
 	if (exit_app)
 	{
@@ -320,4 +513,11 @@ void Log(LogLevel level, UString prefix, const UString &text)
 	}
 }
 
+void LogFlush()
+{
+	std::call_once(loggerInitFlag, initLogger);
+	std::lock_guard<std::mutex> l(writeMutex);
+	drainQueues();
+}
+
 }; // namespace OpenApoc
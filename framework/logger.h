@@ -2,6 +2,7 @@
 
 #include "library/strings.h"
 #include "library/strings_format.h"
+#include <atomic>
 
 #if defined(_MSC_VER) && _MSC_VER > 1400
 #include <sal.h>
@@ -40,7 +41,21 @@ enum class LogLevel : int
 	Info = 3,
 	Debug = 3,
 };
-void Log(LogLevel level, UString prefix, const UString &text);
+
+// The most detailed level any output wants, set when the logger is first used. Messages more
+// detailed than this are dropped before their arguments are formatted
+extern std::atomic<int> logLevelWanted;
+static inline bool logLevelEnabled(LogLevel level)
+{
+	return (int)level <= logLevelWanted.load(std::memory_order_relaxed);
+}
+
+// Info and warning messages are queued per thread and written out by a background thread, errors
+// (and anything that wants a backtrace) are written straight away, after everything queued.
+// 'prefix' is kept until the message is written, so has to be a literal (the function name)
+void Log(LogLevel level, const char *prefix, const UString &text);
+// Waits until everything logged so far has been written
+void LogFlush();
 
 NORETURN_FUNCTION void _logAssert(UString prefix, UString string, int line, UString file);
 
@@ -54,36 +69,32 @@ NORETURN_FUNCTION void _logAssert(UString prefix, UString string, int line, UStr
 			OpenApoc::_logAssert(LOGGER_PREFIX, STR(X), __LINE__, __FILE__);                       \
 	} while (0)
 
-//#ifndef __ANDROID__
-#if defined(__GNUC__)
-// GCC has an extension if __VA_ARGS__ are not supplied to 'remove' the precending comma
-#define LogDebug(f, ...)                                                                           \
-	OpenApoc::Log(OpenApoc::LogLevel::Debug, OpenApoc::UString(LOGGER_PREFIX),                     \
-	              ::OpenApoc::format(f, ##__VA_ARGS__))
-#define LogInfo(f, ...)                                                                            \
-	OpenApoc::Log(OpenApoc::LogLevel::Info, OpenApoc::UString(LOGGER_PREFIX),                      \
-	              ::OpenApoc::format(f, ##__VA_ARGS__))
-#define LogWarning(f, ...)                                                                         \
-	OpenApoc::Log(OpenApoc::LogLevel::Warning, OpenApoc::UString(LOGGER_PREFIX),                   \
-	              ::OpenApoc::format(f, ##__VA_ARGS__))
-#define LogError(f, ...)                                                                           \
-	OpenApoc::Log(OpenApoc::LogLevel::Error, OpenApoc::UString(LOGGER_PREFIX),                     \
-	              ::OpenApoc::format(f, ##__VA_ARGS__))
+// The most detailed level of message built in, anything more detailed compiles to nothing (and its
+// arguments are never evaluated). Errors are always built in, as logging one quits. Set by the
+// LOG_LEVEL cmake option
+#ifndef OPENAPOC_LOG_LEVEL
+#define OPENAPOC_LOG_LEVEL 3
+#endif
+
+// The format string is just the first of __VA_ARGS__, so no trailing comma needs removing if there
+// aren't any other arguments
+#define LOGGER_LOG(level, ...)                                                                     \
+	(OpenApoc::logLevelEnabled(level)                                                              \
+	     ? OpenApoc::Log(level, LOGGER_PREFIX, ::OpenApoc::format(__VA_ARGS__))                    \
+	     : (void)0)
+// Only mentions the arguments (so variables just logged don't become unused), without evaluating
+#define LOGGER_DISABLED(...) ((void)sizeof(::OpenApoc::format(__VA_ARGS__)))
+
+#if OPENAPOC_LOG_LEVEL >= 3
+#define LogDebug(...) LOGGER_LOG(OpenApoc::LogLevel::Debug, __VA_ARGS__)
+#define LogInfo(...) LOGGER_LOG(OpenApoc::LogLevel::Info, __VA_ARGS__)
 #else
-// At least msvc automatically removes the comma
-#define LogDebug(f, ...)                                                                           \
-	OpenApoc::Log(OpenApoc::LogLevel::Debug, LOGGER_PREFIX, ::OpenApoc::format(f, __VA_ARGS__))
-#define LogInfo(f, ...)                                                                            \
-	OpenApoc::Log(OpenApoc::LogLevel::Info, LOGGER_PREFIX, ::OpenApoc::format(f, __VA_ARGS__))
-#define LogWarning(f, ...)                                                                         \
-	OpenApoc::Log(OpenApoc::LogLevel::Warning, LOGGER_PREFIX, ::OpenApoc::format(f, __VA_ARGS__))
-#define LogError(f, ...)                                                                           \
-	OpenApoc::Log(OpenApoc::LogLevel::Error, LOGGER_PREFIX, ::OpenApoc::format(f, __VA_ARGS__))
+#define LogDebug(...) LOGGER_DISABLED(__VA_ARGS__)
+#define LogInfo(...) LOGGER_DISABLED(__VA_ARGS__)
 #endif
-//#else
-#if 0
-#define LogInfo(f, ...)
-#define LogWarning(f, ...)
-#define LogError(f, ...)
+#if OPENAPOC_LOG_LEVEL >= 2
+#define LogWarning(...) LOGGER_LOG(OpenApoc::LogLevel::Warning, __VA_ARGS__)
+#else
+#define LogWarning(...) LOGGER_DISABLED(__VA_ARGS__)
 #endif
-//#endif
+#define LogError(...) LOGGER_LOG(OpenApoc::LogLevel::Error, __VA_ARGS__)
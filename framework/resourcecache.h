@@ -0,0 +1,195 @@
+#pragma once
+
+#include "framework/trace.h"
+#include "library/sp.h"
+#include "library/strings.h"
+#include "library/strings_format.h"
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace OpenApoc
+{
+
+class ResourceCacheStats
+{
+  public:
+	UString name;
+	uint64_t hits = 0;
+	uint64_t misses = 0;
+	uint64_t evictions = 0;
+	// Only counts the resources pinned by the cache, not ones kept alive by other references
+	size_t bytesUsed = 0;
+	size_t bytesBudget = 0;
+	size_t entries = 0;
+};
+
+// A cache of resources keyed by string, that keeps the most-recently-used entries alive until
+// their total size exceeds the byte budget.
+// Any entry evicted from the cache will still be returned by get() while something else holds a
+// reference, so there's never more than one copy of each resource loaded.
+template <typename T> class ResourceCache
+{
+  private:
+	using LRUList = std::list<std::pair<UString, sp<T>>>;
+
+	std::function<size_t(const T &)> sizeFunction;
+	std::map<UString, wp<T>> loaded;
+	// The size of 'loaded' after it was last swept for expired entries
+	size_t loadedAfterSweep = 0;
+	// The most recently used entry is at the front
+	LRUList pinned;
+	std::map<UString, typename LRUList::iterator> pinnedEntries;
+	std::map<UString, size_t> pinnedSizes;
+	ResourceCacheStats stats;
+	mutable std::mutex lock;
+
+	void pin(const UString &key, sp<T> resource)
+	{
+		auto size = this->sizeFunction(*resource);
+		this->pinned.emplace_front(key, resource);
+		this->pinnedEntries[key] = this->pinned.begin();
+		this->pinnedSizes[key] = size;
+		this->stats.bytesUsed += size;
+
+		// Always keep the newest entry, even if it alone is larger than the budget
+		bool evicted = false;
+		while (this->stats.bytesUsed > this->stats.bytesBudget && this->pinned.size() > 1)
+		{
+			UString evictedKey = this->pinned.back().first;
+			this->stats.bytesUsed -= this->pinnedSizes[evictedKey];
+			this->pinnedSizes.erase(evictedKey);
+			this->pinnedEntries.erase(evictedKey);
+			this->pinned.pop_back();
+			this->stats.evictions++;
+			evicted = true;
+			// If nothing else was using it, it's now gone for good
+			auto loadedEntry = this->loaded.find(evictedKey);
+			if (loadedEntry != this->loaded.end() && loadedEntry->second.expired())
+				this->loaded.erase(loadedEntry);
+		}
+		this->stats.entries = this->pinned.size();
+		if (evicted && this->loaded.size() > 2 * this->loadedAfterSweep)
+			this->sweepLoaded();
+	}
+
+	// Removes entries that were evicted while in use elsewhere, and have since been freed.
+	// Only done once 'loaded' has doubled since the last sweep, so the cost is spread over the
+	// evictions in between
+	void sweepLoaded()
+	{
+		for (auto it = this->loaded.begin(); it != this->loaded.end();)
+		{
+			if (it->second.expired())
+				it = this->loaded.erase(it);
+			else
+				++it;
+		}
+		this->loadedAfterSweep = this->loaded.size();
+	}
+
+	void traceCounters() const
+	{
+		if (!Trace::enabled)
+			return;
+		Trace::counter("Cache::" + this->stats.name,
+		               {{"bytesUsed", format("%llu", (unsigned long long)this->stats.bytesUsed)},
+		                {"hits", format("%llu", (unsigned long long)this->stats.hits)},
+		                {"misses", format("%llu", (unsigned long long)this->stats.misses)},
+		                {"evictions", format("%llu", (unsigned long long)this->stats.evictions)}});
+	}
+
+  public:
+	ResourceCache(const UString &name, size_t bytesBudget,
+	              std::function<size_t(const T &)> sizeFunction)
+	    : sizeFunction(sizeFunction)
+	{
+		this->stats.name = name;
+		this->stats.bytesBudget = bytesBudget;
+	}
+
+	sp<T> get(const UString &key)
+	{
+		std::lock_guard<std::mutex> l(this->lock);
+		auto pinnedEntry = this->pinnedEntries.find(key);
+		if (pinnedEntry != this->pinnedEntries.end())
+		{
+			this->pinned.splice(this->pinned.begin(), this->pinned, pinnedEntry->second);
+			this->stats.hits++;
+			return pinnedEntry->second->second;
+		}
+		auto loadedEntry = this->loaded.find(key);
+		if (loadedEntry != this->loaded.end())
+		{
+			auto resource = loadedEntry->second.lock();
+			if (resource)
+			{
+				// Still in use elsewhere, so bring it back into the pinned set
+				this->stats.hits++;
+				this->pin(key, resource);
+				return resource;
+			}
+			this->loaded.erase(loadedEntry);
+		}
+		this->stats.misses++;
+		this->traceCounters();
+		return nullptr;
+	}
+
+	void put(const UString &key, sp<T> resource)
+	{
+		if (!resource)
+			return;
+		std::lock_guard<std::mutex> l(this->lock);
+		auto pinnedEntry = this->pinnedEntries.find(key);
+		if (pinnedEntry != this->pinnedEntries.end())
+		{
+			this->stats.bytesUsed -= this->pinnedSizes[key];
+			this->pinnedSizes.erase(key);
+			this->pinned.erase(pinnedEntry->second);
+			this->pinnedEntries.erase(pinnedEntry);
+		}
+		this->loaded[key] = resource;
+		this->pin(key, resource);
+		this->traceCounters();
+	}
+
+	void clear()
+	{
+		std::lock_guard<std::mutex> l(this->lock);
+		this->stats.evictions += this->pinned.size();
+		this->pinned.clear();
+		this->pinnedEntries.clear();
+		this->pinnedSizes.clear();
+		this->loaded.clear();
+		this->loadedAfterSweep = 0;
+		this->stats.bytesUsed = 0;
+		this->stats.entries = 0;
+	}
+
+	// Every resource that's still alive, whether pinned by the cache or not
+	std::vector<sp<T>> getLoaded() const
+	{
+		std::lock_guard<std::mutex> l(this->lock);
+		std::vector<sp<T>> resources;
+		for (auto &entry : this->loaded)
+		{
+			auto resource = entry.second.lock();
+			if (resource)
+				resources.push_back(resource);
+		}
+		return resources;
+	}
+
+	ResourceCacheStats getStats() const
+	{
+		std::lock_guard<std::mutex> l(this->lock);
+		return this->stats;
+	}
+};
+
+} // namespace OpenApoc
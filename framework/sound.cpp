@@ -1,5 +1,8 @@
 #include "framework/sound.h"
+#include "framework/configfile.h"
 #include "framework/logger.h"
+#include "framework/trace.h"
+#include <algorithm>
 #include <array>
 #include <glm/glm.hpp>
 #include <limits>
@@ -8,6 +11,19 @@
 
 namespace OpenApoc
 {
+
+ConfigOptionInt positionalCullDistanceOption(
+    "Framework.Audio", "PositionalCullDistance",
+    "Positional samples further than this (in map units) from the view aren't played (0 = play "
+    "them all)",
+    60);
+ConfigOptionInt positionalVoicesOption(
+    "Framework.Audio", "PositionalVoices",
+    "Maximum number of positional samples (shots, impacts, footsteps...) playing at once", 16);
+
+// The same sample played within this distance of another in the same frame only plays once
+static const float POSITIONAL_MERGE_DISTANCE = 2.0f;
+
 static const std::array<std::pair<float, float>, 4> positionalAudioLUT = {{
     std::make_pair(3.0f, 1.0f),   // Anything within 3.0f units is at full volume
     std::make_pair(30.0f, 0.25f), // That then scales linearly down to 25% over the next 30 units
@@ -18,8 +34,13 @@ static const std::array<std::pair<float, float>, 4> positionalAudioLUT = {{
 // Position is assumed to be in 'map' units, gainMultiplier within 0 and 1
 void SoundBackend::playSample(sp<Sample> sample, Vec3<float> position, float gainMultiplier)
 {
+	if (!sample)
+		return;
 
 	float distance = glm::length(position - this->listenerPosition);
+	auto cullDistance = positionalCullDistanceOption.get();
+	if (cullDistance > 0 && distance > cullDistance)
+		return;
 
 	/*FIXME: Quick hack at trying to get scaling based on the 3d location of the sample being
 	 * played*/
@@ -42,10 +63,57 @@ void SoundBackend::playSample(sp<Sample> sample, Vec3<float> position, float gai
 			distance -= lutDistance;
 		}
 	}
-	LogInfo("Playing sample at {%f,%f,%f} - distance to camera %f, gain %f", position.x, position.y,
-	        position.z, distance, gain);
-	// Anything within CLOSE_RANGE is at full volume
-	this->playSample(sample, gain * gainMultiplier);
+	gain *= gainMultiplier;
+
+	for (auto &pending : this->pendingPositionalSamples)
+	{
+		if (pending.sample == sample &&
+		    glm::length(pending.position - position) <= POSITIONAL_MERGE_DISTANCE)
+		{
+			// Just keep the louder of the two
+			if (gain > pending.gain)
+			{
+				pending.position = position;
+				pending.gain = gain;
+			}
+			return;
+		}
+	}
+	this->pendingPositionalSamples.push_back({sample, position, gain});
 }
+
+void SoundBackend::flushPositionalSamples()
+{
+	if (this->pendingPositionalSamples.empty())
+		return;
+	TRACE_FN;
+	auto now = std::chrono::steady_clock::now();
+	this->positionalSampleEnds.erase(
+	    std::remove_if(this->positionalSampleEnds.begin(), this->positionalSampleEnds.end(),
+	                   [now](const std::chrono::steady_clock::time_point &end) {
+		                   return end <= now;
+		               }),
+	    this->positionalSampleEnds.end());
+
+	std::stable_sort(this->pendingPositionalSamples.begin(), this->pendingPositionalSamples.end(),
+	                 [](const PositionalSample &a, const PositionalSample &b) {
+		                 return a.gain > b.gain;
+		             });
+	auto budget = (size_t)std::max(0, positionalVoicesOption.get());
+	for (auto &pending : this->pendingPositionalSamples)
+	{
+		// Anything left over is quieter than what's already playing, so just drop it
+		if (this->positionalSampleEnds.size() >= budget)
+			break;
+		this->playSample(pending.sample, pending.gain);
+		auto length = std::chrono::microseconds(
+		    pending.sample->format.frequency > 0
+		        ? (int64_t)pending.sample->sampleCount * 1000000 / pending.sample->format.frequency
+		        : 0);
+		this->positionalSampleEnds.push_back(now + length);
+	}
+	this->pendingPositionalSamples.clear();
+}
+
 void SoundBackend::setListenerPosition(Vec3<float> position) { this->listenerPosition = position; }
 }; // namespace OpenApoc
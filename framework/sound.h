@@ -4,7 +4,9 @@
 #include "library/sp.h"
 #include "library/strings.h"
 #include "library/vec.h"
+#include <chrono>
 #include <functional>
+#include <tuple>
 #include <vector>
 
 namespace OpenApoc
@@ -85,6 +87,9 @@ class SoundBackend
   public:
 	virtual ~SoundBackend() = default;
 	virtual void playSample(sp<Sample> sample, float gain = 1.0f) = 0;
+	// Gets 'samples' ready to play in advance, so the first playSample of each doesn't have to.
+	// Safe to call from any thread
+	virtual void prepareSamples(const std::vector<sp<Sample>> &samples) { std::ignore = samples; }
 	virtual void playMusic(std::function<void(void *)> finishedCallback,
 	                       void *callbackData = nullptr) = 0;
 	virtual void stopMusic() = 0;
@@ -113,9 +118,27 @@ class SoundBackend
 	virtual void setGain(Gain g, float v) = 0;
 
 	Vec3<float> listenerPosition;
-	/* A quick attempt at 'positional' audio */
+	/* A quick attempt at 'positional' audio
+	 * These aren't played straight away, but gathered up until the next
+	 * flushPositionalSamples(). The same sample played several times close together is only
+	 * played once, anything too far from the listener is dropped, and only so many are
+	 * allowed to play at once, loudest first */
 	virtual void playSample(sp<Sample> sample, Vec3<float> position, float gainMultiplier = 1.0f);
 	virtual void setListenerPosition(Vec3<float> position);
+	// Plays the positional samples gathered since the last call, called once a frame
+	void flushPositionalSamples();
+
+  private:
+	class PositionalSample
+	{
+	  public:
+		sp<Sample> sample;
+		Vec3<float> position;
+		float gain;
+	};
+	std::vector<PositionalSample> pendingPositionalSamples;
+	// When each positional sample still playing will finish
+	std::vector<std::chrono::steady_clock::time_point> positionalSampleEnds;
 };
 
 class JukeBox
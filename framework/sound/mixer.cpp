@@ -0,0 +1,214 @@
+#include "framework/sound/mixer.h"
+#include "framework/trace.h"
+#include "library/vec.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MIXER_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace OpenApoc
+{
+
+MusicRingBuffer::MusicRingBuffer(size_t capacity)
+    : readPosition(0), writePosition(0), flushPosition(0)
+{
+	size_t size = 1;
+	while (size < capacity)
+		size <<= 1;
+	this->values.resize(size);
+	this->mask = size - 1;
+}
+
+size_t MusicRingBuffer::getFree() const
+{
+	// Flushed values only count as free once the reader has skipped them, as it might still be
+	// part way through reading them
+	auto used = this->writePosition.load(std::memory_order_relaxed) -
+	            this->readPosition.load(std::memory_order_acquire);
+	return this->values.size() - (size_t)used;
+}
+
+size_t MusicRingBuffer::write(const int16_t *input, size_t count)
+{
+	count = std::min(count, this->getFree());
+	auto position = this->writePosition.load(std::memory_order_relaxed);
+	auto offset = (size_t)(position & this->mask);
+	auto firstPart = std::min(count, this->values.size() - offset);
+	std::copy(input, input + firstPart, this->values.data() + offset);
+	std::copy(input + firstPart, input + count, this->values.data());
+	this->writePosition.store(position + count, std::memory_order_release);
+	return count;
+}
+
+void MusicRingBuffer::flush()
+{
+	this->flushPosition.store(this->writePosition.load(std::memory_order_relaxed),
+	                          std::memory_order_release);
+}
+
+size_t MusicRingBuffer::read(int16_t *output, size_t count)
+{
+	auto position = std::max(this->readPosition.load(std::memory_order_relaxed),
+	                         this->flushPosition.load(std::memory_order_acquire));
+	auto available = this->writePosition.load(std::memory_order_acquire) - position;
+	count = std::min(count, (size_t)available);
+	auto offset = (size_t)(position & this->mask);
+	auto firstPart = std::min(count, this->values.size() - offset);
+	std::copy(this->values.data() + offset, this->values.data() + offset + firstPart, output);
+	std::copy(this->values.data(), this->values.data() + count - firstPart, output + firstPart);
+	this->readPosition.store(position + count, std::memory_order_release);
+	return count;
+}
+
+size_t MusicRingBuffer::getAvailable() const
+{
+	auto position = std::max(this->readPosition.load(std::memory_order_relaxed),
+	                         this->flushPosition.load(std::memory_order_acquire));
+	return (size_t)(this->writePosition.load(std::memory_order_acquire) - position);
+}
+
+SoftwareMixer::SoftwareMixer() : commands(QUEUE_SIZE), voices(VOICE_COUNT) {}
+
+int32_t SoftwareMixer::toFixedGain(float gain)
+{
+	gain = std::min(1.0f, std::max(0.0f, gain));
+	return (int32_t)lrint(gain * (1 << GAIN_BITS));
+}
+
+bool SoftwareMixer::playSample(sp<MixerSampleData> data, float gain)
+{
+	PlayCommand command;
+	command.data = std::move(data);
+	command.gain = gain;
+	return this->commands.tryPush(std::move(command));
+}
+
+void SoftwareMixer::startVoice(PlayCommand &command)
+{
+	if (!command.data || command.data->samples.empty())
+		return;
+	Voice *chosen = nullptr;
+	for (auto &voice : this->voices)
+	{
+		if (!voice.data)
+		{
+			chosen = &voice;
+			break;
+		}
+		// Steal the quietest voice, and of those the one with least left to play
+		if (!chosen || voice.gain < chosen->gain ||
+		    (voice.gain == chosen->gain &&
+		     voice.data->samples.size() - voice.position <
+		         chosen->data->samples.size() - chosen->position))
+		{
+			chosen = &voice;
+		}
+	}
+	if (chosen->data && chosen->gain > command.gain)
+	{
+		// Quieter than everything already playing, so not worth hearing
+		return;
+	}
+	chosen->data = std::move(command.data);
+	chosen->position = 0;
+	chosen->gain = command.gain;
+}
+
+int SoftwareMixer::getVoicesPlaying() const
+{
+	int playing = 0;
+	for (auto &voice : this->voices)
+	{
+		if (voice.data)
+			playing++;
+	}
+	return playing;
+}
+
+void SoftwareMixer::accumulate(int32_t *accumulator, const int16_t *input, unsigned int count,
+                               int32_t gain)
+{
+	unsigned int i = 0;
+#ifdef MIXER_USE_SSE2
+	// 8 values at a time, the 16x16 bit products are put back together from their high and low
+	// halves into 32 bits
+	auto gains = _mm_set1_epi16((int16_t)gain);
+	for (; i + 8 <= count; i += 8)
+	{
+		auto in = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input + i));
+		auto low = _mm_mullo_epi16(in, gains);
+		auto high = _mm_mulhi_epi16(in, gains);
+		auto *out = reinterpret_cast<__m128i *>(accumulator + i);
+		_mm_storeu_si128(out, _mm_add_epi32(_mm_loadu_si128(out), _mm_unpacklo_epi16(low, high)));
+		_mm_storeu_si128(out + 1,
+		                 _mm_add_epi32(_mm_loadu_si128(out + 1), _mm_unpackhi_epi16(low, high)));
+	}
+#endif
+	for (; i < count; i++)
+	{
+		accumulator[i] += input[i] * gain;
+	}
+}
+
+void SoftwareMixer::clampToOutput(int16_t *output, const int32_t *accumulator, unsigned int count)
+{
+	unsigned int i = 0;
+#ifdef MIXER_USE_SSE2
+	for (; i + 8 <= count; i += 8)
+	{
+		auto *in = reinterpret_cast<const __m128i *>(accumulator + i);
+		auto low = _mm_srai_epi32(_mm_loadu_si128(in), GAIN_BITS);
+		auto high = _mm_srai_epi32(_mm_loadu_si128(in + 1), GAIN_BITS);
+		// Packing saturates, so does the clamping for us
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(output + i), _mm_packs_epi32(low, high));
+	}
+#endif
+	for (; i < count; i++)
+	{
+		output[i] = (int16_t)clamp(accumulator[i] >> GAIN_BITS, (int32_t)INT16_MIN,
+		                           (int32_t)INT16_MAX);
+	}
+}
+
+void SoftwareMixer::mix(int16_t *output, unsigned int count, float sampleGain,
+                        const int16_t *music, float musicGain)
+{
+	TRACE_FN;
+	PlayCommand command;
+	while (this->commands.tryPop(command))
+	{
+		this->startVoice(command);
+	}
+
+	// Only grows the first time round, or if the device asks for a bigger buffer
+	if (this->accumulator.size() < count)
+		this->accumulator.resize(count);
+	auto *acc = this->accumulator.data();
+	std::fill(acc, acc + count, 0);
+
+	if (music)
+	{
+		accumulate(acc, music, count, toFixedGain(musicGain));
+	}
+	for (auto &voice : this->voices)
+	{
+		if (!voice.data)
+			continue;
+		auto toMix = std::min(count, (unsigned int)voice.data->samples.size() - voice.position);
+		accumulate(acc, voice.data->samples.data() + voice.position, toMix,
+		           toFixedGain(voice.gain * sampleGain));
+		voice.position += toMix;
+		if (voice.position == voice.data->samples.size())
+		{
+			voice.data = nullptr;
+		}
+	}
+
+	clampToOutput(output, acc, count);
+}
+
+}; // namespace OpenApoc
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "framework/sound.h"
+#include "library/sp.h"
+#include "library/spscqueue.h"
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace OpenApoc
+{
+
+// Sample data already converted to the mixer's output format (signed 16 bit, interleaved, at the
+// output channel count and frequency)
+class MixerSampleData : public BackendSampleData
+{
+  public:
+	std::vector<int16_t> samples;
+	~MixerSampleData() override = default;
+};
+
+// A lock-free ring of 16 bit values, so music can be converted ahead on one thread while the mixer
+// reads it on another. 'capacity' is rounded up to a power of two
+class MusicRingBuffer
+{
+  public:
+	MusicRingBuffer(size_t capacity);
+
+	// Called on the writing thread
+	size_t getFree() const;
+	// Returns how many values fitted
+	size_t write(const int16_t *input, size_t count);
+	// Throws away everything written so far (say when the track changes), anything written
+	// after is kept
+	void flush();
+
+	// Called on the reading thread. Returns how many values were read
+	size_t read(int16_t *output, size_t count);
+	size_t getAvailable() const;
+
+	size_t capacity() const { return this->values.size(); }
+
+  private:
+	std::vector<int16_t> values;
+	size_t mask;
+	// Total values ever read and written, the positions in 'values' are these masked
+	std::atomic<uint64_t> readPosition;
+	std::atomic<uint64_t> writePosition;
+	// Where the writer last flushed to, the reader skips up to here
+	std::atomic<uint64_t> flushPosition;
+};
+
+// The software mixer used by the SDL backend, kept apart from SDL so it can be run (and timed)
+// without an audio device.
+// Samples are handed over from the game thread through a lock-free queue, and played on a fixed
+// pool of voices. If every voice is busy the quietest one is stolen, or the new sample dropped if
+// that's quieter still. Everything playing is summed into a 32 bit buffer, then clamped to the
+// 16 bit output in one pass.
+class SoftwareMixer
+{
+  public:
+	static const int VOICE_COUNT = 32;
+	static const int QUEUE_SIZE = 256;
+	// Gains are applied as fixed point with this many fractional bits
+	static const int GAIN_BITS = 8;
+
+	SoftwareMixer();
+
+	// Called on the game thread. Returns false if the queue was full and the sample dropped
+	bool playSample(sp<MixerSampleData> data, float gain);
+
+	// Called on the audio thread. Fills 'output' with 'count' 16 bit values, interleaved if there's
+	// more than one channel. If 'music' isn't null, 'count' values of it are mixed in at
+	// 'musicGain', and all the samples at 'sampleGain'
+	void mix(int16_t *output, unsigned int count, float sampleGain, const int16_t *music,
+	         float musicGain);
+
+	// Only safe to use from the audio thread, or while it's stopped
+	int getVoicesPlaying() const;
+
+	// The kernels mix() is built from, exposed for testing
+	static void accumulate(int32_t *accumulator, const int16_t *input, unsigned int count,
+	                       int32_t gain);
+	static void clampToOutput(int16_t *output, const int32_t *accumulator, unsigned int count);
+	static int32_t toFixedGain(float gain);
+
+  private:
+	class Voice
+	{
+	  public:
+		sp<MixerSampleData> data;
+		unsigned int position = 0;
+		float gain = 0.0f;
+	};
+	class PlayCommand
+	{
+	  public:
+		sp<MixerSampleData> data;
+		float gain = 0.0f;
+	};
+
+	SPSCQueue<PlayCommand> commands;
+	std::vector<Voice> voices;
+	std::vector<int32_t> accumulator;
+
+	void startVoice(PlayCommand &command);
+};
+
+}; // namespace OpenApoc
@@ -1,16 +1,23 @@
+#include "framework/configfile.h"
+#include "framework/data.h"
+#include "framework/filesystem.h"
 #include "framework/framework.h"
 #include "framework/logger.h"
+#include "framework/sound/mixer.h"
 #include "framework/sound_interface.h"
 #include "framework/trace.h"
 #include "library/sp.h"
+#include "library/strings_format.h"
 #include "library/vec.h"
 #include <SDL.h>
 #include <SDL_audio.h>
 #include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
 #include <functional>
-#include <list>
 #include <mutex>
-#include <queue>
+#include <thread>
 #include <vector>
 
 namespace
@@ -18,24 +25,16 @@ namespace
 
 using namespace OpenApoc;
 
-struct SampleData
-{
-	sp<Sample> sample;
-	float gain;
-	unsigned int sample_position; // in bytes
-	SampleData(sp<Sample> sample, float gain) : sample(sample), gain(gain), sample_position(0) {}
-};
-
-struct MusicData
-{
-	MusicData() : sample_position(0) {}
-	std::vector<unsigned char> samples;
-	unsigned int sample_position; // in bytes
-};
+ConfigOptionString sampleCacheDirOption(
+    "Framework.Audio", "SampleCacheDir",
+    "Directory to keep samples converted to the output format in, so they don't need converting "
+    "again next run (empty to disable)",
+    "");
 
-// 'samples' must already be large enough to contain the full output size
-static bool ConvertAudio(AudioFormat input_format, SDL_AudioSpec &output_spec, int input_size_bytes,
-                         std::vector<unsigned char> &samples)
+// Converts the first 'input_size_bytes' of 'samples' in place to the output format, resizing
+// 'samples' to fit the result
+static bool ConvertAudio(AudioFormat input_format, const SDL_AudioSpec &output_spec,
+                         int input_size_bytes, std::vector<unsigned char> &samples)
 {
 	SDL_AudioCVT cvt;
 	SDL_AudioFormat sdl_input_format;
@@ -63,209 +62,339 @@ static bool ConvertAudio(AudioFormat input_format, SDL_AudioSpec &output_spec, i
 	else if (ret == 0)
 	{
 		// No conversion needed
+		samples.resize(input_size_bytes);
 		return true;
 	}
 	else
 	{
+		// SDL needs room for the intermediate steps, which can be bigger than the output
+		samples.resize(input_size_bytes * cvt.len_mult);
 		cvt.len = input_size_bytes;
 		cvt.buf = (Uint8 *)samples.data();
-		SDL_ConvertAudio(&cvt);
+		if (SDL_ConvertAudio(&cvt) < 0)
+		{
+			LogWarning("Failed to convert audio: %s", SDL_GetError());
+			return false;
+		}
+		samples.resize(cvt.len_cvt);
 		return true;
 	}
 }
 
-class SDLSampleData : public BackendSampleData
+class SDLSampleData : public MixerSampleData
 {
   public:
-	SDLSampleData(sp<Sample> sample, SDL_AudioSpec &output_spec)
+	// The output format this was converted to
+	int frequency;
+	int channels;
+
+	SDLSampleData(const SDL_AudioSpec &output_spec)
+	    : frequency(output_spec.freq), channels(output_spec.channels)
+	{
+	}
+	~SDLSampleData() override = default;
+
+	void convert(const Sample &sample, const SDL_AudioSpec &output_spec)
 	{
 		unsigned int input_size =
-		    sample->format.getSampleSize() * sample->format.channels * sample->sampleCount;
-		unsigned int output_size = (SDL_AUDIO_BITSIZE(output_spec.format) / 8) *
-		                           output_spec.channels * sample->sampleCount;
-		this->samples.resize(std::max(input_size, output_size));
-		memcpy(this->samples.data(), sample->data.get(), input_size);
-		if (!ConvertAudio(sample->format, output_spec, input_size, this->samples))
+		    sample.format.getSampleSize() * sample.format.channels * sample.sampleCount;
+		std::vector<unsigned char> converted(input_size);
+		memcpy(converted.data(), sample.data.get(), input_size);
+		if (!ConvertAudio(sample.format, output_spec, input_size, converted))
 		{
 			LogWarning("Failed to convert sample data");
+			return;
 		}
-		this->samples.resize(output_size);
+		this->samples.resize(converted.size() / sizeof(int16_t));
+		memcpy(this->samples.data(), converted.data(), this->samples.size() * sizeof(int16_t));
 	}
-	~SDLSampleData() override = default;
-	std::vector<unsigned char> samples;
 };
 
+// Converted samples are kept on disk as this header, the cache key (so a hash collision can't
+// return the wrong sample) and then the 16 bit values
+class ConvertedSampleHeader
+{
+  public:
+	static const uint32_t VERSION = 1;
+	char magic[4] = {'O', 'A', 'S', 'C'};
+	uint32_t version = VERSION;
+	uint32_t keyLength = 0;
+	uint32_t valueCount = 0;
+};
+
+// FNV-1a, to get a short hash that's the same every run
+static uint64_t hashBytes(const void *data, size_t size)
+{
+	auto *bytes = static_cast<const unsigned char *>(data);
+	uint64_t hash = 14695981039346656037ULL;
+	for (size_t i = 0; i < size; i++)
+	{
+		hash ^= bytes[i];
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+static std::string getSampleCacheKey(const Sample &sample, const SDL_AudioSpec &output_spec)
+{
+	// Everything that changes the converted output. The path alone isn't enough, as different
+	// data (another CD, or a mod) can be loaded from the same one
+	unsigned int input_size =
+	    sample.format.getSampleSize() * sample.format.channels * sample.sampleCount;
+	return format("%s|%016llx|%d:%d:%d:%u|%d:%d:%d", sample.path,
+	              (unsigned long long)hashBytes(sample.data.get(), input_size),
+	              sample.format.frequency, sample.format.channels, (int)sample.format.format,
+	              sample.sampleCount, output_spec.freq, output_spec.channels,
+	              (int)output_spec.format)
+	    .str();
+}
+
+static fs::path getSampleCachePath(const UString &cacheDir, const std::string &key)
+{
+	auto hash = hashBytes(key.data(), key.size());
+	return fs::path(cacheDir.str()) / format("%016llx.pcm", (unsigned long long)hash).str();
+}
+
+static bool readCachedSample(const fs::path &path, const std::string &key, SDLSampleData &data)
+{
+	std::ifstream in(path.string(), std::ios::binary);
+	if (!in)
+		return false;
+	ConvertedSampleHeader header, expected;
+	in.read(reinterpret_cast<char *>(&header), sizeof(header));
+	if (!in || memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0 ||
+	    header.version != expected.version || header.keyLength != key.size())
+		return false;
+	std::string storedKey(header.keyLength, '\0');
+	in.read(&storedKey[0], header.keyLength);
+	if (!in || storedKey != key)
+		return false;
+	data.samples.resize(header.valueCount);
+	in.read(reinterpret_cast<char *>(data.samples.data()), header.valueCount * sizeof(int16_t));
+	if (!in)
+	{
+		data.samples.clear();
+		return false;
+	}
+	return true;
+}
+
+static void writeCachedSample(const fs::path &path, const std::string &key,
+                              const SDLSampleData &data)
+{
+	try
+	{
+		fs::create_directories(path.parent_path());
+	}
+	catch (fs::filesystem_error &e)
+	{
+		LogWarning("Failed to create sample cache directory: %s", e.what());
+		return;
+	}
+	// Write somewhere else first, so a half-written file is never picked up
+	auto tempPath = path;
+	auto threadId = (unsigned int)std::hash<std::thread::id>()(std::this_thread::get_id());
+	tempPath += format(".%u.tmp", threadId).str();
+	{
+		std::ofstream out(tempPath.string(), std::ios::binary | std::ios::trunc);
+		ConvertedSampleHeader header;
+		header.keyLength = key.size();
+		header.valueCount = data.samples.size();
+		out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+		out.write(key.data(), key.size());
+		out.write(reinterpret_cast<const char *>(data.samples.data()),
+		          data.samples.size() * sizeof(int16_t));
+		if (!out)
+		{
+			LogWarning("Failed to write cached sample \"%s\"", tempPath.string());
+			return;
+		}
+	}
+	try
+	{
+		fs::rename(tempPath, path);
+	}
+	catch (fs::filesystem_error &e)
+	{
+		LogWarning("Failed to write cached sample: %s", e.what());
+	}
+}
+
 static void unwrap_callback(void *userdata, Uint8 *stream, int len);
 
 class SDLRawBackend : public SoundBackend
 {
+	// Only protects the music track and callback, samples go through the mixer's queue and
+	// converted music through the ring buffer, so the mixing callback never waits on it
 	std::recursive_mutex audio_lock;
 
-	float overall_volume;
-	float music_volume;
-	float sound_volume;
+	std::atomic<float> overall_volume;
+	std::atomic<float> music_volume;
+	std::atomic<float> sound_volume;
 
 	sp<MusicTrack> track;
-	bool music_playing;
+	std::atomic<bool> music_playing;
 
 	std::function<void(void *)> music_finished_callback;
 	void *music_callback_data;
 
-	std::list<SampleData> live_samples;
+	SoftwareMixer mixer;
+	std::vector<int16_t> music_mix_buffer;
 
 	SDL_AudioDeviceID devID;
 	SDL_AudioSpec output_spec;
 	AudioFormat preferred_format;
 
-	sp<MusicData> current_music_data;
-	std::queue<sp<MusicData>> music_queue;
-
-	std::future<void> get_music_future;
+	up<MusicRingBuffer> music_buffer;
+	// Kept between getMoreMusic calls so streaming doesn't allocate
+	std::vector<unsigned char> music_convert_buffer;
+	// Set while a getMoreMusic is queued or running, so there's only ever one
+	std::atomic<bool> music_fetch_pending;
+	// Set while the track finished callback is being called from getMoreMusic
+	bool in_music_fetch;
 
-	unsigned int music_queue_size;
+	void requestMoreMusic()
+	{
+		if (this->music_fetch_pending.exchange(true))
+			return;
+		fw().threadPoolTaskEnqueue([this]() { this->getMoreMusic(); });
+	}
 
 	void getMoreMusic()
 	{
-		TRACE_FN;
-		std::lock_guard<std::recursive_mutex> lock(this->audio_lock);
-		if (!this->music_playing)
 		{
-			// Music probably disabled in the time it took us to be scheduled?
-			return;
+			TRACE_FN;
+			std::lock_guard<std::recursive_mutex> lock(this->audio_lock);
+			this->in_music_fetch = true;
+			this->fillMusicBuffer();
+			this->in_music_fetch = false;
 		}
-		if (!this->track)
+		// Nothing can be touched after this, the destructor is waiting on it
+		this->music_fetch_pending = false;
+	}
+
+	void fillMusicBuffer()
+	{
+		if (!this->music_playing)
 		{
-			LogWarning("Music playing but no track?");
+			// Music probably disabled in the time it took us to be scheduled?
 			return;
 		}
-		while (this->music_queue.size() < this->music_queue_size)
+		while (this->track)
 		{
-			auto data = mksp<MusicData>();
-
-			unsigned int input_size = this->track->format.getSampleSize() *
-			                          this->track->format.channels *
-			                          this->track->requestedSampleBufferSize;
-			unsigned int output_size = (SDL_AUDIO_BITSIZE(this->output_spec.format) / 8) *
-			                           this->output_spec.channels *
-			                           this->track->requestedSampleBufferSize;
+			auto track = this->track;
+			unsigned int output_values = this->output_spec.channels *
+			                             track->requestedSampleBufferSize *
+			                             this->output_spec.freq / track->format.frequency;
+			if (output_values > this->music_buffer->capacity())
+			{
+				LogError("Music track buffer size %u too large", track->requestedSampleBufferSize);
+				this->track = nullptr;
+				return;
+			}
+			// Leave some slack for rounding in the rate conversion
+			if (this->music_buffer->getFree() < output_values + this->output_spec.channels * 16)
+				return;
 
-			data->samples.resize(std::max(input_size, output_size));
+			unsigned int input_size = track->format.getSampleSize() * track->format.channels *
+			                          track->requestedSampleBufferSize;
+			this->music_convert_buffer.resize(input_size);
 
 			unsigned int returned_samples;
 
-			auto ret = this->track->callback(this->track, this->track->requestedSampleBufferSize,
-			                                 (void *)data->samples.data(), &returned_samples);
+			auto ret = track->callback(track, track->requestedSampleBufferSize,
+			                           (void *)this->music_convert_buffer.data(),
+			                           &returned_samples);
 
-			// Reset the sizes, as we may have fewer returned_samples than asked for
-			input_size = this->track->format.getSampleSize() * this->track->format.channels *
-			             returned_samples;
-			output_size = (SDL_AUDIO_BITSIZE(this->output_spec.format) / 8) *
-			              this->output_spec.channels * returned_samples;
+			// We may have fewer returned_samples than asked for
+			input_size =
+			    track->format.getSampleSize() * track->format.channels * returned_samples;
 
-			bool convert_ret =
-			    ConvertAudio(this->track->format, this->output_spec, input_size, data->samples);
-			if (!convert_ret)
+			if (ConvertAudio(track->format, this->output_spec, input_size,
+			                 this->music_convert_buffer))
+			{
+				this->music_buffer->write(
+				    reinterpret_cast<const int16_t *>(this->music_convert_buffer.data()),
+				    this->music_convert_buffer.size() / sizeof(int16_t));
+			}
+			else
 			{
 				LogWarning("Failed to convert music data");
 			}
 
-			data->samples.resize(output_size);
-
 			if (ret == MusicTrack::MusicCallbackReturn::End)
 			{
 				this->track = nullptr;
+				// This will normally set the next track, which carries on straight after
 				if (this->music_finished_callback)
 				{
 					this->music_finished_callback(music_callback_data);
 				}
 			}
-			this->music_queue.push(data);
 		}
 	}
 
+	sp<SDLSampleData> getConvertedSample(const sp<Sample> &sample)
+	{
+		auto data =
+		    std::dynamic_pointer_cast<SDLSampleData>(std::atomic_load(&sample->backendData));
+		if (data && data->frequency == this->output_spec.freq &&
+		    data->channels == this->output_spec.channels)
+			return data;
+		return nullptr;
+	}
+
+	sp<SDLSampleData> convertSample(const Sample &sample)
+	{
+		auto data = mksp<SDLSampleData>(this->output_spec);
+		auto cacheDir = sampleCacheDirOption.get();
+		if (cacheDir.empty() || sample.path.empty())
+		{
+			data->convert(sample, this->output_spec);
+			return data;
+		}
+		auto key = getSampleCacheKey(sample, this->output_spec);
+		auto path = getSampleCachePath(cacheDir, key);
+		if (readCachedSample(path, key, *data))
+			return data;
+		data->convert(sample, this->output_spec);
+		writeCachedSample(path, key, *data);
+		return data;
+	}
+
   public:
 	void mixingCallback(Uint8 *stream, int len)
 	{
 		TRACE_FN;
-		// initialize stream buffer
-		memset(stream, 0, len);
-		std::lock_guard<std::recursive_mutex> lock(this->audio_lock);
-
-		if (this->current_music_data || !this->music_queue.empty())
+		// The output is always signed 16 bit, see the constructor
+		auto *output = reinterpret_cast<int16_t *>(stream);
+		unsigned int count = len / sizeof(int16_t);
+
+		// Only grows the first time round, or if the device asks for a bigger buffer
+		if (this->music_mix_buffer.size() < count)
+			this->music_mix_buffer.resize(count);
+		auto music_values = this->music_buffer->read(this->music_mix_buffer.data(), count);
+		if (music_values > 0 && music_values < count)
 		{
-			int int_music_volume =
-			    clamp((int)lrint(this->overall_volume * this->music_volume * 128.0f), 0, 128);
-			int music_bytes = 0;
-			while (music_bytes < len)
-			{
-				if (!this->current_music_data)
-				{
-					this->get_music_future =
-					    fw().threadPoolEnqueue(std::mem_fn(&SDLRawBackend::getMoreMusic), this);
-					if (this->music_queue.empty())
-					{
-						LogWarning("Music underrun!");
-						break;
-					}
-					this->current_music_data = this->music_queue.front();
-					this->music_queue.pop();
-				}
-				int bytes_from_this_chunk =
-				    std::min(len - music_bytes, (int)(this->current_music_data->samples.size() -
-				                                      this->current_music_data->sample_position));
-				SDL_MixAudioFormat(
-				    stream + music_bytes, this->current_music_data->samples.data() +
-				                              this->current_music_data->sample_position,
-				    this->output_spec.format, bytes_from_this_chunk, int_music_volume);
-				music_bytes += bytes_from_this_chunk;
-				this->current_music_data->sample_position += bytes_from_this_chunk;
-				LogAssert(this->current_music_data->sample_position <=
-				          this->current_music_data->samples.size());
-				if (this->current_music_data->sample_position ==
-				    this->current_music_data->samples.size())
-				{
-					this->current_music_data = nullptr;
-				}
-			}
+			LogWarning("Music underrun!");
 		}
-
-		auto sampleIt = this->live_samples.begin();
-		while (sampleIt != this->live_samples.end())
+		std::fill(this->music_mix_buffer.begin() + music_values,
+		          this->music_mix_buffer.begin() + count, 0);
+		if (this->music_playing &&
+		    this->music_buffer->getAvailable() < this->music_buffer->capacity() / 2)
 		{
-			int int_sample_volume = clamp(
-			    (int)lrint(this->overall_volume * this->sound_volume * sampleIt->gain * 128.0f), 0,
-			    128);
-			auto sampleData =
-			    std::dynamic_pointer_cast<SDLSampleData>(sampleIt->sample->backendData);
-			if (!sampleData)
-			{
-				LogWarning("Sample with invalid sample data");
-				// Clear it in case we've changed drivers or something
-				sampleIt->sample->backendData = nullptr;
-				sampleIt = this->live_samples.erase(sampleIt);
-				continue;
-			}
-			if (sampleIt->sample_position == sampleData->samples.size())
-			{
-				// Reached the end of the sample
-				sampleIt = this->live_samples.erase(sampleIt);
-				continue;
-			}
-
-			unsigned bytes_to_mix =
-			    std::min(len, (int)(sampleData->samples.size() - sampleIt->sample_position));
-			SDL_MixAudioFormat(stream, sampleData->samples.data() + sampleIt->sample_position,
-			                   this->output_spec.format, bytes_to_mix, int_sample_volume);
-			sampleIt->sample_position += bytes_to_mix;
-			LogAssert(sampleIt->sample_position <= sampleData->samples.size());
-
-			sampleIt++;
+			this->requestMoreMusic();
 		}
+
+		float overall = this->overall_volume;
+		this->mixer.mix(output, count, overall * this->sound_volume,
+		                music_values > 0 ? this->music_mix_buffer.data() : nullptr,
+		                overall * this->music_volume);
 	}
 
 	SDLRawBackend()
 	    : overall_volume(1.0f), music_volume(1.0f), sound_volume(1.0f), music_playing(false),
-	      music_callback_data(nullptr), music_queue_size(2)
+	      music_callback_data(nullptr), music_fetch_pending(false), in_music_fetch(false)
 	{
 		SDL_Init(SDL_INIT_AUDIO);
 		preferred_format.channels = 2;
@@ -285,7 +414,8 @@ class SDLRawBackend : public SoundBackend
 		LogInfo("Using audio device: %s", deviceName);
 		SDL_AudioSpec wantFormat;
 		wantFormat.channels = 2;
-		wantFormat.format = AUDIO_S16LSB;
+		// The mixer works in signed 16 bit, so make SDL convert to anything else the device wants
+		wantFormat.format = AUDIO_S16SYS;
 		wantFormat.freq = 22050;
 		wantFormat.samples = 512;
 		wantFormat.callback = unwrap_callback;
@@ -295,37 +425,59 @@ class SDLRawBackend : public SoundBackend
 		             // available
 		    0,       // capturing is not supported
 		    &wantFormat, &output_spec,
-		    SDL_AUDIO_ALLOW_ANY_CHANGE); // hopefully we'll get a sane output format
-		SDL_PauseAudioDevice(devID, 0);  // Run at once?
+		    SDL_AUDIO_ALLOW_FREQUENCY_CHANGE | SDL_AUDIO_ALLOW_CHANNELS_CHANGE);
 		LogInfo("Audio output format: Channels %d, format %d, freq %d, samples %d",
 		        (int)output_spec.channels, (int)output_spec.format, (int)output_spec.freq,
 		        (int)output_spec.samples);
+		// Keep about a second of music converted ahead
+		this->music_buffer.reset(
+		    new MusicRingBuffer(this->output_spec.freq * this->output_spec.channels));
+		SDL_PauseAudioDevice(devID, 0); // Run at once?
 	}
 	void playSample(sp<Sample> sample, float gain) override
 	{
 		// Clamp to 0..1
 		gain = std::min(1.0f, std::max(0.0f, gain));
-		if (!sample->backendData)
+		auto sampleData = this->getConvertedSample(sample);
+		if (!sampleData)
+		{
+			// Not prepared in advance, or converted for a different output format
+			sampleData = this->convertSample(*sample);
+			std::atomic_store(&sample->backendData, sp<BackendSampleData>(sampleData));
+		}
+		if (!this->mixer.playSample(sampleData, gain))
 		{
-			sample->backendData.reset(new SDLSampleData(sample, this->output_spec));
+			LogInfo("Sample queue full, dropping sound %p", sample.get());
 		}
+	}
+
+	void prepareSamples(const std::vector<sp<Sample>> &samples) override
+	{
+		TRACE_FN;
+		std::vector<std::function<void()>> conversions;
+		for (auto &sample : samples)
 		{
-			std::lock_guard<std::recursive_mutex> l(this->audio_lock);
-			this->live_samples.emplace_back(sample, gain);
+			if (!sample || this->getConvertedSample(sample))
+				continue;
+			conversions.push_back([this, sample]() {
+				std::atomic_store(&sample->backendData,
+				                  sp<BackendSampleData>(this->convertSample(*sample)));
+			});
 		}
-		LogInfo("Placed sound %p on queue", sample.get());
+		if (conversions.empty())
+			return;
+		LogInfo("Converting %u samples", (unsigned int)conversions.size());
+		fw().data->prefetch(std::move(conversions))->wait();
 	}
 
 	void playMusic(std::function<void(void *)> finishedCallback, void *callbackData) override
 	{
 		std::lock_guard<std::recursive_mutex> l(this->audio_lock);
-		while (!music_queue.empty())
-			music_queue.pop();
+		this->music_buffer->flush();
 		music_finished_callback = finishedCallback;
 		music_callback_data = callbackData;
 		music_playing = true;
-		this->get_music_future =
-		    fw().threadPoolEnqueue(std::mem_fn(&SDLRawBackend::getMoreMusic), this);
+		this->requestMoreMusic();
 		LogInfo("Playing music on SDL backend");
 	}
 
@@ -334,34 +486,29 @@ class SDLRawBackend : public SoundBackend
 		std::lock_guard<std::recursive_mutex> l(this->audio_lock);
 		LogInfo("Setting track to %p", track.get());
 		this->track = track;
-		while (!music_queue.empty())
-			music_queue.pop();
+		// When moving on from a track that just finished, let what's left of it play out
+		if (!this->in_music_fetch)
+			this->music_buffer->flush();
 	}
 
 	void stopMusic() override
 	{
-		std::future<void> outstanding_get_music;
-		{
-			std::lock_guard<std::recursive_mutex> l(this->audio_lock);
-			this->music_playing = false;
-			this->track = nullptr;
-			if (this->get_music_future.valid())
-				outstanding_get_music = std::move(this->get_music_future);
-			while (!music_queue.empty())
-				music_queue.pop();
-		}
-		if (outstanding_get_music.valid())
-			outstanding_get_music.wait();
+		std::lock_guard<std::recursive_mutex> l(this->audio_lock);
+		this->music_playing = false;
+		this->track = nullptr;
+		this->music_buffer->flush();
 	}
 
 	~SDLRawBackend() override
 	{
-		// Lock the device and stop any outstanding music threads to ensure everything is dead
+		// Stop the device and wait for any outstanding music fetch to ensure everything is dead
 		// before destroying the device
-		SDL_LockAudioDevice(devID);
 		SDL_PauseAudioDevice(devID, 1);
 		this->stopMusic();
-		SDL_UnlockAudioDevice(devID);
+		while (this->music_fetch_pending)
+		{
+			std::this_thread::yield();
+		}
 		SDL_CloseAudioDevice(devID);
 		SDL_QuitSubSystem(SDL_INIT_AUDIO);
 	}
@@ -39,6 +39,7 @@ enum class EventType : unsigned char
 {
 	Begin,
 	End,
+	Counter,
 };
 
 class TraceEvent
@@ -199,6 +200,20 @@ void TraceManager::write()
 					case EventType::End:
 						outFile << "\"ph\":\"E\"";
 						break;
+					case EventType::Counter:
+					{
+						outFile << "\"ph\":\"C\",\"args\":{";
+						bool firstArg = true;
+						for (auto &arg : event.args)
+						{
+							if (!firstArg)
+								outFile << ",";
+							firstArg = false;
+							outFile << "\"" << arg.first << "\":" << arg.second;
+						}
+						outFile << "}";
+						break;
+					}
 				}
 				outFile << "}";
 			}
@@ -228,6 +243,13 @@ void Trace::enable()
 	traceStartTime = std::chrono::high_resolution_clock::now();
 }
 
+bool Trace::isEnabled()
+{
+	if (!traceInited)
+		initTrace();
+	return enabled;
+}
+
 void Trace::disable()
 {
 	if (!enabled)
@@ -312,4 +334,24 @@ void Trace::end(const UString &name)
 	events->pushEvent(EventType::End, name, std::vector<std::pair<UString, UString>>{}, timeNS);
 }
 
+void Trace::counter(const UString &name, const std::vector<std::pair<UString, UString>> &values)
+{
+	if (!enabled)
+		return;
+#if defined(BROKEN_THREAD_LOCAL)
+	EventList *events = (EventList *)pthread_getspecific(eventListKey);
+	if (!events)
+	{
+		events = trace_manager->createThreadEventList();
+		pthread_setspecific(eventListKey, events);
+	}
+#else
+	if (!events)
+		events = trace_manager->createThreadEventList();
+#endif
+	auto timeNow = std::chrono::high_resolution_clock::now();
+	uint64_t timeNS = std::chrono::duration<uint64_t, std::nano>(timeNow - traceStartTime).count();
+	events->pushEvent(EventType::Counter, name, values, timeNS);
+}
+
 } // namespace OpenApoc
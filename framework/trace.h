@@ -17,8 +17,13 @@ class Trace
 	static void start(const UString &name,
 	                  const std::vector<std::pair<UString, UString>> &args = {});
 	static void end(const UString &end);
+	// Values are expected to be numeric strings, and are shown as a graph in the trace viewer
+	static void counter(const UString &name,
+	                    const std::vector<std::pair<UString, UString>> &values);
 
 	static bool enabled;
+	// As 'enabled', but reads the config the first time it's called
+	static bool isEnabled();
 
 	static void setThreadName(const UString &name);
 };
@@ -27,16 +32,56 @@ class TraceObj
 {
   public:
 	UString name;
+	// Tracing might be enabled or disabled part way through, so only end what was started
+	bool started = false;
 	TraceObj(const UString &name, const std::vector<std::pair<UString, UString>> &args = {})
-	    : name(name)
+	    : name(name), started(true)
 	{
 		Trace::start(name, args);
 	}
-	~TraceObj() { Trace::end(name); }
+	// For the TRACE_FN macros, nothing is built unless tracing is enabled
+	TraceObj(const char *name)
+	{
+		if (Trace::isEnabled())
+		{
+			this->name = name;
+			this->started = true;
+			Trace::start(this->name);
+		}
+	}
+	template <typename MakeArgs> TraceObj(const char *name, MakeArgs makeArgs)
+	{
+		if (Trace::isEnabled())
+		{
+			this->name = name;
+			this->started = true;
+			Trace::start(this->name, makeArgs());
+		}
+	}
+	~TraceObj()
+	{
+		if (started)
+			Trace::end(name);
+	}
 };
 
+// Whether the TRACE_FN macros are built in at all, set by the ENABLE_TRACE cmake option. Explicit
+// Trace::start()/end() calls are kept either way
+#ifndef OPENAPOC_TRACE
+#define OPENAPOC_TRACE 1
+#endif
+
+#if OPENAPOC_TRACE
 #define TRACE_FN TraceObj trace_object_##__COUNTER__(LOGGER_PREFIX)
 
-#define TRACE_FN_ARGS1(a, b) TraceObj trace_object_##__COUNTER__(LOGGER_PREFIX, {{a, b}})
+// 'b' is only evaluated if tracing is enabled
+#define TRACE_FN_ARGS1(a, b)                                                                       \
+	TraceObj trace_object_##__COUNTER__(                                                           \
+	    LOGGER_PREFIX, [&]() { return std::vector<std::pair<UString, UString>>{{a, b}}; })
+#else
+#define TRACE_FN
+// Still mentions the arguments, so variables only traced don't become unused
+#define TRACE_FN_ARGS1(a, b) ((void)sizeof(a), (void)sizeof(b))
+#endif
 
 } // namespace OpenApoc
@@ -25,6 +25,8 @@ class FrameAudio
   public:
 	unsigned frame;
 	up<char[]> samples;
+	// Frames get reused, so 'samples' may have been allocated bigger than this one needs
+	unsigned long buffer_size = 0;
 	unsigned sample_count;
 	AudioFormat format;
 };
@@ -1,3 +1,4 @@
+#include "framework/framework.h"
 #include "framework/fs.h"
 #include "framework/image.h"
 #include "framework/logger.h"
@@ -5,9 +6,12 @@
 #include "framework/sound.h"
 #include "framework/trace.h"
 #include "framework/video.h"
+#include <atomic>
+#include <condition_variable>
 #include <cstring>
 #include <mutex>
 #include <queue>
+#include <vector>
 
 // libsmacker.h doesn't set C abi by default, so wrap
 extern "C" {
@@ -35,9 +39,73 @@ class SMKMusicTrack : public MusicTrack
 	                             unsigned int *returnedSamples);
 };
 
+// Reuses frames once nothing holds them, as every frame of a video is the same size. A frame
+// comes back when its last reference is dropped, which for images is on the thread that drew
+// them, so the renderer's data for them is freed there too
+class SMKFramePool : public std::enable_shared_from_this<SMKFramePool>
+{
+  private:
+	std::mutex lock;
+	std::vector<up<FrameImage>> images;
+	std::vector<up<FrameAudio>> audio;
+
+  public:
+	sp<FrameImage> getImage(Vec2<int> size)
+	{
+		up<FrameImage> frame;
+		{
+			std::lock_guard<std::mutex> l(this->lock);
+			if (!this->images.empty())
+			{
+				frame = std::move(this->images.back());
+				this->images.pop_back();
+			}
+		}
+		if (!frame)
+		{
+			frame.reset(new FrameImage());
+			frame->image = mksp<PaletteImage>(size);
+		}
+		auto pool = shared_from_this();
+		return sp<FrameImage>(frame.release(), [pool](FrameImage *f) {
+			f->image->rendererPrivateData = nullptr;
+			f->palette = nullptr;
+			std::lock_guard<std::mutex> l(pool->lock);
+			pool->images.emplace_back(f);
+		});
+	}
+
+	sp<FrameAudio> getAudio()
+	{
+		up<FrameAudio> frame;
+		{
+			std::lock_guard<std::mutex> l(this->lock);
+			if (!this->audio.empty())
+			{
+				frame = std::move(this->audio.back());
+				this->audio.pop_back();
+			}
+		}
+		if (!frame)
+		{
+			frame.reset(new FrameAudio());
+		}
+		auto pool = shared_from_this();
+		return sp<FrameAudio>(frame.release(), [pool](FrameAudio *f) {
+			std::lock_guard<std::mutex> l(pool->lock);
+			pool->audio.emplace_back(f);
+		});
+	}
+};
+
 class SMKVideo : public Video, public std::enable_shared_from_this<SMKVideo>
 {
   public:
+	// How many frames the worker decodes ahead. It stops once either the image or audio queue
+	// has this many, so one nobody's reading can't grow without the other being read too
+	static const unsigned int DECODE_AHEAD = 8;
+	static const unsigned int PALETTE_BYTES = 256 * 3;
+
 	smk smk_ctx;
 	std::chrono::duration<unsigned int, std::nano> frame_time;
 	unsigned long frame_count;
@@ -51,11 +119,24 @@ class SMKVideo : public Video, public std::enable_shared_from_this<SMKVideo>
 	size_t video_data_size;
 	up<char[]> video_data;
 
-	bool stopped;
+	std::atomic<bool> stopped;
+
+	// Held while decoding, the smk context can only be used from one thread at a time
+	std::mutex decode_lock;
+	// The palette of the last frame decoded, shared by the frames after it until it changes
+	sp<Palette> palette;
+	std::vector<unsigned char> palette_data;
 
-	std::recursive_mutex frame_queue_lock;
+	// Guards everything below
+	std::mutex frame_queue_lock;
 	std::queue<sp<FrameImage>> image_queue;
 	std::queue<sp<FrameAudio>> audio_queue;
+	// Palettes the decoder has finished with. The renderer might have made its own data for them,
+	// so they're dropped on the thread popping images rather than the decoding one
+	std::vector<sp<Palette>> retired_palettes;
+	sp<SMKFramePool> pool;
+	bool decode_pending;
+	std::condition_variable decode_done;
 
 	AudioFormat audio_format;
 	unsigned audio_bytes_per_sample;
@@ -66,7 +147,7 @@ class SMKVideo : public Video, public std::enable_shared_from_this<SMKVideo>
 	SMKVideo()
 	    : smk_ctx(nullptr), frame_time(0), frame_count(0), current_frame_video(0),
 	      current_frame_audio(0), current_frame_read(0), frame_size(0, 0), video_data_size(0),
-	      stopped(false)
+	      stopped(false), pool(mksp<SMKFramePool>()), decode_pending(false)
 	{
 	}
 
@@ -77,44 +158,92 @@ class SMKVideo : public Video, public std::enable_shared_from_this<SMKVideo>
 	unsigned getFrameCount() const override { return this->frame_count; }
 	Vec2<int> getVideoSize() const override { return this->frame_size; }
 
-	sp<FrameImage> popImage() override
+	// Takes the next frame off 'queue', decoding on this thread if the worker hasn't got to it yet
+	template <typename T> sp<T> popFrame(std::queue<sp<T>> &queue)
 	{
-		TRACE_FN_ARGS1("Frame", Strings::fromInteger(this->current_frame_video));
-		std::lock_guard<std::recursive_mutex> l(this->frame_queue_lock);
-		if (this->image_queue.empty())
+		bool decoded = true;
+		while (true)
 		{
-			if (this->readNextFrame() == false)
 			{
-				return nullptr;
+				std::lock_guard<std::mutex> l(this->frame_queue_lock);
+				if (!queue.empty())
+				{
+					auto frame = queue.front();
+					queue.pop();
+					return frame;
+				}
+				if (!decoded)
+				{
+					return nullptr;
+				}
 			}
+			decoded = this->decodeFrame();
 		}
-		auto frame = this->image_queue.front();
-		this->image_queue.pop();
-		this->current_frame_video++;
+	}
+
+	sp<FrameImage> popImage() override
+	{
+		TRACE_FN_ARGS1("Frame", Strings::fromInteger(this->current_frame_video));
+		auto frame = this->popFrame(this->image_queue);
+		std::lock_guard<std::mutex> l(this->frame_queue_lock);
+		if (frame)
+			this->current_frame_video++;
+		this->retired_palettes.clear();
+		this->requestDecodeAhead();
 		return frame;
 	}
 
 	sp<FrameAudio> popAudio() override
 	{
 		TRACE_FN_ARGS1("Frame", Strings::fromInteger(this->current_frame_audio));
-		std::lock_guard<std::recursive_mutex> l(this->frame_queue_lock);
-		if (this->audio_queue.empty())
+		auto frame = this->popFrame(this->audio_queue);
+		std::lock_guard<std::mutex> l(this->frame_queue_lock);
+		if (frame)
+			this->current_frame_audio++;
+		this->requestDecodeAhead();
+		return frame;
+	}
+
+	// Must be called with frame_queue_lock held
+	void requestDecodeAhead()
+	{
+		if (this->decode_pending || this->stopped || this->image_queue.size() >= DECODE_AHEAD ||
+		    this->audio_queue.size() >= DECODE_AHEAD)
+		{
+			return;
+		}
+		this->decode_pending = true;
+		// The destructor waits for this to finish, so 'this' stays valid
+		fw().threadPoolTaskEnqueue([this]() { this->decodeAhead(); });
+	}
+
+	void decodeAhead()
+	{
+		TRACE_FN;
+		while (true)
 		{
-			if (this->readNextFrame() == false)
 			{
-				return nullptr;
+				std::lock_guard<std::mutex> l(this->frame_queue_lock);
+				if (this->stopped || this->image_queue.size() >= DECODE_AHEAD ||
+				    this->audio_queue.size() >= DECODE_AHEAD)
+				{
+					break;
+				}
+			}
+			if (!this->decodeFrame())
+			{
+				break;
 			}
 		}
-		auto frame = this->audio_queue.front();
-		this->audio_queue.pop();
-		this->current_frame_audio++;
-		return frame;
+		std::lock_guard<std::mutex> l(this->frame_queue_lock);
+		this->decode_pending = false;
+		this->decode_done.notify_all();
 	}
 
-	bool readNextFrame()
+	bool decodeFrame()
 	{
 		TRACE_FN;
-		std::lock_guard<std::recursive_mutex> l(this->frame_queue_lock);
+		std::lock_guard<std::mutex> decode(this->decode_lock);
 		if (this->stopped)
 			return false;
 
@@ -127,6 +256,7 @@ class SMKVideo : public Video, public std::enable_shared_from_this<SMKVideo>
 		if (ret == SMK_ERROR)
 		{
 			LogWarning("Error decoding frame %u", this->current_frame_read);
+			this->stopped = true;
 			return false;
 		}
 
@@ -140,66 +270,90 @@ class SMKVideo : public Video, public std::enable_shared_from_this<SMKVideo>
 		if (!palette_data)
 		{
 			LogWarning("Failed to get palette data for frame %u", this->current_frame_read);
+			this->stopped = true;
 			return false;
 		}
 		const unsigned char *image_data = smk_get_video(this->smk_ctx);
 		if (!image_data)
 		{
 			LogWarning("Failed to get image data for frame %u", this->current_frame_read);
+			this->stopped = true;
 			return false;
 		}
-
-		auto frame = mksp<FrameImage>();
-		frame->frame = this->current_frame_read;
-
-		auto img = mksp<PaletteImage>(this->frame_size);
-		frame->image = img;
-		frame->palette = mksp<Palette>(256);
-
-		PaletteImageLock img_lock(img);
-		memcpy(img_lock.getData(), image_data, this->frame_size.x * this->frame_size.y);
-
-		for (unsigned int i = 0; i < 256; i++)
-		{
-			auto red = *palette_data++;
-			auto green = *palette_data++;
-			auto blue = *palette_data++;
-			frame->palette->setColour(i, {red, green, blue});
-		}
-
-		auto audio_frame = mksp<FrameAudio>();
-		audio_frame->frame = current_frame_read;
-		audio_frame->format = this->audio_format;
 		unsigned long audio_bytes = smk_get_audio_size(this->smk_ctx, 0);
 		if (audio_bytes == 0)
 		{
 			LogWarning("Error reading audio size for frame %u", this->current_frame_read);
+			this->stopped = true;
 			return false;
 		}
-
-		auto sample_count =
-		    audio_bytes / (this->audio_bytes_per_sample * this->audio_format.channels);
-		audio_frame->samples.reset(new char[audio_bytes]);
-		audio_frame->sample_count = sample_count;
 		auto sample_pointer = smk_get_audio(this->smk_ctx, 0);
 		if (!sample_pointer)
 		{
 			LogWarning("Error reading audio data for frame %u", this->current_frame_read);
+			this->stopped = true;
 			return false;
 		}
-		memcpy(audio_frame->samples.get(), sample_pointer, audio_bytes);
 
-		LogInfo("Read %lu samples bytes, %u samples", audio_bytes, audio_frame->sample_count);
+		auto frame = this->pool->getImage(this->frame_size);
+		auto audio_frame = this->pool->getAudio();
+
+		frame->frame = this->current_frame_read;
+		{
+			PaletteImageLock img_lock(std::static_pointer_cast<PaletteImage>(frame->image));
+			memcpy(img_lock.getData(), image_data, this->frame_size.x * this->frame_size.y);
+		}
+
+		// Most videos never change palette, so only make a new one when they do
+		if (!this->palette || memcmp(this->palette_data.data(), palette_data, PALETTE_BYTES) != 0)
+		{
+			if (this->palette)
+			{
+				std::lock_guard<std::mutex> l(this->frame_queue_lock);
+				this->retired_palettes.push_back(std::move(this->palette));
+			}
+			this->palette_data.assign(palette_data, palette_data + PALETTE_BYTES);
+			this->palette = mksp<Palette>(256);
+			for (unsigned int i = 0; i < 256; i++)
+			{
+				auto red = *palette_data++;
+				auto green = *palette_data++;
+				auto blue = *palette_data++;
+				this->palette->setColour(i, {red, green, blue});
+			}
+		}
+		frame->palette = this->palette;
 
-		this->image_queue.push(frame);
-		this->audio_queue.push(audio_frame);
+		audio_frame->frame = current_frame_read;
+		audio_frame->format = this->audio_format;
+		auto sample_count =
+		    audio_bytes / (this->audio_bytes_per_sample * this->audio_format.channels);
+		if (audio_frame->buffer_size < audio_bytes)
+		{
+			audio_frame->samples.reset(new char[audio_bytes]);
+			audio_frame->buffer_size = audio_bytes;
+		}
+		audio_frame->sample_count = sample_count;
+		memcpy(audio_frame->samples.get(), sample_pointer, audio_bytes);
+
+		{
+			std::lock_guard<std::mutex> l(this->frame_queue_lock);
+			this->image_queue.push(frame);
+			this->audio_queue.push(audio_frame);
+		}
 
-		LogInfo("read frame %u", this->current_frame_read);
 		this->current_frame_read++;
 		return true;
 	}
 
-	void stop() override { this->stopped = true; }
+	void stop() override
+	{
+		// Waits for any frame being decoded, so the palette can be dropped here rather than on the
+		// decoding thread
+		std::lock_guard<std::mutex> decode(this->decode_lock);
+		this->stopped = true;
+		this->palette = nullptr;
+	}
 
 	bool load(IFile &file)
 	{
@@ -339,6 +493,11 @@ class SMKVideo : public Video, public std::enable_shared_from_this<SMKVideo>
 
 	~SMKVideo() override
 	{
+		this->stopped = true;
+		{
+			std::unique_lock<std::mutex> l(this->frame_queue_lock);
+			this->decode_done.wait(l, [this]() { return !this->decode_pending; });
+		}
 		if (this->smk_ctx)
 			smk_close(this->smk_ctx);
 	}
@@ -436,6 +436,7 @@ void AEquipment::explode(GameState &state)
 				                          payload->explosion_depletion_rate, payload->tail_size,
 				                          payload->projectile_sprites, payload->impact_sfx,
 				                          payload->explosion_graphic, payload->damage_type);
+				p->sequence = getNextObjectID(state, "PROJECTILE_");
 				state.current_battle->map->addObjectToMap(p);
 				state.current_battle->projectiles.insert(p);
 			}
@@ -504,6 +505,7 @@ void AEquipment::fire(GameState &state, Vec3<float> targetPosition, StateRef<Bat
 		    payload->damage, payload->explosion_depletion_rate, payload->tail_size,
 		    payload->projectile_sprites, payload->impact_sfx, payload->explosion_graphic,
 		    payload->damage_type);
+		p->sequence = getNextObjectID(state, "PROJECTILE_");
 		state.current_battle->map->addObjectToMap(p);
 		state.current_battle->projectiles.insert(p);
 	}
@@ -1,4 +1,5 @@
 #include "game/state/battle/battle.h"
+#include "framework/data.h"
 #include "framework/framework.h"
 #include "framework/sound.h"
 #include "framework/trace.h"
@@ -12,12 +13,14 @@
 #include "game/state/battle/battlemap.h"
 #include "game/state/battle/battlemappart.h"
 #include "game/state/battle/battlemappart_type.h"
+#include "game/state/battle/battlemaptileset.h"
 #include "game/state/battle/battleunit.h"
 #include "game/state/battle/battleunitanimationpack.h"
 #include "game/state/battle/battleunitimagepack.h"
 #include "game/state/city/city.h"
 #include "game/state/city/doodad.h"
 #include "game/state/city/projectile.h"
+#include "game/state/city/projectilebatch.h"
 #include "game/state/city/vehicle.h"
 #include "game/state/gamestate.h"
 #include "game/state/rules/aequipment_type.h"
@@ -54,6 +57,9 @@ static std::vector<std::set<TileObject::Type>> layerMap = {
 Battle::~Battle()
 {
 	TRACE_FN;
+	// Any prefetch loads still running write into this battle's members, so wait for them (and
+	// don't bother with the ones that haven't started)
+	this->resourcePrefetch = nullptr;
 	// Note due to backrefs to Tile*s etc. we need to destroy all tile objects
 	// before the TileMap
 	for (auto &p : this->projectiles)
@@ -70,6 +76,7 @@ Battle::~Battle()
 		s->tileObject = nullptr;
 	}
 	this->map_parts.clear();
+	this->activeMapParts.clear();
 	for (auto &u : this->visibleUnits)
 	{
 		u.second.clear();
@@ -89,6 +96,7 @@ Battle::~Battle()
 		i->item->ownerUnit.clear();
 	}
 	this->items.clear();
+	this->activeItems.clear();
 	this->doors.clear();
 }
 
@@ -202,6 +210,25 @@ void Battle::initBattle(GameState &state, bool first)
 		// Pathfinding
 		updatePathfinding(state);
 	}
+	// Only the map parts and items with something to do need updating
+	this->activeMapParts.clear();
+	for (auto &s : this->map_parts)
+	{
+		s->active = false;
+		if (s->needsUpdate())
+		{
+			activateMapPart(s);
+		}
+	}
+	this->activeItems.clear();
+	for (auto &o : this->items)
+	{
+		o->active = false;
+		if (o->needsUpdate())
+		{
+			activateItem(o);
+		}
+	}
 }
 
 void Battle::initMap()
@@ -213,14 +240,17 @@ void Battle::initMap()
 	}
 	this->map.reset(new TileMap(this->size, VELOCITY_SCALE_BATTLE,
 	                            {VOXEL_X_BATTLE, VOXEL_Y_BATTLE, VOXEL_Z_BATTLE}, layerMap));
+	this->projectileBatch.reset(new ProjectileBatch());
+	std::list<sp<BattleMapPart>> mapParts;
 	for (auto &s : this->map_parts)
 	{
 		if (s->destroyed)
 		{
 			continue;
 		}
-		this->map->addObjectToMap(s);
+		mapParts.push_back(s);
 	}
+	this->map->addObjectsToMap(mapParts);
 	for (auto &o : this->items)
 	{
 		this->map->addObjectToMap(o);
@@ -240,6 +270,7 @@ void Battle::initMap()
 	for (auto &d : this->doodads)
 	{
 		this->map->addObjectToMap(d);
+		d->schedule(this->doodadTimers);
 	}
 	for (auto &h : this->hazards)
 	{
@@ -371,6 +402,7 @@ sp<Doodad> Battle::placeDoodad(StateRef<DoodadType> type, Vec3<float> position)
 	if (map)
 	{
 		map->addObjectToMap(doodad);
+		doodad->schedule(this->doodadTimers);
 	}
 	this->doodads.push_back(doodad);
 	return doodad;
@@ -449,11 +481,32 @@ sp<BattleItem> Battle::placeItem(GameState &state, sp<AEquipment> item, Vec3<flo
 	if (map)
 	{
 		map->addObjectToMap(bitem);
+		activateItem(bitem);
 	}
 	items.push_back(bitem);
 	return bitem;
 }
 
+void Battle::activateMapPart(sp<BattleMapPart> mapPart)
+{
+	if (mapPart->active)
+	{
+		return;
+	}
+	mapPart->active = true;
+	activeMapParts.push_back(mapPart);
+}
+
+void Battle::activateItem(sp<BattleItem> item)
+{
+	if (item->active)
+	{
+		return;
+	}
+	item->active = true;
+	activeItems.push_back(item);
+}
+
 sp<BattleHazard> Battle::placeHazard(GameState &state, StateRef<DamageType> type,
                                      Vec3<int> position, int ttl, int power,
                                      int initialAgeTTLDivizor)
@@ -497,77 +550,67 @@ sp<BattleHazard> Battle::placeHazard(GameState &state, StateRef<DamageType> type
 
 void Battle::updateProjectiles(GameState &state, unsigned int ticks)
 {
-	for (auto it = this->projectiles.begin(); it != this->projectiles.end();)
+	this->projectileBatch->update(state, *map, this->projectiles, ticks,
+	                              [this, &state](Collision &c) { handleProjectileHit(state, c); });
+}
+
+void Battle::handleProjectileHit(GameState &state, Collision &c)
+{
+	// Alert intended unit that he's on fire, if he cannot see the firer
+	auto unit = c.projectile->trackedUnit;
+	if (unit && unit->visibleUnits.find(c.projectile->firerUnit) == unit->visibleUnits.end())
 	{
-		auto p = *it++;
-		p->update(state, ticks);
+		LogWarning("Notify: unit %s that he's taking fire", c.projectile->trackedUnit.id);
+		unit->attackerPosition = c.projectile->firerUnit->position;
 	}
-	for (auto it = this->projectiles.begin(); it != this->projectiles.end();)
+	// Handle collision
+	bool playSound = true;
+	bool displayDoodad = true;
+	if (c.projectile->damageType->explosive)
 	{
-		auto &p = *it++;
-		auto c = p->checkProjectileCollision(*map);
-		if (c)
+		auto explosion = addExplosion(state, c.position, c.projectile->doodadType,
+		                              c.projectile->damageType, c.projectile->damage,
+		                              c.projectile->depletionRate, c.projectile->firerUnit);
+		displayDoodad = false;
+	}
+	else
+	{
+		switch (c.obj->getType())
 		{
-			// Alert intended unit that he's on fire, if he cannot see the firer
-			auto unit = c.projectile->trackedUnit;
-			if (unit &&
-			    unit->visibleUnits.find(c.projectile->firerUnit) == unit->visibleUnits.end())
-			{
-				LogWarning("Notify: unit %s that he's taking fire", c.projectile->trackedUnit.id);
-				unit->attackerPosition = c.projectile->firerUnit->position;
-			}
-			// Handle collision
-			this->projectiles.erase(c.projectile);
-			bool playSound = true;
-			bool displayDoodad = true;
-			if (c.projectile->damageType->explosive)
-			{
-				auto explosion = addExplosion(state, c.position, c.projectile->doodadType,
-				                              c.projectile->damageType, c.projectile->damage,
-				                              c.projectile->depletionRate, c.projectile->firerUnit);
-				displayDoodad = false;
-			}
-			else
-			{
-				switch (c.obj->getType())
-				{
-					case TileObject::Type::Unit:
-					{
-						auto unit =
-						    std::static_pointer_cast<TileObjectBattleUnit>(c.obj)->getUnit();
-						displayDoodad = !unit->handleCollision(state, c);
-						playSound = false;
-						break;
-					}
-					case TileObject::Type::Ground:
-					case TileObject::Type::LeftWall:
-					case TileObject::Type::RightWall:
-					case TileObject::Type::Feature:
-					{
-						auto mapPartTile = std::static_pointer_cast<TileObjectBattleMapPart>(c.obj);
-						displayDoodad = !mapPartTile->getOwner()->handleCollision(state, c);
-						playSound = displayDoodad;
-						break;
-					}
-					default:
-						LogError("Collision with non-collidable object");
-				}
-			}
-			if (displayDoodad)
+			case TileObject::Type::Unit:
 			{
-				auto doodadType = c.projectile->doodadType;
-				if (doodadType)
-				{
-					auto doodad = this->placeDoodad(doodadType, c.position);
-				}
+				auto unit = std::static_pointer_cast<TileObjectBattleUnit>(c.obj)->getUnit();
+				displayDoodad = !unit->handleCollision(state, c);
+				playSound = false;
+				break;
 			}
-			if (playSound)
+			case TileObject::Type::Ground:
+			case TileObject::Type::LeftWall:
+			case TileObject::Type::RightWall:
+			case TileObject::Type::Feature:
 			{
-				if (c.projectile->impactSfx)
-				{
-					fw().soundBackend->playSample(c.projectile->impactSfx, c.position);
-				}
+				auto mapPartTile = std::static_pointer_cast<TileObjectBattleMapPart>(c.obj);
+				displayDoodad = !mapPartTile->getOwner()->handleCollision(state, c);
+				playSound = displayDoodad;
+				break;
 			}
+			default:
+				LogError("Collision with non-collidable object");
+		}
+	}
+	if (displayDoodad)
+	{
+		auto doodadType = c.projectile->doodadType;
+		if (doodadType)
+		{
+			auto doodad = this->placeDoodad(doodadType, c.position);
+		}
+	}
+	if (playSound)
+	{
+		if (c.projectile->impactSfx)
+		{
+			fw().soundBackend->playSample(c.projectile->impactSfx, c.position);
 		}
 	}
 }
@@ -646,8 +689,9 @@ bool findLosBlockCenter(TileMap &map, BattleUnitType type,
 					}
 					somethingHappened = true;
 
-					auto t = map.getTile(x, y, z);
-					if (t->getPassable(large, height) && (flying || t->getCanStand(large)))
+					Vec3<int> pos = {x, y, z};
+					if (map.navGrid.getPassable(pos, large, height) &&
+					    (flying || map.navGrid.getCanStand(pos, large)))
 					{
 						closestValidPos = {x, y, z};
 						return true;
@@ -780,11 +824,9 @@ void Battle::update(GameState &state, unsigned int ticks)
 	}
 	Trace::end("Battle::update::doors->update");
 	Trace::start("Battle::update::doodads->update");
-	for (auto it = this->doodads.begin(); it != this->doodads.end();)
-	{
-		auto d = *it++;
-		d->update(state, ticks);
-	}
+	this->doodadTimers.advance(ticks, [this, &state](const sp<Doodad> &d) {
+		d->updateScheduled(state, this->doodadTimers);
+	});
 	Trace::end("Battle::update::doodads->update");
 	Trace::start("Battle::update::hazards->update");
 	for (auto it = this->hazards.begin(); it != this->hazards.end();)
@@ -801,16 +843,35 @@ void Battle::update(GameState &state, unsigned int ticks)
 	}
 	Trace::end("Battle::update::explosions->update");
 	Trace::start("Battle::update::map_parts->update");
-	for (auto &o : this->map_parts)
+	for (auto it = this->activeMapParts.begin(); it != this->activeMapParts.end();)
 	{
+		auto o = *it;
 		o->update(state, ticks);
+		if (o->needsUpdate())
+		{
+			it++;
+		}
+		else
+		{
+			o->active = false;
+			it = this->activeMapParts.erase(it);
+		}
 	}
 	Trace::end("Battle::update::map_parts->update");
 	Trace::start("Battle::update::items->update");
-	for (auto it = this->items.begin(); it != this->items.end();)
+	for (auto it = this->activeItems.begin(); it != this->activeItems.end();)
 	{
-		auto p = *it++;
+		auto p = *it;
 		p->update(state, ticks);
+		if (p->needsUpdate())
+		{
+			it++;
+		}
+		else
+		{
+			p->active = false;
+			it = this->activeItems.erase(it);
+		}
 	}
 	Trace::end("Battle::update::items->update");
 	Trace::start("Battle::update::units->update");
@@ -1624,9 +1685,16 @@ void Battle::exitBattle(GameState &state)
 
 void Battle::loadResources(GameState &state)
 {
-	battle_map->loadTilesets(state);
+	if (this->resourcePrefetch)
+	{
+		this->resourcePrefetch->wait();
+	}
+	battle_map->loadTilesets(state, this->prefetchedTilesets);
 	loadImagePacks(state);
 	loadAnimationPacks(state);
+	// The tilesets bring their own sounds, convert them now rather than when first heard
+	if (fw().soundBackend)
+		fw().soundBackend->prepareSamples(fw().data->getLoadedSamples());
 }
 
 void Battle::unloadResources(GameState &state)
@@ -1636,71 +1704,158 @@ void Battle::unloadResources(GameState &state)
 	unloadAnimationPacks(state);
 }
 
-void Battle::loadImagePacks(GameState &state)
+void Battle::prefetchResources(GameState &state)
 {
-	if (state.battle_unit_image_packs.size() > 0)
+	if (this->resourcePrefetch)
 	{
-		LogInfo("Image packs are already loaded.");
 		return;
 	}
+	std::vector<std::function<void()>> loads;
+
+	// Tilesets are the slowest, so get them started first
+	if (this->battle_map && state.battleMapTiles.empty())
+	{
+		for (auto &tilesetName : this->battle_map->tilesets)
+		{
+			auto tilesetPath = BattleMapTileset::getTilesetPath() + "/" + tilesetName;
+			auto &tileset = this->prefetchedTilesets[tilesetName];
+			tileset = mksp<BattleMapTileset>();
+			loads.push_back([&state, &tileset, tilesetName, tilesetPath]() {
+				LogInfo("Prefetching tileset \"%s\" from \"%s\"", tilesetName, tilesetPath);
+				if (!tileset->loadTileset(state, tilesetPath))
+				{
+					LogError("Failed to load tileset \"%s\" from \"%s\"", tilesetName,
+					         tilesetPath);
+					tileset = nullptr;
+				}
+			});
+		}
+	}
+	for (auto &imagePackName : getImagePackNames())
+	{
+		auto imagePackPath = BattleUnitImagePack::getImagePackPath() + "/" + imagePackName;
+		auto &imagePack = this->prefetchedImagePacks[imagePackName];
+		imagePack = mksp<BattleUnitImagePack>();
+		loads.push_back([&state, &imagePack, imagePackName, imagePackPath]() {
+			LogInfo("Prefetching image pack \"%s\" from \"%s\"", imagePackName, imagePackPath);
+			if (!imagePack->loadImagePack(state, imagePackPath))
+			{
+				LogError("Failed to load image pack \"%s\" from \"%s\"", imagePackName,
+				         imagePackPath);
+				imagePack = nullptr;
+			}
+		});
+	}
+	for (auto &animationPackName : getAnimationPackNames())
+	{
+		auto animationPackPath =
+		    BattleUnitAnimationPack::getAnimationPackPath() + "/" + animationPackName;
+		auto &animationPack = this->prefetchedAnimationPacks[animationPackName];
+		animationPack = mksp<BattleUnitAnimationPack>();
+		loads.push_back([&state, &animationPack, animationPackName, animationPackPath]() {
+			LogInfo("Prefetching animation pack \"%s\" from \"%s\"", animationPackName,
+			        animationPackPath);
+			if (!animationPack->loadAnimationPack(state, animationPackPath))
+			{
+				LogError("Failed to load animation pack \"%s\" from \"%s\"", animationPackName,
+				         animationPackPath);
+				animationPack = nullptr;
+			}
+		});
+	}
+
+	LogInfo("Prefetching %u battle tilesets and resource packs", (unsigned)loads.size());
+	this->resourcePrefetch = fw().data->prefetch(std::move(loads));
+}
+
+float Battle::getPrefetchProgress() const
+{
+	if (!this->resourcePrefetch)
+	{
+		return 1.0f;
+	}
+	return this->resourcePrefetch->getProgress();
+}
+
+void Battle::finishPrefetch()
+{
+	if (!this->resourcePrefetch)
+	{
+		return;
+	}
+	// The loads write to the prefetched* maps, so they must finish before they're touched
+	this->resourcePrefetch->wait();
+	this->prefetchedTilesets.clear();
+	this->prefetchedImagePacks.clear();
+	this->prefetchedAnimationPacks.clear();
+}
+
+std::set<UString> Battle::getImagePackNames() const
+{
 	// Find out all image packs used by map's units and items
 	std::set<UString> imagePacks;
 	for (auto &p : units)
 	{
 		auto &bu = p.second;
-		{
-			auto packName = BattleUnitImagePack::getNameFromID(bu->agent->type->shadow_pack.id);
-			if (imagePacks.find(packName) == imagePacks.end())
-				imagePacks.insert(packName);
-		}
+		imagePacks.insert(BattleUnitImagePack::getNameFromID(bu->agent->type->shadow_pack.id));
 		for (auto &pv : bu->agent->type->image_packs)
 		{
 			for (auto &ip : pv)
 			{
-				auto packName = BattleUnitImagePack::getNameFromID(ip.second.id);
-				if (imagePacks.find(packName) == imagePacks.end())
-					imagePacks.insert(packName);
+				imagePacks.insert(BattleUnitImagePack::getNameFromID(ip.second.id));
 			}
 		}
 		for (auto &ae : bu->agent->equipment)
 		{
-			{
-				auto packName = BattleUnitImagePack::getNameFromID(ae->type->body_image_pack.id);
-				if (imagePacks.find(packName) == imagePacks.end())
-					imagePacks.insert(packName);
-			}
-			{
-				auto packName = BattleUnitImagePack::getNameFromID(ae->type->held_image_pack.id);
-				if (imagePacks.find(packName) == imagePacks.end())
-					imagePacks.insert(packName);
-			}
+			imagePacks.insert(BattleUnitImagePack::getNameFromID(ae->type->body_image_pack.id));
+			imagePacks.insert(BattleUnitImagePack::getNameFromID(ae->type->held_image_pack.id));
 		}
 	}
 	for (auto &bi : items)
 	{
-		{
-			auto packName = BattleUnitImagePack::getNameFromID(bi->item->type->body_image_pack.id);
-			if (imagePacks.find(packName) == imagePacks.end())
-				imagePacks.insert(packName);
-		}
-		{
-			auto packName = BattleUnitImagePack::getNameFromID(bi->item->type->held_image_pack.id);
-			if (imagePacks.find(packName) == imagePacks.end())
-				imagePacks.insert(packName);
-		}
+		imagePacks.insert(BattleUnitImagePack::getNameFromID(bi->item->type->body_image_pack.id));
+		imagePacks.insert(BattleUnitImagePack::getNameFromID(bi->item->type->held_image_pack.id));
+	}
+	imagePacks.erase("");
+	return imagePacks;
+}
+
+void Battle::loadImagePacks(GameState &state)
+{
+	if (state.battle_unit_image_packs.size() > 0)
+	{
+		LogInfo("Image packs are already loaded.");
+		return;
+	}
+	if (this->resourcePrefetch)
+	{
+		this->resourcePrefetch->wait();
 	}
 	// Load all used image packs
-	for (auto &imagePackName : imagePacks)
+	for (auto &imagePackName : getImagePackNames())
 	{
-		if (imagePackName.length() == 0)
-			continue;
 		auto imagePackPath = BattleUnitImagePack::getImagePackPath() + "/" + imagePackName;
-		LogInfo("Loading image pack \"%s\" from \"%s\"", imagePackName, imagePackPath);
-		auto imagePack = mksp<BattleUnitImagePack>();
-		if (!imagePack->loadImagePack(state, imagePackPath))
+		sp<BattleUnitImagePack> imagePack;
+		auto prefetched = this->prefetchedImagePacks.find(imagePackName);
+		if (prefetched != this->prefetchedImagePacks.end())
 		{
-			LogError("Failed to load image pack \"%s\" from \"%s\"", imagePackName, imagePackPath);
-			continue;
+			imagePack = prefetched->second;
+			if (!imagePack)
+			{
+				// Already reported by the prefetch
+				continue;
+			}
+		}
+		else
+		{
+			LogInfo("Loading image pack \"%s\" from \"%s\"", imagePackName, imagePackPath);
+			imagePack = mksp<BattleUnitImagePack>();
+			if (!imagePack->loadImagePack(state, imagePackPath))
+			{
+				LogError("Failed to load image pack \"%s\" from \"%s\"", imagePackName,
+				         imagePackPath);
+				continue;
+			}
 		}
 		state.battle_unit_image_packs[format("%s%s", BattleUnitImagePack::getPrefix(),
 		                                     imagePackName)] = imagePack;
@@ -1710,40 +1865,63 @@ void Battle::loadImagePacks(GameState &state)
 
 void Battle::unloadImagePacks(GameState &state)
 {
+	finishPrefetch();
 	state.battle_unit_image_packs.clear();
 	LogInfo("Unloaded all image packs.");
 }
 
-void Battle::loadAnimationPacks(GameState &state)
+std::set<UString> Battle::getAnimationPackNames() const
 {
-	if (state.battle_unit_animation_packs.size() > 0)
-	{
-		LogInfo("Animation packs are already loaded.");
-		return;
-	}
 	// Find out all animation packs used by units
 	std::set<UString> animationPacks;
 	for (auto &u : units)
 	{
 		for (auto &ap : u.second->agent->type->animation_packs)
 		{
-			auto packName = BattleUnitAnimationPack::getNameFromID(ap.id);
-			if (animationPacks.find(packName) == animationPacks.end())
-				animationPacks.insert(packName);
+			animationPacks.insert(BattleUnitAnimationPack::getNameFromID(ap.id));
 		}
 	}
+	return animationPacks;
+}
+
+void Battle::loadAnimationPacks(GameState &state)
+{
+	if (state.battle_unit_animation_packs.size() > 0)
+	{
+		LogInfo("Animation packs are already loaded.");
+		return;
+	}
+	if (this->resourcePrefetch)
+	{
+		this->resourcePrefetch->wait();
+	}
 	// Load all used animation packs
-	for (auto &animationPackName : animationPacks)
+	for (auto &animationPackName : getAnimationPackNames())
 	{
 		auto animationPackPath =
 		    BattleUnitAnimationPack::getAnimationPackPath() + "/" + animationPackName;
-		LogInfo("Loading animation pack \"%s\" from \"%s\"", animationPackName, animationPackPath);
-		auto animationPack = mksp<BattleUnitAnimationPack>();
-		if (!animationPack->loadAnimationPack(state, animationPackPath))
+		sp<BattleUnitAnimationPack> animationPack;
+		auto prefetched = this->prefetchedAnimationPacks.find(animationPackName);
+		if (prefetched != this->prefetchedAnimationPacks.end())
 		{
-			LogError("Failed to load animation pack \"%s\" from \"%s\"", animationPackName,
-			         animationPackPath);
-			continue;
+			animationPack = prefetched->second;
+			if (!animationPack)
+			{
+				// Already reported by the prefetch
+				continue;
+			}
+		}
+		else
+		{
+			LogInfo("Loading animation pack \"%s\" from \"%s\"", animationPackName,
+			        animationPackPath);
+			animationPack = mksp<BattleUnitAnimationPack>();
+			if (!animationPack->loadAnimationPack(state, animationPackPath))
+			{
+				LogError("Failed to load animation pack \"%s\" from \"%s\"", animationPackName,
+				         animationPackPath);
+				continue;
+			}
 		}
 		state.battle_unit_animation_packs[format("%s%s", BattleUnitAnimationPack::getPrefix(),
 		                                         animationPackName)] = animationPack;
@@ -1753,6 +1931,7 @@ void Battle::loadAnimationPacks(GameState &state)
 
 void Battle::unloadAnimationPacks(GameState &state)
 {
+	finishPrefetch();
 	state.battle_unit_animation_packs.clear();
 	LogInfo("Unloaded all animation packs.");
 }
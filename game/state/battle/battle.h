@@ -5,6 +5,7 @@
 #include "game/state/gametime.h"
 #include "game/state/stateobject.h"
 #include "library/sp.h"
+#include "library/timerwheel.h"
 #include "library/vec.h"
 #include <list>
 #include <map>
@@ -28,6 +29,7 @@ class BattleCommonSampleList;
 class GameState;
 class TileMap;
 class BattleMapPart;
+class BattleMapTileset;
 class BattleUnit;
 class AEquipment;
 class BattleDoor;
@@ -36,6 +38,8 @@ class BattleExplosion;
 class BattleHazard;
 class DamageType;
 class Projectile;
+class ProjectileBatch;
+class Collision;
 class Doodad;
 class DoodadType;
 class BattleMap;
@@ -44,6 +48,9 @@ class Building;
 class Agent;
 enum class BattleUnitType;
 class BattleUnitTileHelper;
+class BattleUnitImagePack;
+class BattleUnitAnimationPack;
+class PrefetchJob;
 
 class Battle : public std::enable_shared_from_this<Battle>
 {
@@ -136,9 +143,16 @@ class Battle : public std::enable_shared_from_this<Battle>
 
 	std::list<sp<BattleMapPart>> map_parts;
 	std::list<sp<BattleItem>> items;
+	// The map parts and items that have something to do each tick, everything else is dormant
+	// until something activates it. Rebuilt in initBattle()
+	std::list<sp<BattleMapPart>> activeMapParts;
+	std::list<sp<BattleItem>> activeItems;
 	StateRefMap<BattleUnit> units;
 	std::list<sp<Doodad>> doodads;
+	// Fires when a doodad next changes frame or expires
+	TimerWheel<Doodad> doodadTimers;
 	std::set<sp<Projectile>> projectiles;
+	up<ProjectileBatch> projectileBatch;
 	StateRefMap<BattleDoor> doors;
 	std::set<sp<BattleExplosion>> explosions;
 	std::set<sp<BattleHazard>> hazards;
@@ -166,6 +180,7 @@ class Battle : public std::enable_shared_from_this<Battle>
 	void update(GameState &state, unsigned int ticks);
 
 	void updateProjectiles(GameState &state, unsigned int ticks);
+	void handleProjectileHit(GameState &state, Collision &c);
 	void updateVision(GameState &state);
 	void updatePathfinding(GameState &state);
 
@@ -183,6 +198,10 @@ class Battle : public std::enable_shared_from_this<Battle>
 	sp<BattleHazard> placeHazard(GameState &state, StateRef<DamageType> type, Vec3<int> position,
 	                             int ttl, int power, int initialAgeTTLDivizor = 1);
 
+	// Adds to the lists of map parts and items updated each tick, if not already on them
+	void activateMapPart(sp<BattleMapPart> mapPart);
+	void activateItem(sp<BattleItem> item);
+
 	static void accuracyAlgorithmBattle(GameState &state, Vec3<float> firePosition,
 	                                    Vec3<float> &target, int accuracy, bool thrown = false);
 
@@ -206,6 +225,12 @@ class Battle : public std::enable_shared_from_this<Battle>
 	                        std::list<StateRef<Agent>> &player_agents,
 	                        StateRef<Vehicle> player_craft, StateRef<Building> target_building);
 
+	// To be called once the battle has been created, starts loading the map's tilesets and the
+	// unit image and animation packs in the background so enterBattle() doesn't have to
+	void prefetchResources(GameState &state);
+	// Returns 0.0 to 1.0, or 1.0 if nothing is being prefetched
+	float getPrefetchProgress() const;
+
 	// To be called when battle must be started, after briefing screen
 	static void enterBattle(GameState &state);
 
@@ -221,12 +246,23 @@ class Battle : public std::enable_shared_from_this<Battle>
 	void loadResources(GameState &state);
 	void unloadResources(GameState &state);
 
+	std::set<UString> getImagePackNames() const;
 	void loadImagePacks(GameState &state);
 	void unloadImagePacks(GameState &state);
 
+	std::set<UString> getAnimationPackNames() const;
 	void loadAnimationPacks(GameState &state);
 	void unloadAnimationPacks(GameState &state);
 
+	// Tilesets and packs are loaded into these by the prefetch job, and moved into the GameState
+	// by loadTilesets()/loadImagePacks()/loadAnimationPacks(). One is null if it failed to load.
+	std::map<UString, sp<BattleMapTileset>> prefetchedTilesets;
+	std::map<UString, sp<BattleUnitImagePack>> prefetchedImagePacks;
+	std::map<UString, sp<BattleUnitAnimationPack>> prefetchedAnimationPacks;
+	// After the maps it loads into, so it's destroyed (waiting for running loads) first
+	sp<PrefetchJob> resourcePrefetch;
+	void finishPrefetch();
+
 	friend class BattleMap;
 
   public:
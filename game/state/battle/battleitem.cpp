@@ -72,6 +72,7 @@ void BattleItem::hopTo(GameState &state, Vec3<float> targetPosition)
 		// Enough to leave our home cell
 		collisionIgnoredTicks =
 		    (int)ceilf(36.0f / glm::length(velocity / VELOCITY_SCALE_BATTLE)) + 1;
+		state.current_battle->activateItem(shared_from_this());
 	}
 }
 
@@ -268,6 +269,17 @@ void BattleItem::update(GameState &state, unsigned int ticks)
 	}
 }
 
+bool BattleItem::needsUpdate() const
+{
+	if (!tileObject)
+		return false;
+	if (falling || ticksUntilCollapse > 0)
+		return true;
+	auto payload = item->getPayloadType();
+	return item->primed || item->inUse || item->isFiring() ||
+	       (payload && payload->recharge > 0 && item->ammo < payload->max_ammo);
+}
+
 void BattleItem::getSupport()
 {
 	auto tile = tileObject->getOwningTile();
@@ -57,6 +57,9 @@ class BattleItem : public std::enable_shared_from_this<BattleItem>
 	void hopTo(GameState &state, Vec3<float> targetPosition);
 
 	void update(GameState &state, unsigned int ticks);
+	// Wether update() has anything to do (falling, collapsing, or a primed or recharging item).
+	// Items that don't are left out of the battle's updates until something activates them again
+	bool needsUpdate() const;
 
 	BattleItem() = default;
 	~BattleItem() = default;
@@ -71,6 +74,8 @@ class BattleItem : public std::enable_shared_from_this<BattleItem>
 
 	sp<TileObjectBattleItem> tileObject;
 	sp<TileObjectShadow> shadowObject;
+	// Wether this is in the battle's list of active items
+	bool active = false;
 
   private:
 	bool findSupport();
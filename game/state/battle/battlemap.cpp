@@ -1,4 +1,6 @@
 #include "game/state/battle/battlemap.h"
+#include "framework/data.h"
+#include "framework/framework.h"
 #include "game/state/aequipment.h"
 #include "game/state/agent.h"
 #include "game/state/battle/battle.h"
@@ -759,6 +761,135 @@ bool BattleMap::generateMap(std::vector<sp<BattleMapSector>> &sec_map, Vec3<int>
 	return false;
 }
 
+bool BattleMap::allowsExit(MapDirection direction) const
+{
+	auto it = allow_exit.find(direction);
+	return it != allow_exit.end() && it->second;
+}
+
+void BattleMap::fillSector(
+    Battle &b, const BattleMapSectorTiles &tiles, Vec3<int> shift, Vec3<int> size,
+    std::list<sp<BattleMapPart>> &mapParts,
+    std::vector<std::list<std::pair<Vec3<int>, sp<BattleMapPart>>>> &doors) const
+{
+	for (auto &pair : tiles.initial_grounds)
+	{
+		auto s = mksp<BattleMapPart>();
+
+		auto initialPosition = pair.first + shift;
+		s->position = initialPosition;
+		s->queueCollapse();
+		s->position += Vec3<float>(0.5f, 0.5f, 0.0f);
+
+		// Check wether this is an exit location, and if so,
+		// replace the ground map part with an appropriate exit
+		bool canExit = s->position.z >= exit_level_min && s->position.z <= exit_level_max;
+		canExit = canExit && (s->position.x > 0 || allowsExit(MapDirection::West)) &&
+		          (s->position.y > 0 || allowsExit(MapDirection::North)) &&
+		          (s->position.x < size.x * chunk_size.x - 1 || allowsExit(MapDirection::East)) &&
+		          (s->position.y < size.y * chunk_size.y - 1 || allowsExit(MapDirection::South));
+		if (canExit)
+		{
+			Vec3<int> exitLocX = s->position;
+			Vec3<int> exitLocY = s->position;
+			bool exitFarSideX = false;
+			bool exitFarSideY = false;
+			if (exitLocX.y == 0 || exitLocX.y == size.y * chunk_size.y - 1)
+			{
+				exitFarSideX = exitLocX.y != 0;
+				exitLocX.y = 0;
+				exitLocX.x = exitLocX.x % chunk_size.x;
+			}
+			if (exitLocY.x == 0 || exitLocY.x == size.x * chunk_size.x - 1)
+			{
+				exitFarSideY = exitLocY.x != 0;
+				exitLocY.x = 0;
+				exitLocY.y = exitLocY.y % chunk_size.y;
+			}
+			if (exitsX.find(exitLocX) != exitsX.end())
+				s->type = exit_grounds[exitFarSideX ? 2 : 0];
+			else if (exitsY.find(exitLocY) != exitsY.end())
+				s->type = exit_grounds[exitFarSideY ? 1 : 3];
+			else
+				s->type = pair.second;
+		}
+
+		// Set spawnability and height
+		if (s->type->movement_cost == 255 || s->type->height == 39 ||
+		    b.spawnMap[initialPosition.x][initialPosition.y][initialPosition.z] == -1)
+		{
+			b.spawnMap[initialPosition.x][initialPosition.y][initialPosition.z] = -1;
+		}
+		else
+		{
+			b.spawnMap[initialPosition.x][initialPosition.y][initialPosition.z] =
+			    std::max(b.spawnMap[initialPosition.x][initialPosition.y][initialPosition.z],
+			             s->type->height);
+		}
+
+		mapParts.push_back(s);
+	}
+	for (auto &pair : tiles.initial_left_walls)
+	{
+		auto s = mksp<BattleMapPart>();
+
+		auto initialPosition = pair.first + shift;
+		s->position = initialPosition;
+		s->queueCollapse();
+		s->position += Vec3<float>(0.5f, 0.5f, 0.0f);
+		s->type = pair.second;
+
+		if (s->type->door)
+		{
+			doors[0].emplace_back(initialPosition, s);
+		}
+
+		mapParts.push_back(s);
+	}
+	for (auto &pair : tiles.initial_right_walls)
+	{
+		auto s = mksp<BattleMapPart>();
+
+		auto initialPosition = pair.first + shift;
+		s->position = initialPosition;
+		s->queueCollapse();
+		s->position += Vec3<float>(0.5f, 0.5f, 0.0f);
+		s->type = pair.second;
+
+		if (s->type->door)
+		{
+			doors[1].emplace_back(initialPosition, s);
+		}
+
+		mapParts.push_back(s);
+	}
+	for (auto &pair : tiles.initial_features)
+	{
+		auto s = mksp<BattleMapPart>();
+
+		auto initialPosition = pair.first + shift;
+		s->position = initialPosition;
+		s->queueCollapse();
+		s->position += Vec3<float>(0.5f, 0.5f, 0.0f);
+		s->type = pair.second;
+
+		// Set spawnability and height
+		if (s->type->movement_cost == 255 || s->type->height == 39 ||
+		    b.spawnMap[initialPosition.x][initialPosition.y][initialPosition.z] == -1)
+		{
+			b.spawnMap[initialPosition.x][initialPosition.y][initialPosition.z] = -1;
+		}
+		else
+		{
+			b.spawnMap[initialPosition.x][initialPosition.y][initialPosition.z] =
+			    std::max(b.spawnMap[initialPosition.x][initialPosition.y][initialPosition.z],
+			             s->type->height);
+		}
+
+		mapParts.push_back(s);
+	}
+}
+
 sp<Battle>
 BattleMap::fillMap(std::vector<std::list<std::pair<Vec3<int>, sp<BattleMapPart>>>> &doors,
                    bool &spawnCivilians, std::vector<sp<BattleMapSector>> sec_map, Vec3<int> size,
@@ -780,152 +911,76 @@ BattleMap::fillMap(std::vector<std::list<std::pair<Vec3<int>, sp<BattleMapPart>>
 	b->player_craft = player_craft;
 	b->loadResources(state);
 
+	// Load the tiles for every sector used in parallel. The same sector can fill several chunks of
+	// the map, so only load each one once
+	std::set<sp<BattleMapSector>> sectorsToLoad;
+	std::vector<std::function<void()>> loads;
+	for (auto &sec : sec_map)
+	{
+		if (!sec || !sectorsToLoad.insert(sec).second)
+			continue;
+		if (sec->tiles)
+		{
+			LogInfo("Using already-loaded sector tiles \"%s\"", sec->sectorTilesName);
+			continue;
+		}
+		sec->tiles.reset(new BattleMapSectorTiles());
+		loads.push_back([&state, sec]() {
+			LogInfo("Loading sector tiles \"%s\"", sec->sectorTilesName);
+			if (!sec->tiles->loadSector(state, BattleMapSectorTiles::getMapSectorPath() + "/" +
+			                                       sec->sectorTilesName))
+			{
+				LogError("Failed to load sector tiles \"%s\"", sec->sectorTilesName);
+			}
+		});
+	}
+	fw().data->prefetch(std::move(loads))->wait();
+
+	// Then create the map parts for each chunk in parallel. Each chunk's parts are kept apart and
+	// added to the battle in chunk order below, so the result is the same as filling them in turn
+	std::vector<std::list<sp<BattleMapPart>>> chunkMapParts(sec_map.size());
+	std::vector<std::vector<std::list<std::pair<Vec3<int>, sp<BattleMapPart>>>>> chunkDoors(
+	    sec_map.size(), std::vector<std::list<std::pair<Vec3<int>, sp<BattleMapPart>>>>(2));
+	std::vector<std::function<void()>> fills;
 	for (int x = 0; x < size.x; x++)
 	{
 		for (int y = 0; y < size.y; y++)
 		{
 			for (int z = 0; z < size.z; z++)
 			{
-				auto sec = sec_map[x + y * size.x + z * size.x * size.y];
+				int index = x + y * size.x + z * size.x * size.y;
+				auto sec = sec_map[index];
 				if (!sec)
 					continue;
-				if (!sec->tiles)
-				{
-					LogInfo("Loading sector tiles \"%s\"", sec->sectorTilesName);
-					sec->tiles.reset(new BattleMapSectorTiles());
-					if (!sec->tiles->loadSector(state, BattleMapSectorTiles::getMapSectorPath() +
-					                                       "/" + sec->sectorTilesName))
-					{
-						LogError("Failed to load sector tiles \"%s\"", sec->sectorTilesName);
-					}
-				}
-				else
-				{
-					LogInfo("Using already-loaded sector tiles \"%s\"", sec->sectorTilesName);
-				}
-				auto &tiles = *sec->tiles;
 				Vec3<int> shift = {x * chunk_size.x, y * chunk_size.y, z * chunk_size.z};
+				auto battle = b.get();
+				auto &mapParts = chunkMapParts[index];
+				auto &doorParts = chunkDoors[index];
+				fills.push_back([this, battle, sec, shift, size, &mapParts, &doorParts]() {
+					this->fillSector(*battle, *sec->tiles, shift, size, mapParts, doorParts);
+				});
+			}
+		}
+	}
+	fw().data->prefetch(std::move(fills))->wait();
 
-				for (auto &pair : tiles.initial_grounds)
-				{
-					auto s = mksp<BattleMapPart>();
-
-					auto initialPosition = pair.first + shift;
-					s->position = initialPosition;
-					s->queueCollapse();
-					s->position += Vec3<float>(0.5f, 0.5f, 0.0f);
-
-					// Check wether this is an exit location, and if so,
-					// replace the ground map part with an appropriate exit
-					bool canExit =
-					    s->position.z >= exit_level_min && s->position.z <= exit_level_max;
-					canExit = canExit && (s->position.x > 0 || allow_exit[MapDirection::West]) &&
-					          (s->position.y > 0 || allow_exit[MapDirection::North]) &&
-					          (s->position.x < size.x * chunk_size.x - 1 ||
-					           allow_exit[MapDirection::East]) &&
-					          (s->position.y < size.y * chunk_size.y - 1 ||
-					           allow_exit[MapDirection::South]);
-					if (canExit)
-					{
-						Vec3<int> exitLocX = s->position;
-						Vec3<int> exitLocY = s->position;
-						bool exitFarSideX = false;
-						bool exitFarSideY = false;
-						if (exitLocX.y == 0 || exitLocX.y == size.y * chunk_size.y - 1)
-						{
-							exitFarSideX = exitLocX.y != 0;
-							exitLocX.y = 0;
-							exitLocX.x = exitLocX.x % chunk_size.x;
-						}
-						if (exitLocY.x == 0 || exitLocY.x == size.x * chunk_size.x - 1)
-						{
-							exitFarSideY = exitLocY.x != 0;
-							exitLocY.x = 0;
-							exitLocY.y = exitLocY.y % chunk_size.y;
-						}
-						if (exitsX.find(exitLocX) != exitsX.end())
-							s->type = exit_grounds[exitFarSideX ? 2 : 0];
-						else if (exitsY.find(exitLocY) != exitsY.end())
-							s->type = exit_grounds[exitFarSideY ? 1 : 3];
-						else
-							s->type = pair.second;
-					}
-
-					// Set spawnability and height
-					if (s->type->movement_cost == 255 || s->type->height == 39 ||
-					    b->spawnMap[initialPosition.x][initialPosition.y][initialPosition.z] == -1)
-					{
-						b->spawnMap[initialPosition.x][initialPosition.y][initialPosition.z] = -1;
-					}
-					else
-					{
-						b->spawnMap[initialPosition.x][initialPosition.y][initialPosition.z] =
-						    std::max(b->spawnMap[initialPosition.x][initialPosition.y]
-						                        [initialPosition.z],
-						             s->type->height);
-					}
-
-					b->map_parts.push_back(s);
-				}
-				for (auto &pair : tiles.initial_left_walls)
-				{
-					auto s = mksp<BattleMapPart>();
-
-					auto initialPosition = pair.first + shift;
-					s->position = initialPosition;
-					s->queueCollapse();
-					s->position += Vec3<float>(0.5f, 0.5f, 0.0f);
-					s->type = pair.second;
-
-					if (pair.second->door)
-					{
-						doors[0].emplace_back(initialPosition, s);
-					}
-
-					b->map_parts.push_back(s);
-				}
-				for (auto &pair : tiles.initial_right_walls)
-				{
-					auto s = mksp<BattleMapPart>();
-
-					auto initialPosition = pair.first + shift;
-					s->position = initialPosition;
-					s->queueCollapse();
-					s->position += Vec3<float>(0.5f, 0.5f, 0.0f);
-					s->type = pair.second;
-
-					if (pair.second->door)
-					{
-						doors[1].emplace_back(initialPosition, s);
-					}
+	for (int x = 0; x < size.x; x++)
+	{
+		for (int y = 0; y < size.y; y++)
+		{
+			for (int z = 0; z < size.z; z++)
+			{
+				int index = x + y * size.x + z * size.x * size.y;
+				auto sec = sec_map[index];
+				if (!sec)
+					continue;
+				auto &tiles = *sec->tiles;
+				Vec3<int> shift = {x * chunk_size.x, y * chunk_size.y, z * chunk_size.z};
 
-					b->map_parts.push_back(s);
-				}
-				for (auto &pair : tiles.initial_features)
+				b->map_parts.splice(b->map_parts.end(), chunkMapParts[index]);
+				for (int i = 0; i < 2; i++)
 				{
-					auto s = mksp<BattleMapPart>();
-
-					auto initialPosition = pair.first + shift;
-					s->position = initialPosition;
-					s->queueCollapse();
-					s->position += Vec3<float>(0.5f, 0.5f, 0.0f);
-					s->type = pair.second;
-
-					// Set spawnability and height
-					if (s->type->movement_cost == 255 || s->type->height == 39 ||
-					    b->spawnMap[initialPosition.x][initialPosition.y][initialPosition.z] == -1)
-					{
-						b->spawnMap[initialPosition.x][initialPosition.y][initialPosition.z] = -1;
-					}
-					else
-					{
-						b->spawnMap[initialPosition.x][initialPosition.y][initialPosition.z] =
-						    std::max(b->spawnMap[initialPosition.x][initialPosition.y]
-						                        [initialPosition.z],
-						             s->type->height);
-					}
-
-					b->map_parts.push_back(s);
+					doors[i].splice(doors[i].end(), chunkDoors[index][i]);
 				}
 				for (auto &pair : tiles.loot_locations)
 				{
@@ -1210,7 +1265,8 @@ sp<Battle> BattleMap::createBattle(GameState &state, StateRef<Organisation> targ
 	return b;
 }
 
-void BattleMap::loadTilesets(GameState &state) const
+void BattleMap::loadTilesets(
+    GameState &state, const std::map<UString, sp<BattleMapTileset>> &prefetchedTilesets) const
 {
 	if (state.battleMapTiles.size() > 0)
 	{
@@ -1218,18 +1274,43 @@ void BattleMap::loadTilesets(GameState &state) const
 		return;
 	}
 
-	// Load all tilesets used by the map
+	// Parse all tilesets used by the map in parallel, then merge them in order so the result
+	// doesn't depend on which finished first
+	std::vector<sp<BattleMapTileset>> loadedTilesets;
+	std::vector<std::function<void()>> loads;
 	for (auto &tilesetName : this->tilesets)
 	{
-		unsigned count = 0;
+		auto prefetched = prefetchedTilesets.find(tilesetName);
+		if (prefetched != prefetchedTilesets.end())
+		{
+			// Already reported by the prefetch if it failed
+			loadedTilesets.push_back(prefetched->second);
+			continue;
+		}
 		auto tilesetPath = BattleMapTileset::getTilesetPath() + "/" + tilesetName;
-		LogInfo("Loading tileset \"%s\" from \"%s\"", tilesetName, tilesetPath);
-		BattleMapTileset tileset;
-		if (!tileset.loadTileset(state, tilesetPath))
+		loadedTilesets.push_back(mksp<BattleMapTileset>());
+		auto tileset = loadedTilesets.back();
+		loads.push_back([&state, tileset, tilesetName, tilesetPath]() {
+			LogInfo("Loading tileset \"%s\" from \"%s\"", tilesetName, tilesetPath);
+			if (!tileset->loadTileset(state, tilesetPath))
+			{
+				LogError("Failed to load tileset \"%s\" from \"%s\"", tilesetName, tilesetPath);
+				tileset->map_part_types.clear();
+			}
+		});
+	}
+	fw().data->prefetch(std::move(loads))->wait();
+
+	auto loadedTileset = loadedTilesets.begin();
+	for (auto &tilesetName : this->tilesets)
+	{
+		auto loaded = *loadedTileset++;
+		if (!loaded)
 		{
-			LogError("Failed to load tileset \"%s\" from \"%s\"", tilesetName, tilesetPath);
 			continue;
 		}
+		auto &tileset = *loaded;
+		unsigned count = 0;
 
 		for (auto &tilePair : tileset.map_part_types)
 		{
@@ -17,7 +17,9 @@ class Agent;
 class Organisation;
 class Vehicle;
 class BattleMapPartType;
+class BattleMapTileset;
 class BattleMapSector;
+class BattleMapSectorTiles;
 
 class BattleMap : public StateObject
 {
@@ -75,6 +77,14 @@ class BattleMap : public StateObject
 	                   std::list<StateRef<Agent>> &agents, StateRef<Vehicle> player_craft,
 	                   Battle::MissionType mission_type, UString mission_location_id);
 
+	// Creates the map parts for one chunk of the map from its sector's tiles. Chunks never
+	// overlap, so several can be filled at once
+	void fillSector(Battle &b, const BattleMapSectorTiles &tiles, Vec3<int> shift, Vec3<int> size,
+	                std::list<sp<BattleMapPart>> &mapParts,
+	                std::vector<std::list<std::pair<Vec3<int>, sp<BattleMapPart>>>> &doors) const;
+	// Unlike allow_exit[], doesn't add missing directions, so is safe to call from several threads
+	bool allowsExit(MapDirection direction) const;
+
 	void linkDoors(sp<Battle> b,
 	               std::vector<std::list<std::pair<Vec3<int>, sp<BattleMapPart>>>> doors,
 	               GameState &state);
@@ -86,7 +96,11 @@ class BattleMap : public StateObject
 
 	void unloadTiles();
 
-	void loadTilesets(GameState &state) const;
+	// Tilesets in 'prefetchedTilesets' have already been loaded (a null one failed), the rest are
+	// loaded here
+	void loadTilesets(
+	    GameState &state,
+	    const std::map<UString, sp<BattleMapTileset>> &prefetchedTilesets = {}) const;
 	static void unloadTilesets(GameState &state);
 
 	friend class Battle;
@@ -102,7 +102,7 @@ void BattleMapPart::die(GameState &state, bool explosive, bool violently)
 	// Cease functioning
 	ceaseBeingSupported();
 	ceaseDoorFunction();
-	ceaseSupportProvision();
+	ceaseSupportProvision(state);
 
 	// Re-establish support for this if still alive
 	if (isAlive())
@@ -118,6 +118,11 @@ void BattleMapPart::die(GameState &state, bool explosive, bool violently)
 		this->tileObject->removeFromMap();
 		this->tileObject.reset();
 	}
+	// May be collapsing now, or changed to an animated type
+	if (this->tileObject)
+	{
+		state.current_battle->activateMapPart(shared_from_this());
+	}
 }
 
 int BattleMapPart::getMaxFrames()
@@ -1007,10 +1012,10 @@ void BattleMapPart::ceaseBeingSupported()
 	}
 }
 
-void BattleMapPart::ceaseSupportProvision()
+void BattleMapPart::ceaseSupportProvision(GameState &state)
 {
 	providesHardSupport = false;
-	attemptReLinkSupports(getSupportedParts());
+	attemptReLinkSupports(state, getSupportedParts());
 	supportedParts.clear();
 	if (supportedItems)
 	{
@@ -1018,14 +1023,16 @@ void BattleMapPart::ceaseSupportProvision()
 		{
 			if (obj->getType() == TileObject::Type::Item)
 			{
-				std::static_pointer_cast<TileObjectBattleItem>(obj)->getItem()->tryCollapse();
+				auto item = std::static_pointer_cast<TileObjectBattleItem>(obj)->getItem();
+				item->tryCollapse();
+				state.current_battle->activateItem(item);
 			}
 		}
 		supportedItems = false;
 	}
 }
 
-void BattleMapPart::attemptReLinkSupports(sp<std::set<BattleMapPart *>> set)
+void BattleMapPart::attemptReLinkSupports(GameState &state, sp<std::set<BattleMapPart *>> set)
 {
 	if (set->empty())
 	{
@@ -1039,6 +1046,7 @@ void BattleMapPart::attemptReLinkSupports(sp<std::set<BattleMapPart *>> set)
 	{
 		mp->queueCollapse();
 		mp->ceaseBeingSupported();
+		state.current_battle->activateMapPart(mp->shared_from_this());
 	}
 
 	// Then try to re-establish support links
@@ -1066,6 +1074,7 @@ void BattleMapPart::attemptReLinkSupports(sp<std::set<BattleMapPart *>> set)
 			for (auto newmp : *supportedByThisMp)
 			{
 				newmp->queueCollapse(mp->ticksUntilCollapse);
+				state.current_battle->activateMapPart(newmp->shared_from_this());
 			}
 			auto pos = mp->tileObject->getOwningTile()->position;
 			// Try to find support without those that depended on us
@@ -1172,8 +1181,9 @@ void BattleMapPart::collapse(GameState &state)
 		// If we would somehow call collapse() in a way that would set falling to true but
 		// would not trigger the setPosition() afterwards, this logic would fail
 	}
-	ceaseSupportProvision();
+	ceaseSupportProvision(state);
 	ceaseDoorFunction();
+	state.current_battle->activateMapPart(shared_from_this());
 }
 
 void BattleMapPart::update(GameState &state, unsigned int ticks)
@@ -1281,6 +1291,7 @@ void BattleMapPart::update(GameState &state, unsigned int ticks)
 						rubble->type = type->rubble.front();
 						state.current_battle->map_parts.push_back(rubble);
 						state.current_battle->map->addObjectToMap(rubble);
+						state.current_battle->activateMapPart(rubble);
 					}
 					else
 					{
@@ -1290,6 +1301,7 @@ void BattleMapPart::update(GameState &state, unsigned int ticks)
 						{
 							rubble->type = *it;
 							rubble->setPosition(state, rubble->position);
+							state.current_battle->activateMapPart(rubble);
 						}
 					}
 				}
@@ -1324,6 +1336,13 @@ void BattleMapPart::setPosition(GameState &state, const Vec3<float> &pos)
 	this->tileObject->setPosition(pos);
 }
 
+bool BattleMapPart::needsUpdate() const
+{
+	if (!tileObject)
+		return false;
+	return falling || ticksUntilCollapse > 0 || (!door && type->animation_frames.size() > 0);
+}
+
 bool BattleMapPart::isAlive() const
 {
 	if (falling || destroyed || willCollapse())
@@ -62,11 +62,14 @@ class BattleMapPart : public std::enable_shared_from_this<BattleMapPart>
 	bool willCollapse() const { return ticksUntilCollapse > 0; }
 
 	sp<std::set<BattleMapPart *>> getSupportedParts();
-	static void attemptReLinkSupports(sp<std::set<BattleMapPart *>> set);
+	static void attemptReLinkSupports(GameState &state, sp<std::set<BattleMapPart *>> set);
 
 	void ceaseDoorFunction();
 
 	void update(GameState &state, unsigned int ticks);
+	// Wether update() has anything to do (falling, collapsing or animating). Map parts that don't
+	// are left out of the battle's updates until something activates them again
+	bool needsUpdate() const;
 
 	bool isAlive() const;
 
@@ -75,6 +78,8 @@ class BattleMapPart : public std::enable_shared_from_this<BattleMapPart>
 	// Following members are not serialized, but rather are set in initBattle method
 
 	sp<TileObjectBattleMapPart> tileObject;
+	// Wether this is in the battle's list of active map parts
+	bool active = false;
 
   private:
 	friend class Battle;
@@ -86,7 +91,7 @@ class BattleMapPart : public std::enable_shared_from_this<BattleMapPart>
 	bool attachToSomething(bool checkType, bool checkHard);
 
 	// Cease providing or requiring support
-	void ceaseSupportProvision();
+	void ceaseSupportProvision(GameState &state);
 
 	// Cease using support
 	void ceaseBeingSupported();
@@ -108,25 +108,26 @@ bool BattleUnitTileHelper::canEnterTile(Tile *from, Tile *to, bool ignoreStaticU
 	return canEnterTile(from, to, nothing, none, ignoreStaticUnits, ignoreAllUnits);
 }
 
-bool BattleUnitTileHelper::canEnterTile(Tile *from, Tile *to, float &cost, bool &doorInTheWay,
-                                        bool ignoreStaticUnits, bool ignoreAllUnits) const
+bool BattleUnitTileHelper::canEnterTile(Tile *fromTile, Tile *toTile, float &cost,
+                                        bool &doorInTheWay, bool ignoreStaticUnits,
+                                        bool ignoreAllUnits) const
 {
 	int costInt = 0;
 	doorInTheWay = false;
 
 	// Error checks
-	if (!from)
+	if (!fromTile)
 	{
 		LogError("No 'from' position supplied");
 		return false;
 	}
-	Vec3<int> fromPos = from->position;
-	if (!to)
+	Vec3<int> fromPos = fromTile->position;
+	if (!toTile)
 	{
 		LogError("No 'to' position supplied");
 		return false;
 	}
-	Vec3<int> toPos = to->position;
+	Vec3<int> toPos = toTile->position;
 	if (fromPos == toPos)
 	{
 		LogError("FromPos == ToPos %s", toPos);
@@ -143,27 +144,38 @@ bool BattleUnitTileHelper::canEnterTile(Tile *from, Tile *to, float &cost, bool
 		return false;
 	}
 
+	// From here on only the nav grid is read, tiles are referred to by their index in it
+	auto &nav = map.navGrid;
+	int from = nav.getIndex(fromPos);
+	int to = nav.getIndex(toPos);
+	// The nav grid only knows if there's any unit in the tile, so check the unit itself if so
+	auto staticUnitPresent = [&](int index) {
+		return nav.getUnitPresent(index) &&
+		       map.getTile(nav.getPosition(index))
+		           ->getUnitIfPresent(true, true, true, tileObject, ignoreStaticUnits);
+	};
+
 	// Tiles used by big units
-	Tile *fromX1 = nullptr;  // from (x-1, y, z)
-	Vec3<int> fromX1Pos;     // fromPos (x-1, y, z)
-	Tile *fromY1 = nullptr;  // from (x, y-1, z)
-	Vec3<int> fromY1Pos;     // fromPos (x, y-1, z)
-	Tile *fromXY1 = nullptr; // from (x-1, y-1, z)
-	Vec3<int> fromXY1Pos;    // fromPos (x-1, y-1, z)
-	Tile *toX1 = nullptr;    // to (x-1, y, z)
-	Vec3<int> toX1Pos;       // toPos (x-1, y, z)
-	Tile *toY1 = nullptr;    // to (x, y-1, z)
-	Vec3<int> toY1Pos;       // toPos (x, y-1, z)
-	Tile *toXY1 = nullptr;   // to (x-1, y-1, z)
-	Vec3<int> toXY1Pos;      // toPos (x-1, y-1, z)
-	Tile *toZ1 = nullptr;    // to (x, y, z-1)
-	Vec3<int> toZ1Pos;       // toPos (x, y, z-1)
-	Tile *toXZ1 = nullptr;   // to (x-1, y, z-1)
-	Vec3<int> toXZ1Pos;      // toPos (x-1, y, z-1)
-	Tile *toYZ1 = nullptr;   // to (x, y-1, z-1)
-	Vec3<int> toYZ1Pos;      // toPos (x, y-1, z-1)
-	Tile *toXYZ1 = nullptr;  // to (x-1, y-1, z-1)
-	Vec3<int> toXYZ1Pos;     // toPos (x-1, y-1, z-1)
+	int fromX1 = -1;      // from (x-1, y, z)
+	Vec3<int> fromX1Pos;  // fromPos (x-1, y, z)
+	int fromY1 = -1;      // from (x, y-1, z)
+	Vec3<int> fromY1Pos;  // fromPos (x, y-1, z)
+	int fromXY1 = -1;     // from (x-1, y-1, z)
+	Vec3<int> fromXY1Pos; // fromPos (x-1, y-1, z)
+	int toX1 = -1;        // to (x-1, y, z)
+	Vec3<int> toX1Pos;    // toPos (x-1, y, z)
+	int toY1 = -1;        // to (x, y-1, z)
+	Vec3<int> toY1Pos;    // toPos (x, y-1, z)
+	int toXY1 = -1;       // to (x-1, y-1, z)
+	Vec3<int> toXY1Pos;   // toPos (x-1, y-1, z)
+	int toZ1 = -1;        // to (x, y, z-1)
+	Vec3<int> toZ1Pos;    // toPos (x, y, z-1)
+	int toXZ1 = -1;       // to (x-1, y, z-1)
+	Vec3<int> toXZ1Pos;   // toPos (x-1, y, z-1)
+	int toYZ1 = -1;       // to (x, y-1, z-1)
+	Vec3<int> toYZ1Pos;   // toPos (x, y-1, z-1)
+	int toXYZ1 = -1;      // to (x-1, y-1, z-1)
+	Vec3<int> toXYZ1Pos;  // toPos (x-1, y-1, z-1)
 
 	// STEP 01: Check if "to" is passable
 	// We could just use Tile::getPassable, however, we need to make some extra calculations
@@ -180,30 +192,31 @@ bool BattleUnitTileHelper::canEnterTile(Tile *from, Tile *to, float &cost, bool
 			return false;
 		}
 		// Get tiles
-		fromX1 = map.getTile(Vec3<int>{fromPos.x - 1, fromPos.y, fromPos.z});
-		fromX1Pos = fromX1->position;
-		fromY1 = map.getTile(Vec3<int>{fromPos.x, fromPos.y - 1, fromPos.z});
-		fromY1Pos = fromY1->position;
-		fromXY1 = map.getTile(Vec3<int>{fromPos.x - 1, fromPos.y - 1, fromPos.z});
-		fromXY1Pos = fromXY1->position;
-
-		toX1 = map.getTile(Vec3<int>{toPos.x - 1, toPos.y, toPos.z});
-		toX1Pos = toX1->position;
-		toY1 = map.getTile(Vec3<int>{toPos.x, toPos.y - 1, toPos.z});
-		toY1Pos = toY1->position;
-		toXY1 = map.getTile(Vec3<int>{toPos.x - 1, toPos.y - 1, toPos.z});
-		toXY1Pos = toXY1->position;
-		toZ1 = map.getTile(Vec3<int>{toPos.x, toPos.y, toPos.z + 1});
-		toZ1Pos = toZ1->position;
-		toXZ1 = map.getTile(Vec3<int>{toPos.x - 1, toPos.y, toPos.z + 1});
-		toXZ1Pos = toXZ1->position;
-		toYZ1 = map.getTile(Vec3<int>{toPos.x, toPos.y - 1, toPos.z + 1});
-		toYZ1Pos = toYZ1->position;
-		toXYZ1 = map.getTile(Vec3<int>{toPos.x - 1, toPos.y - 1, toPos.z + 1});
-		toXYZ1Pos = toXYZ1->position;
+		fromX1Pos = Vec3<int>{fromPos.x - 1, fromPos.y, fromPos.z};
+		fromX1 = nav.getIndex(fromX1Pos);
+		fromY1Pos = Vec3<int>{fromPos.x, fromPos.y - 1, fromPos.z};
+		fromY1 = nav.getIndex(fromY1Pos);
+		fromXY1Pos = Vec3<int>{fromPos.x - 1, fromPos.y - 1, fromPos.z};
+		fromXY1 = nav.getIndex(fromXY1Pos);
+
+		toX1Pos = Vec3<int>{toPos.x - 1, toPos.y, toPos.z};
+		toX1 = nav.getIndex(toX1Pos);
+		toY1Pos = Vec3<int>{toPos.x, toPos.y - 1, toPos.z};
+		toY1 = nav.getIndex(toY1Pos);
+		toXY1Pos = Vec3<int>{toPos.x - 1, toPos.y - 1, toPos.z};
+		toXY1 = nav.getIndex(toXY1Pos);
+		toZ1Pos = Vec3<int>{toPos.x, toPos.y, toPos.z + 1};
+		toZ1 = nav.getIndex(toZ1Pos);
+		toXZ1Pos = Vec3<int>{toPos.x - 1, toPos.y, toPos.z + 1};
+		toXZ1 = nav.getIndex(toXZ1Pos);
+		toYZ1Pos = Vec3<int>{toPos.x, toPos.y - 1, toPos.z + 1};
+		toYZ1 = nav.getIndex(toYZ1Pos);
+		toXYZ1Pos = Vec3<int>{toPos.x - 1, toPos.y - 1, toPos.z + 1};
+		toXYZ1 = nav.getIndex(toXYZ1Pos);
 
 		// Check if we can place our head there
-		if (toZ1->solidGround || toXZ1->solidGround || toYZ1->solidGround || toXYZ1->solidGround)
+		if (nav.getSolidGround(toZ1) || nav.getSolidGround(toXZ1) || nav.getSolidGround(toYZ1) ||
+		    nav.getSolidGround(toXYZ1))
 		{
 			return false;
 		}
@@ -214,59 +227,58 @@ bool BattleUnitTileHelper::canEnterTile(Tile *from, Tile *to, float &cost, bool
 			// static units,
 			// because they don't know how to give way, and therefore are considered permanent
 			// obstacles
-			if (to->getUnitIfPresent(true, true, true, tileObject, ignoreStaticUnits))
+			if (staticUnitPresent(to))
 				return false;
-			if (toX1->getUnitIfPresent(true, true, true, tileObject, ignoreStaticUnits))
+			if (staticUnitPresent(toX1))
 				return false;
-			if (toY1->getUnitIfPresent(true, true, true, tileObject, ignoreStaticUnits))
+			if (staticUnitPresent(toY1))
 				return false;
-			if (toXY1->getUnitIfPresent(true, true, true, tileObject, ignoreStaticUnits))
+			if (staticUnitPresent(toXY1))
 				return false;
-			if (toZ1->getUnitIfPresent(true, true, true, tileObject, ignoreStaticUnits))
+			if (staticUnitPresent(toZ1))
 				return false;
-			if (toXZ1->getUnitIfPresent(true, true, true, tileObject, ignoreStaticUnits))
+			if (staticUnitPresent(toXZ1))
 				return false;
-			if (toYZ1->getUnitIfPresent(true, true, true, tileObject, ignoreStaticUnits))
+			if (staticUnitPresent(toYZ1))
 				return false;
-			if (toXYZ1->getUnitIfPresent(true, true, true, tileObject, ignoreStaticUnits))
+			if (staticUnitPresent(toXYZ1))
 				return false;
 		}
 		// Movement cost into the tiles
-		costInt = to->movementCostIn;
-		costInt = std::max(costInt, toX1->movementCostIn);
-		costInt = std::max(costInt, toY1->movementCostIn);
-		costInt = std::max(costInt, toXY1->movementCostIn);
-		costInt = std::max(costInt, toZ1->movementCostIn);
-		costInt = std::max(costInt, toXZ1->movementCostIn);
-		costInt = std::max(costInt, toYZ1->movementCostIn);
-		costInt = std::max(costInt, toXYZ1->movementCostIn);
+		costInt = nav.getMovementCostIn(to);
+		costInt = std::max(costInt, nav.getMovementCostIn(toX1));
+		costInt = std::max(costInt, nav.getMovementCostIn(toY1));
+		costInt = std::max(costInt, nav.getMovementCostIn(toXY1));
+		costInt = std::max(costInt, nav.getMovementCostIn(toZ1));
+		costInt = std::max(costInt, nav.getMovementCostIn(toXZ1));
+		costInt = std::max(costInt, nav.getMovementCostIn(toYZ1));
+		costInt = std::max(costInt, nav.getMovementCostIn(toXYZ1));
 		// Movement cost into the walls of the tiles
-		costInt = std::max(costInt, to->movementCostLeft);
-		costInt = std::max(costInt, toX1->movementCostRight);
-		costInt = std::max(costInt, toY1->movementCostLeft);
-		costInt = std::max(costInt, toZ1->movementCostLeft);
-		costInt = std::max(costInt, toZ1->movementCostRight);
-		costInt = std::max(costInt, toXZ1->movementCostRight);
-		costInt = std::max(costInt, toYZ1->movementCostLeft);
+		costInt = std::max(costInt, nav.getMovementCostLeft(to));
+		costInt = std::max(costInt, nav.getMovementCostRight(toX1));
+		costInt = std::max(costInt, nav.getMovementCostLeft(toY1));
+		costInt = std::max(costInt, nav.getMovementCostLeft(toZ1));
+		costInt = std::max(costInt, nav.getMovementCostRight(toZ1));
+		costInt = std::max(costInt, nav.getMovementCostRight(toXZ1));
+		costInt = std::max(costInt, nav.getMovementCostLeft(toYZ1));
 		// Check for doors
-		doorInTheWay = doorInTheWay || to->closedDoorLeft;
-		doorInTheWay = doorInTheWay || to->closedDoorRight;
-		doorInTheWay = doorInTheWay || toX1->closedDoorRight;
-		doorInTheWay = doorInTheWay || toY1->closedDoorLeft;
-		doorInTheWay = doorInTheWay || toZ1->closedDoorLeft;
-		doorInTheWay = doorInTheWay || toZ1->closedDoorRight;
-		doorInTheWay = doorInTheWay || toXZ1->closedDoorRight;
-		doorInTheWay = doorInTheWay || toYZ1->closedDoorLeft;
+		doorInTheWay = doorInTheWay || nav.getClosedDoorLeft(to);
+		doorInTheWay = doorInTheWay || nav.getClosedDoorRight(to);
+		doorInTheWay = doorInTheWay || nav.getClosedDoorRight(toX1);
+		doorInTheWay = doorInTheWay || nav.getClosedDoorLeft(toY1);
+		doorInTheWay = doorInTheWay || nav.getClosedDoorLeft(toZ1);
+		doorInTheWay = doorInTheWay || nav.getClosedDoorRight(toZ1);
+		doorInTheWay = doorInTheWay || nav.getClosedDoorRight(toXZ1);
+		doorInTheWay = doorInTheWay || nav.getClosedDoorLeft(toYZ1);
 	}
 	// STEP 01: Check if "to" is passable (small)
 	else
 	{
 		// Check that no static unit occupies this tile
-		if (!ignoreAllUnits &&
-		    to->getUnitIfPresent(true, true, true, tileObject, ignoreStaticUnits))
+		if (!ignoreAllUnits && staticUnitPresent(to))
 			return false;
 		// Movement cost into the tiles
-		costInt = to->movementCostIn;
+		costInt = nav.getMovementCostIn(to);
 	}
 	// STEP 01: Failure condition
 	if (costInt == 255)
@@ -279,12 +291,12 @@ bool BattleUnitTileHelper::canEnterTile(Tile *from, Tile *to, float &cost, bool
 	// Disabling it will allow paths with falling
 	if (!flying)
 	{
-		bool canStand = to->canStand;
+		bool canStand = nav.getCanStand(to);
 		if (large)
 		{
-			canStand = canStand || toX1->canStand;
-			canStand = canStand || toY1->canStand;
-			canStand = canStand || toXY1->canStand;
+			canStand = canStand || nav.getCanStand(toX1);
+			canStand = canStand || nav.getCanStand(toY1);
+			canStand = canStand || nav.getCanStand(toXY1);
 		}
 		if (!canStand)
 			return false;
@@ -298,12 +310,12 @@ bool BattleUnitTileHelper::canEnterTile(Tile *from, Tile *to, float &cost, bool
 	// this will never happen (except when giving orders to a falling unit)
 	if (!flying)
 	{
-		bool canStand = from->canStand;
+		bool canStand = nav.getCanStand(from);
 		if (large)
 		{
-			canStand = canStand || fromX1->canStand;
-			canStand = canStand || fromY1->canStand;
-			canStand = canStand || fromXY1->canStand;
+			canStand = canStand || nav.getCanStand(fromX1);
+			canStand = canStand || nav.getCanStand(fromY1);
+			canStand = canStand || nav.getCanStand(fromXY1);
 		}
 		if (!canStand)
 		{
@@ -324,12 +336,12 @@ bool BattleUnitTileHelper::canEnterTile(Tile *from, Tile *to, float &cost, bool
 			bool fromHasLift = false;
 			if (large)
 			{
-				fromHasLift =
-				    from->hasLift || fromX1->hasLift || fromY1->hasLift || fromXY1->hasLift;
+				fromHasLift = nav.getHasLift(from) || nav.getHasLift(fromX1) ||
+				              nav.getHasLift(fromY1) || nav.getHasLift(fromXY1);
 			}
 			else
 			{
-				fromHasLift = from->hasLift;
+				fromHasLift = nav.getHasLift(from);
 			}
 			if (fromHasLift)
 			{
@@ -356,16 +368,20 @@ bool BattleUnitTileHelper::canEnterTile(Tile *from, Tile *to, float &cost, bool
 		bool toHasLift = false;
 		if (large)
 		{
-			fromHeightSatisfactory = from->height >= 0.675f || fromX1->height >= 0.675f ||
-			                         fromY1->height >= 0.675f || fromXY1->height >= 0.675f;
-			fromHasLift = from->hasLift || fromX1->hasLift || fromY1->hasLift || fromXY1->hasLift;
-			toHasLift = to->hasLift || toX1->hasLift || toY1->hasLift || toXY1->hasLift;
+			fromHeightSatisfactory = nav.getHeight(from) >= 0.675f ||
+			                         nav.getHeight(fromX1) >= 0.675f ||
+			                         nav.getHeight(fromY1) >= 0.675f ||
+			                         nav.getHeight(fromXY1) >= 0.675f;
+			fromHasLift = nav.getHasLift(from) || nav.getHasLift(fromX1) ||
+			              nav.getHasLift(fromY1) || nav.getHasLift(fromXY1);
+			toHasLift = nav.getHasLift(to) || nav.getHasLift(toX1) || nav.getHasLift(toY1) ||
+			            nav.getHasLift(toXY1);
 		}
 		else
 		{
-			fromHeightSatisfactory = from->height >= 0.675f;
-			fromHasLift = from->hasLift;
-			toHasLift = to->hasLift;
+			fromHeightSatisfactory = nav.getHeight(from) >= 0.675f;
+			fromHasLift = nav.getHasLift(from);
+			toHasLift = nav.getHasLift(to);
 		}
 		// Success condition: Either of:
 		// - We stand high enough and target location is not a lift
@@ -379,12 +395,12 @@ bool BattleUnitTileHelper::canEnterTile(Tile *from, Tile *to, float &cost, bool
 				return false;
 			}
 			// If flying we can only ascend if target tile is not solid ground
-			bool canStand = to->canStand;
+			bool canStand = nav.getCanStand(to);
 			if (large)
 			{
-				canStand = canStand || toX1->canStand;
-				canStand = canStand || toY1->canStand;
-				canStand = canStand || toXY1->canStand;
+				canStand = canStand || nav.getCanStand(toX1);
+				canStand = canStand || nav.getCanStand(toY1);
+				canStand = canStand || nav.getCanStand(toXY1);
 			}
 			if (canStand)
 			{
@@ -397,10 +413,10 @@ bool BattleUnitTileHelper::canEnterTile(Tile *from, Tile *to, float &cost, bool
 		{
 			// Will we bump our head when leaving current spot?
 			// Check four tiles above our "from"'s head
-			if (map.getTile(Vec3<int>{fromPos.x, fromPos.y, fromPos.z + 2})->solidGround ||
-			    map.getTile(Vec3<int>{fromX1Pos.x, fromX1Pos.y, fromX1Pos.z + 2})->solidGround ||
-			    map.getTile(Vec3<int>{fromY1Pos.x, fromY1Pos.y, fromY1Pos.z + 2})->solidGround ||
-			    map.getTile(Vec3<int>{fromXY1Pos.x, fromXY1Pos.y, fromXY1Pos.z + 2})->solidGround)
+			if (nav.getSolidGround(nav.getIndex(fromPos.x, fromPos.y, fromPos.z + 2)) ||
+			    nav.getSolidGround(nav.getIndex(fromX1Pos.x, fromX1Pos.y, fromX1Pos.z + 2)) ||
+			    nav.getSolidGround(nav.getIndex(fromY1Pos.x, fromY1Pos.y, fromY1Pos.z + 2)) ||
+			    nav.getSolidGround(nav.getIndex(fromXY1Pos.x, fromXY1Pos.y, fromXY1Pos.z + 2)))
 			{
 				return false;
 			}
@@ -409,7 +425,7 @@ bool BattleUnitTileHelper::canEnterTile(Tile *from, Tile *to, float &cost, bool
 		{
 			// Will we bump our head when leaving current spot?
 			// Check tile above our "from"'s head
-			if (map.getTile(Vec3<int>{fromPos.x, fromPos.y, fromPos.z + 1})->solidGround)
+			if (nav.getSolidGround(nav.getIndex(fromPos.x, fromPos.y, fromPos.z + 1)))
 			{
 				return false;
 			}
@@ -417,7 +433,7 @@ bool BattleUnitTileHelper::canEnterTile(Tile *from, Tile *to, float &cost, bool
 	}
 
 	// STEP 05: Check if we have enough space for our head upon arrival
-	if (!to->getHeadFits(large, maxHeight))
+	if (!nav.getHeadFits(toPos, large, maxHeight))
 		return false;
 
 	// STEP 06: Check how much it costs to pass through walls we intersect with
@@ -458,58 +474,55 @@ bool BattleUnitTileHelper::canEnterTile(Tile *from, Tile *to, float &cost, bool
 				//	  0    x 0-  -  -           0    x 0*  *  *
 				//	       x---  ----                x***  ****
 				*/
-				Tile *rightTopZ0 =
-				    map.getTile(std::max(fromPos.x, toPos.x), std::max(fromPos.y, toPos.y) - 2, z);
-				Tile *rightBottomZ0 =
-				    map.getTile(std::max(fromPos.x, toPos.x), std::max(fromPos.y, toPos.y) - 1, z);
-				Tile *bottomLeftZ0 =
-				    map.getTile(std::max(fromPos.x, toPos.x) - 2, std::max(fromPos.y, toPos.y), z);
-				Tile *bottomRightZ0 =
-				    map.getTile(std::max(fromPos.x, toPos.x) - 1, std::max(fromPos.y, toPos.y), z);
-				Tile *rightTopZ1 = map.getTile(std::max(fromPos.x, toPos.x),
-				                               std::max(fromPos.y, toPos.y) - 2, z + 1);
-				Tile *rightBottomZ1 = map.getTile(std::max(fromPos.x, toPos.x),
-				                                  std::max(fromPos.y, toPos.y) - 1, z + 1);
-				Tile *bottomLeftZ1 = map.getTile(std::max(fromPos.x, toPos.x) - 2,
+				int rightTopZ0 =
+				    nav.getIndex(std::max(fromPos.x, toPos.x), std::max(fromPos.y, toPos.y) - 2, z);
+				int rightBottomZ0 =
+				    nav.getIndex(std::max(fromPos.x, toPos.x), std::max(fromPos.y, toPos.y) - 1, z);
+				int bottomLeftZ0 =
+				    nav.getIndex(std::max(fromPos.x, toPos.x) - 2, std::max(fromPos.y, toPos.y), z);
+				int bottomRightZ0 =
+				    nav.getIndex(std::max(fromPos.x, toPos.x) - 1, std::max(fromPos.y, toPos.y), z);
+				int rightTopZ1 = nav.getIndex(std::max(fromPos.x, toPos.x),
+				                              std::max(fromPos.y, toPos.y) - 2, z + 1);
+				int rightBottomZ1 = nav.getIndex(std::max(fromPos.x, toPos.x),
+				                                 std::max(fromPos.y, toPos.y) - 1, z + 1);
+				int bottomLeftZ1 = nav.getIndex(std::max(fromPos.x, toPos.x) - 2,
+				                                std::max(fromPos.y, toPos.y), z + 1);
+				int bottomRightZ1 = nav.getIndex(std::max(fromPos.x, toPos.x) - 1,
 				                                 std::max(fromPos.y, toPos.y), z + 1);
-				Tile *bottomRightZ1 = map.getTile(std::max(fromPos.x, toPos.x) - 1,
-				                                  std::max(fromPos.y, toPos.y), z + 1);
 
 				// STEP 06: [For large units if moving: down-right or up-left / SE or NW]
 				// Find highest movement cost amongst all walls we intersect
-				costInt = std::max(costInt, rightTopZ0->movementCostLeft);
-				costInt = std::max(costInt, rightBottomZ0->movementCostRight);
-				costInt = std::max(costInt, bottomLeftZ0->movementCostRight);
-				costInt = std::max(costInt, bottomRightZ0->movementCostLeft);
-				costInt = std::max(costInt, rightTopZ1->movementCostLeft);
-				costInt = std::max(costInt, rightBottomZ1->movementCostRight);
-				costInt = std::max(costInt, bottomLeftZ1->movementCostRight);
-				costInt = std::max(costInt, bottomRightZ1->movementCostLeft);
+				costInt = std::max(costInt, nav.getMovementCostLeft(rightTopZ0));
+				costInt = std::max(costInt, nav.getMovementCostRight(rightBottomZ0));
+				costInt = std::max(costInt, nav.getMovementCostRight(bottomLeftZ0));
+				costInt = std::max(costInt, nav.getMovementCostLeft(bottomRightZ0));
+				costInt = std::max(costInt, nav.getMovementCostLeft(rightTopZ1));
+				costInt = std::max(costInt, nav.getMovementCostRight(rightBottomZ1));
+				costInt = std::max(costInt, nav.getMovementCostRight(bottomLeftZ1));
+				costInt = std::max(costInt, nav.getMovementCostLeft(bottomRightZ1));
 				// Check door state
-				doorInTheWay = doorInTheWay || rightTopZ0->closedDoorLeft;
-				doorInTheWay = doorInTheWay || rightBottomZ0->closedDoorRight;
-				doorInTheWay = doorInTheWay || bottomLeftZ0->closedDoorRight;
-				doorInTheWay = doorInTheWay || bottomRightZ0->closedDoorLeft;
-				doorInTheWay = doorInTheWay || rightTopZ1->closedDoorLeft;
-				doorInTheWay = doorInTheWay || rightBottomZ1->closedDoorRight;
-				doorInTheWay = doorInTheWay || bottomLeftZ1->closedDoorRight;
-				doorInTheWay = doorInTheWay || bottomRightZ1->closedDoorLeft;
+				doorInTheWay = doorInTheWay || nav.getClosedDoorLeft(rightTopZ0);
+				doorInTheWay = doorInTheWay || nav.getClosedDoorRight(rightBottomZ0);
+				doorInTheWay = doorInTheWay || nav.getClosedDoorRight(bottomLeftZ0);
+				doorInTheWay = doorInTheWay || nav.getClosedDoorLeft(bottomRightZ0);
+				doorInTheWay = doorInTheWay || nav.getClosedDoorLeft(rightTopZ1);
+				doorInTheWay = doorInTheWay || nav.getClosedDoorRight(rightBottomZ1);
+				doorInTheWay = doorInTheWay || nav.getClosedDoorRight(bottomLeftZ1);
+				doorInTheWay = doorInTheWay || nav.getClosedDoorLeft(bottomRightZ1);
 
 				// STEP 06: [For large units if moving: down-right or up-left / SE or NW]
 				// Diagonally located tiles cannot have impassable scenery or static units
-				if (bottomLeftZ0->movementCostIn == 255 || rightTopZ0->movementCostIn == 255 ||
-				    bottomLeftZ1->movementCostIn == 255 || rightTopZ1->movementCostIn == 255)
+				if (nav.getMovementCostIn(bottomLeftZ0) == 255 ||
+				    nav.getMovementCostIn(rightTopZ0) == 255 ||
+				    nav.getMovementCostIn(bottomLeftZ1) == 255 ||
+				    nav.getMovementCostIn(rightTopZ1) == 255)
 				{
 					return false;
 				}
 				if (!ignoreAllUnits &&
-				    (bottomLeftZ0->getUnitIfPresent(true, true, true, tileObject,
-				                                    ignoreStaticUnits) ||
-				     rightTopZ0->getUnitIfPresent(true, true, true, tileObject,
-				                                  ignoreStaticUnits) ||
-				     bottomLeftZ1->getUnitIfPresent(true, true, true, tileObject,
-				                                    ignoreStaticUnits) ||
-				     rightTopZ1->getUnitIfPresent(true, true, true, tileObject, ignoreStaticUnits)))
+				    (staticUnitPresent(bottomLeftZ0) || staticUnitPresent(rightTopZ0) ||
+				     staticUnitPresent(bottomLeftZ1) || staticUnitPresent(rightTopZ1)))
 				{
 					return false;
 				}
@@ -522,17 +535,17 @@ bool BattleUnitTileHelper::canEnterTile(Tile *from, Tile *to, float &cost, bool
 					// Going down-right
 					if (toPos.x > fromPos.x)
 					{
-						auto edge = map.getTile(toPos.x, toPos.y, toPos.z + 2);
+						int edge = nav.getIndex(toPos.x, toPos.y, toPos.z + 2);
 						// Legend: * = from, + = "to" tile, X = tiles we already have
 						//  **X
 						//  **X
 						//  XX+
 						// Must check 5 tiles above our head, already have 4 of them
-						if (edge->solidGround || edge->hasLift || rightBottomZ1->solidGround ||
-						    rightBottomZ1->hasLift || bottomRightZ1->solidGround ||
-						    bottomRightZ1->hasLift || rightTopZ1->solidGround ||
-						    rightTopZ1->hasLift || bottomLeftZ1->solidGround ||
-						    bottomLeftZ1->hasLift)
+						if (nav.getSolidGround(edge) || nav.getHasLift(edge) ||
+						    nav.getSolidGround(rightBottomZ1) || nav.getHasLift(rightBottomZ1) ||
+						    nav.getSolidGround(bottomRightZ1) || nav.getHasLift(bottomRightZ1) ||
+						    nav.getSolidGround(rightTopZ1) || nav.getHasLift(rightTopZ1) ||
+						    nav.getSolidGround(bottomLeftZ1) || nav.getHasLift(bottomLeftZ1))
 						{
 							return false;
 						}
@@ -540,19 +553,21 @@ bool BattleUnitTileHelper::canEnterTile(Tile *from, Tile *to, float &cost, bool
 					// Going up-left
 					else
 					{
-						auto leftTop = map.getTile(toPos.x - 1, toPos.y - 1, toPos.z + 2);
-						auto leftMiddle = map.getTile(toPos.x - 1, toPos.y, toPos.z + 2);
-						auto topMiddle = map.getTile(toPos.x, toPos.y - 1, toPos.z + 2);
+						int leftTop = nav.getIndex(toPos.x - 1, toPos.y - 1, toPos.z + 2);
+						int leftMiddle = nav.getIndex(toPos.x - 1, toPos.y, toPos.z + 2);
+						int topMiddle = nav.getIndex(toPos.x, toPos.y - 1, toPos.z + 2);
 						// Legend: * = from, + = "to" tile, X = tiles we already have
 						//  xxX
 						//  x+*
 						//  X**
 						// Must check 5 tiles above our head, already have 2 of them
-						if (leftMiddle->solidGround || leftMiddle->hasLift ||
-						    leftTop->solidGround || leftTop->hasLift || topMiddle->solidGround ||
-						    topMiddle->hasLift || rightTopZ1->solidGround || rightTopZ1->hasLift ||
-						    bottomLeftZ1->solidGround || bottomLeftZ1->hasLift || toZ1->hasLift ||
-						    toXZ1->hasLift || toYZ1->hasLift || toXYZ1->hasLift)
+						if (nav.getSolidGround(leftMiddle) || nav.getHasLift(leftMiddle) ||
+						    nav.getSolidGround(leftTop) || nav.getHasLift(leftTop) ||
+						    nav.getSolidGround(topMiddle) || nav.getHasLift(topMiddle) ||
+						    nav.getSolidGround(rightTopZ1) || nav.getHasLift(rightTopZ1) ||
+						    nav.getSolidGround(bottomLeftZ1) || nav.getHasLift(bottomLeftZ1) ||
+						    nav.getHasLift(toZ1) || nav.getHasLift(toXZ1) ||
+						    nav.getHasLift(toYZ1) || nav.getHasLift(toXYZ1))
 						{
 							return false;
 						}
@@ -581,57 +596,55 @@ bool BattleUnitTileHelper::canEnterTile(Tile *from, Tile *to, float &cost, bool
 				//	-  -  -  -  x 0          *  *  *  *  x 0
 				//	----  ----  x            ****  ****  x
 				*/
-				Tile *topLeftZ0 = map.getTile(std::max(fromPos.x, toPos.x) - 2,
-				                              std::max(fromPos.y, toPos.y) - 2, z);
-				Tile *topZ0 = map.getTile(std::max(fromPos.x, toPos.x) - 1,
-				                          std::max(fromPos.y, toPos.y) - 2, z);
-				Tile *leftZ0 = map.getTile(std::max(fromPos.x, toPos.x) - 2,
-				                           std::max(fromPos.y, toPos.y) - 1, z);
-				Tile *bottomRightZ0 =
-				    map.getTile(std::max(fromPos.x, toPos.x), std::max(fromPos.y, toPos.y), z);
-				Tile *topLeftZ1 = map.getTile(std::max(fromPos.x, toPos.x) - 2,
-				                              std::max(fromPos.y, toPos.y) - 2, z + 1);
-				Tile *topZ1 = map.getTile(std::max(fromPos.x, toPos.x) - 1,
-				                          std::max(fromPos.y, toPos.y) - 2, z + 1);
-				Tile *leftZ1 = map.getTile(std::max(fromPos.x, toPos.x) - 2,
-				                           std::max(fromPos.y, toPos.y) - 1, z + 1);
-				Tile *bottomRightZ1 =
-				    map.getTile(std::max(fromPos.x, toPos.x), std::max(fromPos.y, toPos.y), z + 1);
+				int topLeftZ0 = nav.getIndex(std::max(fromPos.x, toPos.x) - 2,
+				                             std::max(fromPos.y, toPos.y) - 2, z);
+				int topZ0 = nav.getIndex(std::max(fromPos.x, toPos.x) - 1,
+				                         std::max(fromPos.y, toPos.y) - 2, z);
+				int leftZ0 = nav.getIndex(std::max(fromPos.x, toPos.x) - 2,
+				                          std::max(fromPos.y, toPos.y) - 1, z);
+				int bottomRightZ0 =
+				    nav.getIndex(std::max(fromPos.x, toPos.x), std::max(fromPos.y, toPos.y), z);
+				int topLeftZ1 = nav.getIndex(std::max(fromPos.x, toPos.x) - 2,
+				                             std::max(fromPos.y, toPos.y) - 2, z + 1);
+				int topZ1 = nav.getIndex(std::max(fromPos.x, toPos.x) - 1,
+				                         std::max(fromPos.y, toPos.y) - 2, z + 1);
+				int leftZ1 = nav.getIndex(std::max(fromPos.x, toPos.x) - 2,
+				                          std::max(fromPos.y, toPos.y) - 1, z + 1);
+				int bottomRightZ1 =
+				    nav.getIndex(std::max(fromPos.x, toPos.x), std::max(fromPos.y, toPos.y), z + 1);
 
 				// STEP 06: [For large units if moving: down-left or up-right / NE or SW]
 				// Find highest movement cost amongst all walls we intersect
-				costInt = std::max(costInt, topZ0->movementCostLeft);
-				costInt = std::max(costInt, leftZ0->movementCostRight);
-				costInt = std::max(costInt, bottomRightZ0->movementCostLeft);
-				costInt = std::max(costInt, bottomRightZ0->movementCostRight);
-				costInt = std::max(costInt, topZ1->movementCostLeft);
-				costInt = std::max(costInt, leftZ1->movementCostRight);
-				costInt = std::max(costInt, bottomRightZ1->movementCostLeft);
-				costInt = std::max(costInt, bottomRightZ1->movementCostRight);
+				costInt = std::max(costInt, nav.getMovementCostLeft(topZ0));
+				costInt = std::max(costInt, nav.getMovementCostRight(leftZ0));
+				costInt = std::max(costInt, nav.getMovementCostLeft(bottomRightZ0));
+				costInt = std::max(costInt, nav.getMovementCostRight(bottomRightZ0));
+				costInt = std::max(costInt, nav.getMovementCostLeft(topZ1));
+				costInt = std::max(costInt, nav.getMovementCostRight(leftZ1));
+				costInt = std::max(costInt, nav.getMovementCostLeft(bottomRightZ1));
+				costInt = std::max(costInt, nav.getMovementCostRight(bottomRightZ1));
 				// Check door state
-				doorInTheWay = doorInTheWay || topZ0->closedDoorLeft;
-				doorInTheWay = doorInTheWay || leftZ0->closedDoorRight;
-				doorInTheWay = doorInTheWay || bottomRightZ0->closedDoorLeft;
-				doorInTheWay = doorInTheWay || bottomRightZ0->closedDoorRight;
-				doorInTheWay = doorInTheWay || topZ1->closedDoorLeft;
-				doorInTheWay = doorInTheWay || leftZ1->closedDoorRight;
-				doorInTheWay = doorInTheWay || bottomRightZ1->closedDoorLeft;
-				doorInTheWay = doorInTheWay || bottomRightZ1->closedDoorRight;
+				doorInTheWay = doorInTheWay || nav.getClosedDoorLeft(topZ0);
+				doorInTheWay = doorInTheWay || nav.getClosedDoorRight(leftZ0);
+				doorInTheWay = doorInTheWay || nav.getClosedDoorLeft(bottomRightZ0);
+				doorInTheWay = doorInTheWay || nav.getClosedDoorRight(bottomRightZ0);
+				doorInTheWay = doorInTheWay || nav.getClosedDoorLeft(topZ1);
+				doorInTheWay = doorInTheWay || nav.getClosedDoorRight(leftZ1);
+				doorInTheWay = doorInTheWay || nav.getClosedDoorLeft(bottomRightZ1);
+				doorInTheWay = doorInTheWay || nav.getClosedDoorRight(bottomRightZ1);
 
 				// STEP 06: [For large units if moving: down-left or up-right / NE or SW]
 				// Diagonally located tiles cannot have impassable scenery or static units
-				if (topLeftZ0->movementCostIn == 255 || bottomRightZ0->movementCostIn == 255 ||
-				    topLeftZ1->movementCostIn == 255 || bottomRightZ1->movementCostIn == 255)
+				if (nav.getMovementCostIn(topLeftZ0) == 255 ||
+				    nav.getMovementCostIn(bottomRightZ0) == 255 ||
+				    nav.getMovementCostIn(topLeftZ1) == 255 ||
+				    nav.getMovementCostIn(bottomRightZ1) == 255)
 				{
 					return false;
 				}
 				if (!ignoreAllUnits &&
-				    (topLeftZ0->getUnitIfPresent(true, true, true, tileObject, ignoreStaticUnits) ||
-				     bottomRightZ0->getUnitIfPresent(true, true, true, tileObject,
-				                                     ignoreStaticUnits) ||
-				     topLeftZ1->getUnitIfPresent(true, true, true, tileObject, ignoreStaticUnits) ||
-				     bottomRightZ1->getUnitIfPresent(true, true, true, tileObject,
-				                                     ignoreStaticUnits)))
+				    (staticUnitPresent(topLeftZ0) || staticUnitPresent(bottomRightZ0) ||
+				     staticUnitPresent(topLeftZ1) || staticUnitPresent(bottomRightZ1)))
 				{
 					return false;
 				}
@@ -644,18 +657,20 @@ bool BattleUnitTileHelper::canEnterTile(Tile *from, Tile *to, float &cost, bool
 					// Going up-right
 					if (toPos.x > fromPos.x)
 					{
-						auto rightMiddle = map.getTile(toPos.x, toPos.y, toPos.z + 2);
-						auto rightTop = map.getTile(toPos.x, toPos.y - 1, toPos.z + 2);
+						int rightMiddle = nav.getIndex(toPos.x, toPos.y, toPos.z + 2);
+						int rightTop = nav.getIndex(toPos.x, toPos.y - 1, toPos.z + 2);
 						// Legend: * = from, + = "to" tile, X = tiles we already have
 						//  XXx
 						//  **+
 						//  **X
 						// Must check 5 tiles above our head, already have 3 of them
-						if (rightMiddle->solidGround || rightMiddle->hasLift ||
-						    rightTop->solidGround || rightTop->hasLift || topLeftZ1->solidGround ||
-						    topLeftZ1->hasLift || topZ1->solidGround || topZ1->hasLift ||
-						    bottomRightZ1->solidGround || bottomRightZ1->hasLift || toZ1->hasLift ||
-						    toXZ1->hasLift || toYZ1->hasLift || toXYZ1->hasLift)
+						if (nav.getSolidGround(rightMiddle) || nav.getHasLift(rightMiddle) ||
+						    nav.getSolidGround(rightTop) || nav.getHasLift(rightTop) ||
+						    nav.getSolidGround(topLeftZ1) || nav.getHasLift(topLeftZ1) ||
+						    nav.getSolidGround(topZ1) || nav.getHasLift(topZ1) ||
+						    nav.getSolidGround(bottomRightZ1) || nav.getHasLift(bottomRightZ1) ||
+						    nav.getHasLift(toZ1) || nav.getHasLift(toXZ1) ||
+						    nav.getHasLift(toYZ1) || nav.getHasLift(toXYZ1))
 						{
 							return false;
 						}
@@ -663,19 +678,20 @@ bool BattleUnitTileHelper::canEnterTile(Tile *from, Tile *to, float &cost, bool
 					// Going bottom-left
 					else
 					{
-						auto bottomLeft = map.getTile(toPos.x - 1, toPos.y, toPos.z + 2);
-						auto bottomMiddle = map.getTile(toPos.x, toPos.y, toPos.z + 2);
+						int bottomLeft = nav.getIndex(toPos.x - 1, toPos.y, toPos.z + 2);
+						int bottomMiddle = nav.getIndex(toPos.x, toPos.y, toPos.z + 2);
 						// Legend: * = from, + = "to" tile, X = tiles we already have
 						//  X**
 						//  X**
 						//  x+X
 						// Must check 5 tiles above our head, already have 2 of them
-						if (bottomLeft->solidGround || bottomLeft->hasLift ||
-						    bottomMiddle->solidGround || bottomMiddle->hasLift ||
-						    topLeftZ1->solidGround || topLeftZ1->hasLift || leftZ1->solidGround ||
-						    leftZ1->hasLift || bottomRightZ1->solidGround ||
-						    bottomRightZ1->hasLift || toZ1->hasLift || toXZ1->hasLift ||
-						    toYZ1->hasLift || toXYZ1->hasLift)
+						if (nav.getSolidGround(bottomLeft) || nav.getHasLift(bottomLeft) ||
+						    nav.getSolidGround(bottomMiddle) || nav.getHasLift(bottomMiddle) ||
+						    nav.getSolidGround(topLeftZ1) || nav.getHasLift(topLeftZ1) ||
+						    nav.getSolidGround(leftZ1) || nav.getHasLift(leftZ1) ||
+						    nav.getSolidGround(bottomRightZ1) || nav.getHasLift(bottomRightZ1) ||
+						    nav.getHasLift(toZ1) || nav.getHasLift(toXZ1) ||
+						    nav.getHasLift(toYZ1) || nav.getHasLift(toXYZ1))
 						{
 							return false;
 						}
@@ -689,22 +705,22 @@ bool BattleUnitTileHelper::canEnterTile(Tile *from, Tile *to, float &cost, bool
 			// STEP 06: [For large units if moving along X]
 			if (fromPos.x != toPos.x)
 			{
-				Tile *topZ0 = map.getTile(toPos.x, toPos.y - 1, z);
-				Tile *bottomz0 = map.getTile(toPos.x, toPos.y, z);
-				Tile *topZ1 = map.getTile(toPos.x, toPos.y - 1, z + 1);
-				Tile *bottomZ1 = map.getTile(toPos.x, toPos.y, z + 1);
+				int topZ0 = nav.getIndex(toPos.x, toPos.y - 1, z);
+				int bottomz0 = nav.getIndex(toPos.x, toPos.y, z);
+				int topZ1 = nav.getIndex(toPos.x, toPos.y - 1, z + 1);
+				int bottomZ1 = nav.getIndex(toPos.x, toPos.y, z + 1);
 
 				// STEP 06: [For large units if moving along X]
 				// Find highest movement cost amongst all walls we intersect
-				costInt = std::max(costInt, topZ0->movementCostLeft);
-				costInt = std::max(costInt, bottomz0->movementCostLeft);
-				costInt = std::max(costInt, topZ1->movementCostLeft);
-				costInt = std::max(costInt, bottomZ1->movementCostLeft);
+				costInt = std::max(costInt, nav.getMovementCostLeft(topZ0));
+				costInt = std::max(costInt, nav.getMovementCostLeft(bottomz0));
+				costInt = std::max(costInt, nav.getMovementCostLeft(topZ1));
+				costInt = std::max(costInt, nav.getMovementCostLeft(bottomZ1));
 				// Check door state
-				doorInTheWay = doorInTheWay || topZ0->closedDoorLeft;
-				doorInTheWay = doorInTheWay || bottomz0->closedDoorLeft;
-				doorInTheWay = doorInTheWay || topZ1->closedDoorLeft;
-				doorInTheWay = doorInTheWay || bottomZ1->closedDoorLeft;
+				doorInTheWay = doorInTheWay || nav.getClosedDoorLeft(topZ0);
+				doorInTheWay = doorInTheWay || nav.getClosedDoorLeft(bottomz0);
+				doorInTheWay = doorInTheWay || nav.getClosedDoorLeft(topZ1);
+				doorInTheWay = doorInTheWay || nav.getClosedDoorLeft(bottomZ1);
 
 				// Do not have to check for units because we already checked in STEP 01
 				// Do not have to check for scenery because that's included in movement cost
@@ -715,12 +731,14 @@ bool BattleUnitTileHelper::canEnterTile(Tile *from, Tile *to, float &cost, bool
 				// We still have to check it for gravlift though
 				if (goingDown)
 				{
-					auto topOther = map.getTile(toPos.x - 1, toPos.y - 1, toPos.z + 2);
-					auto bottomOther = map.getTile(toPos.x - 1, toPos.y, toPos.z + 2);
-					if (topZ1->solidGround || topZ1->hasLift || bottomZ1->solidGround ||
-					    bottomZ1->hasLift || topOther->solidGround || topOther->hasLift ||
-					    bottomOther->solidGround || bottomOther->hasLift || toZ1->hasLift ||
-					    toXZ1->hasLift || toYZ1->hasLift || toXYZ1->hasLift)
+					int topOther = nav.getIndex(toPos.x - 1, toPos.y - 1, toPos.z + 2);
+					int bottomOther = nav.getIndex(toPos.x - 1, toPos.y, toPos.z + 2);
+					if (nav.getSolidGround(topZ1) || nav.getHasLift(topZ1) ||
+					    nav.getSolidGround(bottomZ1) || nav.getHasLift(bottomZ1) ||
+					    nav.getSolidGround(topOther) || nav.getHasLift(topOther) ||
+					    nav.getSolidGround(bottomOther) || nav.getHasLift(bottomOther) ||
+					    nav.getHasLift(toZ1) || nav.getHasLift(toXZ1) || nav.getHasLift(toYZ1) ||
+					    nav.getHasLift(toXYZ1))
 					{
 						return false;
 					}
@@ -729,22 +747,22 @@ bool BattleUnitTileHelper::canEnterTile(Tile *from, Tile *to, float &cost, bool
 			// STEP 06: [For large units if moving along Y]
 			else if (fromPos.y != toPos.y)
 			{
-				Tile *leftZ0 = map.getTile(toPos.x - 1, toPos.y, z);
-				Tile *rightZ0 = map.getTile(toPos.x, toPos.y, z);
-				Tile *leftZ1 = map.getTile(toPos.x - 1, toPos.y, z + 1);
-				Tile *rightZ1 = map.getTile(toPos.x, toPos.y, z + 1);
+				int leftZ0 = nav.getIndex(toPos.x - 1, toPos.y, z);
+				int rightZ0 = nav.getIndex(toPos.x, toPos.y, z);
+				int leftZ1 = nav.getIndex(toPos.x - 1, toPos.y, z + 1);
+				int rightZ1 = nav.getIndex(toPos.x, toPos.y, z + 1);
 
 				// STEP 06: [For large units if moving along Y]
 				// Find highest movement cost amongst all walls we intersect
-				costInt = std::max(costInt, leftZ0->movementCostRight);
-				costInt = std::max(costInt, rightZ0->movementCostRight);
-				costInt = std::max(costInt, leftZ1->movementCostRight);
-				costInt = std::max(costInt, rightZ1->movementCostRight);
+				costInt = std::max(costInt, nav.getMovementCostRight(leftZ0));
+				costInt = std::max(costInt, nav.getMovementCostRight(rightZ0));
+				costInt = std::max(costInt, nav.getMovementCostRight(leftZ1));
+				costInt = std::max(costInt, nav.getMovementCostRight(rightZ1));
 				// Check door state
-				doorInTheWay = doorInTheWay || leftZ0->closedDoorRight;
-				doorInTheWay = doorInTheWay || rightZ0->closedDoorRight;
-				doorInTheWay = doorInTheWay || leftZ1->closedDoorRight;
-				doorInTheWay = doorInTheWay || rightZ1->closedDoorRight;
+				doorInTheWay = doorInTheWay || nav.getClosedDoorRight(leftZ0);
+				doorInTheWay = doorInTheWay || nav.getClosedDoorRight(rightZ0);
+				doorInTheWay = doorInTheWay || nav.getClosedDoorRight(leftZ1);
+				doorInTheWay = doorInTheWay || nav.getClosedDoorRight(rightZ1);
 
 				// Do not have to check for units because we already did in STEP 01
 				// Do not have to check for scenery because that's included in movement cost
@@ -755,12 +773,14 @@ bool BattleUnitTileHelper::canEnterTile(Tile *from, Tile *to, float &cost, bool
 				// We still have to check it for gravlift though
 				if (goingDown)
 				{
-					auto leftOther = map.getTile(toPos.x - 1, toPos.y - 1, toPos.z + 2);
-					auto rightOther = map.getTile(toPos.x, toPos.y - 1, toPos.z + 2);
-					if (leftZ1->solidGround || leftZ1->hasLift || rightZ1->solidGround ||
-					    rightZ1->hasLift || leftOther->solidGround || leftOther->hasLift ||
-					    rightOther->solidGround || rightOther->hasLift || toZ1->hasLift ||
-					    toXZ1->hasLift || toYZ1->hasLift || toXYZ1->hasLift)
+					int leftOther = nav.getIndex(toPos.x - 1, toPos.y - 1, toPos.z + 2);
+					int rightOther = nav.getIndex(toPos.x, toPos.y - 1, toPos.z + 2);
+					if (nav.getSolidGround(leftZ1) || nav.getHasLift(leftZ1) ||
+					    nav.getSolidGround(rightZ1) || nav.getHasLift(rightZ1) ||
+					    nav.getSolidGround(leftOther) || nav.getHasLift(leftOther) ||
+					    nav.getSolidGround(rightOther) || nav.getHasLift(rightOther) ||
+					    nav.getHasLift(toZ1) || nav.getHasLift(toXZ1) || nav.getHasLift(toYZ1) ||
+					    nav.getHasLift(toXYZ1))
 					{
 						return false;
 					}
@@ -772,8 +792,8 @@ bool BattleUnitTileHelper::canEnterTile(Tile *from, Tile *to, float &cost, bool
 				// Do not have to check for units because we already did in STEP 01
 
 				// Cannot descend if on solid ground
-				if (from->solidGround || fromX1->solidGround || fromY1->solidGround ||
-				    fromXY1->solidGround)
+				if (nav.getSolidGround(from) || nav.getSolidGround(fromX1) ||
+				    nav.getSolidGround(fromY1) || nav.getSolidGround(fromXY1))
 				{
 					return false;
 				}
@@ -810,39 +830,38 @@ bool BattleUnitTileHelper::canEnterTile(Tile *from, Tile *to, float &cost, bool
 			//	- 0-  x 0              0   x 0*
 			//	----  x                    x***
 			*/
-			Tile *topLeft =
-			    map.getTile(std::min(fromPos.x, toPos.x), std::min(fromPos.y, toPos.y), z);
-			Tile *topRight =
-			    map.getTile(std::max(fromPos.x, toPos.x), std::min(fromPos.y, toPos.y), z);
-			Tile *bottomLeft =
-			    map.getTile(std::min(fromPos.x, toPos.x), std::max(fromPos.y, toPos.y), z);
-			Tile *bottomRight =
-			    map.getTile(std::max(fromPos.x, toPos.x), std::max(fromPos.y, toPos.y), z);
+			int topLeft =
+			    nav.getIndex(std::min(fromPos.x, toPos.x), std::min(fromPos.y, toPos.y), z);
+			int topRight =
+			    nav.getIndex(std::max(fromPos.x, toPos.x), std::min(fromPos.y, toPos.y), z);
+			int bottomLeft =
+			    nav.getIndex(std::min(fromPos.x, toPos.x), std::max(fromPos.y, toPos.y), z);
+			int bottomRight =
+			    nav.getIndex(std::max(fromPos.x, toPos.x), std::max(fromPos.y, toPos.y), z);
 
 			// STEP 06: [For small units if moving diagonally]
 			// Find highest movement cost amongst all walls we intersect
-			costInt = std::max(costInt, topRight->movementCostLeft);
-			costInt = std::max(costInt, bottomLeft->movementCostRight);
-			costInt = std::max(costInt, bottomRight->movementCostLeft);
-			costInt = std::max(costInt, bottomRight->movementCostRight);
+			costInt = std::max(costInt, nav.getMovementCostLeft(topRight));
+			costInt = std::max(costInt, nav.getMovementCostRight(bottomLeft));
+			costInt = std::max(costInt, nav.getMovementCostLeft(bottomRight));
+			costInt = std::max(costInt, nav.getMovementCostRight(bottomRight));
 			// Check door state
-			doorInTheWay = doorInTheWay || topRight->closedDoorLeft;
-			doorInTheWay = doorInTheWay || bottomLeft->closedDoorRight;
-			doorInTheWay = doorInTheWay || bottomRight->closedDoorLeft;
-			doorInTheWay = doorInTheWay || bottomRight->closedDoorRight;
+			doorInTheWay = doorInTheWay || nav.getClosedDoorLeft(topRight);
+			doorInTheWay = doorInTheWay || nav.getClosedDoorRight(bottomLeft);
+			doorInTheWay = doorInTheWay || nav.getClosedDoorLeft(bottomRight);
+			doorInTheWay = doorInTheWay || nav.getClosedDoorRight(bottomRight);
 
 			// STEP 06: [For small units if moving diagonally down-right or up-left]
 			// Diagonally located tiles cannot have impassable scenery or static units
 			if (fromPos.x - toPos.x == fromPos.y - toPos.y)
 			{
-				if (bottomLeft->movementCostIn == 255 || topRight->movementCostIn == 255)
+				if (nav.getMovementCostIn(bottomLeft) == 255 ||
+				    nav.getMovementCostIn(topRight) == 255)
 				{
 					return false;
 				}
 				if (!ignoreAllUnits &&
-				    (bottomLeft->getUnitIfPresent(true, true, true, tileObject,
-				                                  ignoreStaticUnits) ||
-				     topRight->getUnitIfPresent(true, true, true, tileObject, ignoreStaticUnits)))
+				    (staticUnitPresent(bottomLeft) || staticUnitPresent(topRight)))
 				{
 					return false;
 				}
@@ -851,14 +870,13 @@ bool BattleUnitTileHelper::canEnterTile(Tile *from, Tile *to, float &cost, bool
 			// Diagonally located tiles cannot have impassable scenery or static units
 			else
 			{
-				if (topLeft->movementCostIn == 255 || bottomRight->movementCostIn == 255)
+				if (nav.getMovementCostIn(topLeft) == 255 ||
+				    nav.getMovementCostIn(bottomRight) == 255)
 				{
 					return false;
 				}
 				if (!ignoreAllUnits &&
-				    (topLeft->getUnitIfPresent(true, true, true, tileObject, ignoreStaticUnits) ||
-				     bottomRight->getUnitIfPresent(true, true, true, tileObject,
-				                                   ignoreStaticUnits)))
+				    (staticUnitPresent(topLeft) || staticUnitPresent(bottomRight)))
 				{
 					return false;
 				}
@@ -869,22 +887,22 @@ bool BattleUnitTileHelper::canEnterTile(Tile *from, Tile *to, float &cost, bool
 			{
 				// We cannot have solid ground or lift in any of the three tiles besides ours
 				if (!(toPos.x > fromPos.x && toPos.y > fromPos.y) &&
-				    (topLeft->solidGround || topLeft->hasLift))
+				    (nav.getSolidGround(topLeft) || nav.getHasLift(topLeft)))
 				{
 					return false;
 				}
 				if (!(toPos.x < fromPos.x && toPos.y > fromPos.y) &&
-				    (topRight->solidGround || topRight->hasLift))
+				    (nav.getSolidGround(topRight) || nav.getHasLift(topRight)))
 				{
 					return false;
 				}
 				if (!(toPos.x > fromPos.x && toPos.y < fromPos.y) &&
-				    (bottomLeft->solidGround || bottomLeft->hasLift))
+				    (nav.getSolidGround(bottomLeft) || nav.getHasLift(bottomLeft)))
 				{
 					return false;
 				}
 				if (!(toPos.x < fromPos.x && toPos.y < fromPos.y) &&
-				    (bottomRight->solidGround || bottomRight->hasLift))
+				    (nav.getSolidGround(bottomRight) || nav.getHasLift(bottomRight)))
 				{
 					return false;
 				}
@@ -893,14 +911,14 @@ bool BattleUnitTileHelper::canEnterTile(Tile *from, Tile *to, float &cost, bool
 		// STEP 06: [For small units if moving linearly]
 		else
 		{
-			Tile *bottomRight =
-			    map.getTile(std::max(fromPos.x, toPos.x), std::max(fromPos.y, toPos.y), z);
+			int bottomRight =
+			    nav.getIndex(std::max(fromPos.x, toPos.x), std::max(fromPos.y, toPos.y), z);
 
 			// STEP 06: [For small units if moving along X]
 			if (fromPos.x != toPos.x)
 			{
-				costInt = std::max(costInt, bottomRight->movementCostLeft);
-				doorInTheWay = doorInTheWay || bottomRight->closedDoorLeft;
+				costInt = std::max(costInt, nav.getMovementCostLeft(bottomRight));
+				doorInTheWay = doorInTheWay || nav.getClosedDoorLeft(bottomRight);
 
 				// Do not have to check for units because we already did in STEP 01
 				// Do not have to check for scenery because that's included in movement cost
@@ -908,8 +926,8 @@ bool BattleUnitTileHelper::canEnterTile(Tile *from, Tile *to, float &cost, bool
 				// Cannot go down if above target tile is solid ground or gravlift
 				if (goingDown)
 				{
-					auto t = map.getTile(toPos.x, toPos.y, toPos.z + 1);
-					if (t->solidGround || t->hasLift)
+					int t = nav.getIndex(toPos.x, toPos.y, toPos.z + 1);
+					if (nav.getSolidGround(t) || nav.getHasLift(t))
 					{
 						return false;
 					}
@@ -918,8 +936,8 @@ bool BattleUnitTileHelper::canEnterTile(Tile *from, Tile *to, float &cost, bool
 			// STEP 06: [For small units if moving along Y]
 			else if (fromPos.y != toPos.y)
 			{
-				costInt = std::max(costInt, bottomRight->movementCostRight);
-				doorInTheWay = doorInTheWay || bottomRight->closedDoorRight;
+				costInt = std::max(costInt, nav.getMovementCostRight(bottomRight));
+				doorInTheWay = doorInTheWay || nav.getClosedDoorRight(bottomRight);
 
 				// Do not have to check for units because we already did in STEP 01
 				// Do not have to check for scenery because that's included in movement cost
@@ -927,8 +945,8 @@ bool BattleUnitTileHelper::canEnterTile(Tile *from, Tile *to, float &cost, bool
 				// Cannot go down if above target tile is solid ground or gravlift
 				if (goingDown)
 				{
-					auto t = map.getTile(toPos.x, toPos.y, toPos.z + 1);
-					if (t->solidGround || t->hasLift)
+					int t = nav.getIndex(toPos.x, toPos.y, toPos.z + 1);
+					if (nav.getSolidGround(t) || nav.getHasLift(t))
 					{
 						return false;
 					}
@@ -940,7 +958,7 @@ bool BattleUnitTileHelper::canEnterTile(Tile *from, Tile *to, float &cost, bool
 				// Do not have to check for units because we already did in STEP 01
 
 				// Cannot descend if on solid ground
-				if (from->solidGround)
+				if (nav.getSolidGround(from))
 				{
 					return false;
 				}
@@ -4,9 +4,12 @@
 #include "framework/trace.h"
 #include "game/state/city/building.h"
 #include "game/state/city/doodad.h"
+#include "game/state/city/flightlanegraph.h"
 #include "game/state/city/projectile.h"
+#include "game/state/city/projectilebatch.h"
 #include "game/state/city/scenery.h"
 #include "game/state/city/vehicle.h"
+#include "game/state/city/vehiclegrid.h"
 #include "game/state/city/vehiclemission.h"
 #include "game/state/city/vequipment.h"
 #include "game/state/gamestate.h"
@@ -74,10 +77,17 @@ void City::initMap()
 	}
 	this->map.reset(new TileMap(this->size, VELOCITY_SCALE_CITY,
 	                            {VOXEL_X_CITY, VOXEL_Y_CITY, VOXEL_Z_CITY}, layerMap));
+	this->vehicleGrid = mksp<VehicleGrid>(this->size, VELOCITY_SCALE_CITY);
+	this->projectileBatch.reset(new ProjectileBatch());
+	this->activeScenery.clear();
 	for (auto &s : this->scenery)
 	{
 		// FIXME: Should we really add all scenery to the map? What if it's destroyed?
 		this->map->addObjectToMap(s);
+		if (s->falling)
+		{
+			this->activeScenery.push_back(s);
+		}
 		if (s->type->isLandingPad)
 		{
 			Vec2<int> pos = {s->initialPosition.x, s->initialPosition.y};
@@ -107,6 +117,11 @@ void City::initMap()
 			LogInfo("Pad: %s", loc);
 		}
 	}
+	// One lane for each altitude vehicles can be told to fly at
+	std::vector<int> laneAltitudes = {
+	    static_cast<int>(Vehicle::Altitude::Low), static_cast<int>(Vehicle::Altitude::Standard),
+	    static_cast<int>(Vehicle::Altitude::High), static_cast<int>(Vehicle::Altitude::Highest)};
+	this->flightLanes.reset(new FlightLaneGraph(*this->map, laneAltitudes));
 	for (auto &p : this->projectiles)
 	{
 		this->map->addObjectToMap(p);
@@ -114,10 +129,51 @@ void City::initMap()
 	for (auto &d : this->doodads)
 	{
 		this->map->addObjectToMap(d);
+		d->schedule(this->doodadTimers);
 	}
 	for (auto &p : this->portals)
 	{
 		this->map->addObjectToMap(p);
+		p->schedule(this->doodadTimers);
+	}
+}
+
+void City::handleProjectileHit(GameState &state, Collision &c)
+{
+	// FIXME: Handle collision
+	if (c.projectile->impactSfx)
+	{
+		fw().soundBackend->playSample(c.projectile->impactSfx, c.position);
+	}
+
+	auto doodadType = c.projectile->doodadType;
+	if (doodadType)
+	{
+		auto doodad = this->placeDoodad(doodadType, c.position);
+	}
+
+	switch (c.obj->getType())
+	{
+		case TileObject::Type::Vehicle:
+		{
+			auto vehicle = std::static_pointer_cast<TileObjectVehicle>(c.obj)->getVehicle();
+			vehicle->handleCollision(state, c);
+			LogWarning("Vehicle collision");
+			break;
+		}
+		case TileObject::Type::Scenery:
+		{
+			auto sceneryTile = std::static_pointer_cast<TileObjectScenery>(c.obj);
+			// FIXME: Don't just explode scenery, but damaged tiles/falling stuff? Different
+			// explosion doodads? Not all weapons instantly destory buildings too
+
+			auto doodad =
+			    this->placeDoodad({&state, "DOODAD_3_EXPLOSION"}, sceneryTile->getCenter());
+			sceneryTile->getOwner()->handleCollision(state, c);
+			break;
+		}
+		default:
+			LogError("Collision with non-collidable object");
 	}
 }
 
@@ -132,6 +188,9 @@ void City::update(GameState &state, unsigned int ticks)
 	// Need to use a 'safe' iterator method (IE keep the next it before calling ->update)
 	// as update() calls can erase it's object from the lists
 
+	Trace::start("City::update::pathRequests");
+	VehicleMission::processPathRequests(*this);
+	Trace::end("City::update::pathRequests");
 	Trace::start("City::update::buildings->landed_vehicles");
 	for (auto it = this->buildings.begin(); it != this->buildings.end();)
 	{
@@ -167,74 +226,28 @@ void City::update(GameState &state, unsigned int ticks)
 	}
 	Trace::end("City::update::buildings->landed_vehicles");
 	Trace::start("City::update::projectiles->update");
-	for (auto it = this->projectiles.begin(); it != this->projectiles.end();)
-	{
-		auto p = *it++;
-		p->update(state, ticks);
-	}
-	for (auto it = this->projectiles.begin(); it != this->projectiles.end();)
-	{
-		auto &p = *it++;
-		auto c = p->checkProjectileCollision(*map);
-		if (c)
-		{
-			// FIXME: Handle collision
-			this->projectiles.erase(c.projectile);
-			if (c.projectile->impactSfx)
-			{
-				fw().soundBackend->playSample(c.projectile->impactSfx, c.position);
-			}
-
-			auto doodadType = c.projectile->doodadType;
-			if (doodadType)
-			{
-				auto doodad = this->placeDoodad(doodadType, c.position);
-			}
-
-			switch (c.obj->getType())
-			{
-				case TileObject::Type::Vehicle:
-				{
-					auto vehicle = std::static_pointer_cast<TileObjectVehicle>(c.obj)->getVehicle();
-					vehicle->handleCollision(state, c);
-					LogWarning("Vehicle collision");
-					break;
-				}
-				case TileObject::Type::Scenery:
-				{
-					auto sceneryTile = std::static_pointer_cast<TileObjectScenery>(c.obj);
-					// FIXME: Don't just explode scenery, but damaged tiles/falling stuff? Different
-					// explosion doodads? Not all weapons instantly destory buildings too
-
-					auto doodad =
-					    this->placeDoodad({&state, "DOODAD_3_EXPLOSION"}, sceneryTile->getCenter());
-					sceneryTile->getOwner()->handleCollision(state, c);
-					break;
-				}
-				default:
-					LogError("Collision with non-collidable object");
-			}
-		}
-	}
+	this->projectileBatch->update(state, *map, this->projectiles, ticks,
+	                              [this, &state](Collision &c) { handleProjectileHit(state, c); });
 	Trace::end("City::update::projectiles->update");
 	Trace::start("City::update::scenery->update");
-	for (auto &s : this->scenery)
+	for (auto it = this->activeScenery.begin(); it != this->activeScenery.end();)
 	{
+		auto s = *it;
 		s->update(state, ticks);
+		if (s->falling)
+		{
+			it++;
+		}
+		else
+		{
+			it = this->activeScenery.erase(it);
+		}
 	}
 	Trace::end("City::update::scenery->update");
 	Trace::start("City::update::doodads->update");
-	for (auto it = this->doodads.begin(); it != this->doodads.end();)
-	{
-		auto d = *it++;
-		d->update(state, ticks);
-	}
-
-	for (auto it = this->portals.begin(); it != this->portals.end();)
-	{
-		auto p = *it++;
-		p->update(state, ticks);
-	}
+	this->doodadTimers.advance(ticks, [this, &state](const sp<Doodad> &d) {
+		d->updateScheduled(state, this->doodadTimers);
+	});
 	Trace::end("City::update::doodads->update");
 }
 
@@ -267,6 +280,7 @@ void City::generatePortals(GameState &state)
 				auto doodad =
 				    mksp<Doodad>(pos, StateRef<DoodadType>{&state, "DOODAD_6_DIMENSION_GATE"});
 				map->addObjectToMap(doodad);
+				doodad->schedule(this->doodadTimers);
 				this->portals.push_back(doodad);
 				break;
 			}
@@ -278,6 +292,7 @@ sp<Doodad> City::placeDoodad(StateRef<DoodadType> type, Vec3<float> position)
 {
 	auto doodad = mksp<Doodad>(position, type);
 	map->addObjectToMap(doodad);
+	doodad->schedule(this->doodadTimers);
 	this->doodads.push_back(doodad);
 	return doodad;
 }
@@ -2,6 +2,7 @@
 
 #include "game/state/stateobject.h"
 #include "library/sp.h"
+#include "library/timerwheel.h"
 #include "library/vec.h"
 #include <list>
 #include <map>
@@ -28,6 +29,11 @@ class DoodadType;
 class SceneryTileType;
 class BaseLayout;
 class TileMap;
+class VehicleGrid;
+class FlightLaneGraph;
+class VehiclePathRequest;
+class ProjectileBatch;
+class Collision;
 
 class City : public StateObject
 {
@@ -44,14 +50,25 @@ class City : public StateObject
 	std::map<Vec3<int>, StateRef<SceneryTileType>> initial_tiles;
 	StateRefMap<Building> buildings;
 	std::vector<sp<Scenery>> scenery;
+	// The scenery that needs updating every tick (currently just falling scenery), everything
+	// else is static until something hits it. Rebuilt from the scenery flags in initMap()
+	std::list<sp<Scenery>> activeScenery;
 	std::list<sp<Doodad>> doodads;
 	std::vector<sp<Doodad>> portals;
+	// Fires when a doodad or portal next changes frame or expires
+	TimerWheel<Doodad> doodadTimers;
 
 	std::set<sp<Projectile>> projectiles;
+	up<ProjectileBatch> projectileBatch;
+	// Routes requested by vehicle missions this tick, see VehicleMission::processPathRequests()
+	std::list<sp<VehiclePathRequest>> pathRequests;
 
 	up<TileMap> map;
+	sp<VehicleGrid> vehicleGrid;
+	up<FlightLaneGraph> flightLanes;
 
 	void update(GameState &state, unsigned int ticks);
+	void handleProjectileHit(GameState &state, Collision &c);
 	void dailyLoop(GameState &state);
 
 	void generatePortals(GameState &state);
@@ -6,6 +6,7 @@
 #include "game/state/rules/doodad_type.h"
 #include "game/state/tileview/tile.h"
 #include "game/state/tileview/tileobject_doodad.h"
+#include "library/timerwheel.h"
 #include "library/vector_remove.h"
 #include <algorithm>
 
@@ -42,6 +43,47 @@ void Doodad::update(GameState &state, int ticks)
 	}
 }
 
+int Doodad::getTicksUntilChange() const
+{
+	if (!temporary)
+		return 0;
+	int nextChange = lifetime;
+	if (!this->sprite)
+	{
+		int animTime = 0;
+		for (auto &f : type->frames)
+		{
+			animTime += f.time * TICKS_MULTIPLIER;
+			if (animTime > age)
+			{
+				nextChange = std::min(nextChange, animTime);
+				break;
+			}
+		}
+	}
+	return std::max(1, nextChange - age);
+}
+
+void Doodad::schedule(TimerWheel<Doodad> &timers)
+{
+	auto delay = this->getTicksUntilChange();
+	this->lastUpdateTick = timers.getTick();
+	if (delay == 0)
+		return;
+	this->nextUpdateTick = timers.getTick() + delay;
+	timers.schedule(shared_from_this(), delay);
+}
+
+void Doodad::updateScheduled(GameState &state, TimerWheel<Doodad> &timers)
+{
+	// Skip anything removed since it was scheduled, or scheduled twice
+	if (!this->tileObject || timers.getTick() != this->nextUpdateTick)
+		return;
+	this->update(state, (int)(timers.getTick() - this->lastUpdateTick));
+	if (this->tileObject)
+		this->schedule(timers);
+}
+
 void Doodad::remove(GameState &state)
 {
 	auto thisPtr = shared_from_this();
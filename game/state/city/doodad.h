@@ -11,6 +11,7 @@ class TileMap;
 class DoodadType;
 class Image;
 class GameState;
+template <typename T> class TimerWheel;
 
 /* A doodad is a visual only effect (IE doesn't change the game state) for
  * animated sprited, like hit animations/explosions etc. The do not move(?) */
@@ -27,6 +28,12 @@ class Doodad : public std::enable_shared_from_this<Doodad>
 	sp<Image> getSprite();
 	const Vec2<int> &getImageOffset() const { return this->imageOffset; }
 	void update(GameState &state, int ticks);
+	// Ticks until the sprite next changes or the doodad expires, or 0 if it never does
+	int getTicksUntilChange() const;
+	// Schedules the next change with 'timers'. Doodads only need updating when this fires,
+	// see updateScheduled()
+	void schedule(TimerWheel<Doodad> &timers);
+	void updateScheduled(GameState &state, TimerWheel<Doodad> &timers);
 	const Vec3<float> &getPosition() const { return this->position; }
 
 	void setPosition(Vec3<float> position);
@@ -44,6 +51,10 @@ class Doodad : public std::enable_shared_from_this<Doodad>
 	sp<Image> sprite;
 	// Or a DoodadType containing an animation
 	StateRef<DoodadType> type;
+
+	// Following members are not serialized, but rather are set when scheduled
+	uint64_t lastUpdateTick = 0;
+	uint64_t nextUpdateTick = 0;
 };
 
 } // namespace OpenApoc
@@ -0,0 +1,316 @@
+#include "game/state/city/flightlanegraph.h"
+#include "framework/logger.h"
+#include "framework/trace.h"
+#include "game/state/city/scenery.h"
+#include "game/state/rules/scenery_tile_type.h"
+#include "game/state/tileview/tile.h"
+#include "game/state/tileview/tileobject_scenery.h"
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <glm/glm.hpp>
+#include <limits>
+#include <queue>
+
+namespace OpenApoc
+{
+
+FlightLaneGraph::FlightLaneGraph(TileMap &map, const std::vector<int> &laneAltitudes)
+    : map(map),
+      sectorCount((map.size.x + SECTOR_SIZE - 1) / SECTOR_SIZE,
+                  (map.size.y + SECTOR_SIZE - 1) / SECTOR_SIZE)
+{
+	for (auto z : laneAltitudes)
+	{
+		z = clamp(z, 0, map.size.z - 1);
+		if (std::find(this->lanes.begin(), this->lanes.end(), z) == this->lanes.end())
+		{
+			this->lanes.push_back(z);
+		}
+	}
+	std::sort(this->lanes.begin(), this->lanes.end());
+
+	auto nodeCount = this->lanes.size() * this->sectorCount.x * this->sectorCount.y;
+	this->nodeOpen.resize(nodeCount, false);
+	this->nodeEdges.resize(nodeCount, 0);
+	this->sectorDirty.resize(this->sectorCount.x * this->sectorCount.y, true);
+	this->anySectorDirty = true;
+	this->update();
+}
+
+Vec2<int> FlightLaneGraph::getNeighbourOffset(int direction)
+{
+	static const Vec2<int> offsets[8] = {{-1, -1}, {0, -1}, {1, -1}, {-1, 0},
+	                                     {1, 0},   {-1, 1}, {0, 1},  {1, 1}};
+	return offsets[direction];
+}
+
+int FlightLaneGraph::getNodeIndex(int lane, int sectorX, int sectorY) const
+{
+	return (lane * this->sectorCount.y + sectorY) * this->sectorCount.x + sectorX;
+}
+
+Vec3<int> FlightLaneGraph::getNodePosition(int node) const
+{
+	int sectorX = node % this->sectorCount.x;
+	int sectorY = (node / this->sectorCount.x) % this->sectorCount.y;
+	int lane = node / (this->sectorCount.x * this->sectorCount.y);
+	return {std::min(sectorX * SECTOR_SIZE + SECTOR_SIZE / 2, map.size.x - 1),
+	        std::min(sectorY * SECTOR_SIZE + SECTOR_SIZE / 2, map.size.y - 1), this->lanes[lane]};
+}
+
+bool FlightLaneGraph::tileBlocked(Vec3<int> position) const
+{
+	// Same as FlyingVehicleTileHelper, landing pads are the only scenery that can be flown through
+	for (auto &obj : this->map.getTile(position)->ownedObjects)
+	{
+		if (obj->getType() != TileObject::Type::Scenery)
+			continue;
+		auto sceneryTile = std::static_pointer_cast<TileObjectScenery>(obj);
+		auto scenery = sceneryTile->scenery.lock();
+		if (scenery && scenery->type->isLandingPad)
+			continue;
+		return true;
+	}
+	return false;
+}
+
+bool FlightLaneGraph::lineClear(Vec3<int> from, Vec3<int> to) const
+{
+	auto position = from;
+	while (position != to)
+	{
+		position.x += (to.x > position.x) - (to.x < position.x);
+		position.y += (to.y > position.y) - (to.y < position.y);
+		position.z += (to.z > position.z) - (to.z < position.z);
+		if (this->tileBlocked(position))
+			return false;
+	}
+	return true;
+}
+
+void FlightLaneGraph::invalidate(Vec3<int> position)
+{
+	int sectorX = clamp(position.x / SECTOR_SIZE, 0, this->sectorCount.x - 1);
+	int sectorY = clamp(position.y / SECTOR_SIZE, 0, this->sectorCount.y - 1);
+	this->sectorDirty[sectorY * this->sectorCount.x + sectorX] = true;
+	this->anySectorDirty = true;
+}
+
+void FlightLaneGraph::update()
+{
+	if (!this->anySectorDirty)
+		return;
+	TRACE_FN;
+	// Edges cross into the neighbouring sectors, so rebuild all the nodes first
+	for (int y = 0; y < this->sectorCount.y; y++)
+	{
+		for (int x = 0; x < this->sectorCount.x; x++)
+		{
+			if (this->sectorDirty[y * this->sectorCount.x + x])
+				this->buildSector(x, y);
+		}
+	}
+	for (int y = 0; y < this->sectorCount.y; y++)
+	{
+		for (int x = 0; x < this->sectorCount.x; x++)
+		{
+			if (this->sectorDirty[y * this->sectorCount.x + x])
+				this->buildSectorEdges(x, y);
+		}
+	}
+	std::fill(this->sectorDirty.begin(), this->sectorDirty.end(), false);
+	this->anySectorDirty = false;
+}
+
+void FlightLaneGraph::buildSector(int sectorX, int sectorY)
+{
+	for (int lane = 0; lane < (int)this->lanes.size(); lane++)
+	{
+		int node = this->getNodeIndex(lane, sectorX, sectorY);
+		this->nodeOpen[node] = !this->tileBlocked(this->getNodePosition(node));
+	}
+}
+
+void FlightLaneGraph::buildSectorEdges(int sectorX, int sectorY)
+{
+	for (int lane = 0; lane < (int)this->lanes.size(); lane++)
+	{
+		int node = this->getNodeIndex(lane, sectorX, sectorY);
+		auto position = this->getNodePosition(node);
+		uint16_t edges = 0;
+		for (int direction = 0; direction < 8; direction++)
+		{
+			auto offset = getNeighbourOffset(direction);
+			int otherX = sectorX + offset.x;
+			int otherY = sectorY + offset.y;
+			if (otherX < 0 || otherX >= this->sectorCount.x || otherY < 0 ||
+			    otherY >= this->sectorCount.y)
+				continue;
+			int other = this->getNodeIndex(lane, otherX, otherY);
+			// Directions are ordered so the opposite of 'direction' is '7 - direction'
+			uint16_t reverseEdge = 1 << (7 - direction);
+			if (this->nodeOpen[node] && this->nodeOpen[other] &&
+			    this->lineClear(position, this->getNodePosition(other)))
+			{
+				edges |= 1 << direction;
+				this->nodeEdges[other] |= reverseEdge;
+			}
+			else
+			{
+				this->nodeEdges[other] &= ~reverseEdge;
+			}
+		}
+		if (lane + 1 < (int)this->lanes.size())
+		{
+			int other = this->getNodeIndex(lane + 1, sectorX, sectorY);
+			if (this->nodeOpen[node] && this->nodeOpen[other] &&
+			    this->lineClear(position, this->getNodePosition(other)))
+			{
+				edges |= LaneUp;
+			}
+		}
+		if (lane > 0)
+		{
+			int other = this->getNodeIndex(lane - 1, sectorX, sectorY);
+			if (this->nodeOpen[node] && this->nodeOpen[other] &&
+			    this->lineClear(position, this->getNodePosition(other)))
+			{
+				edges |= LaneDown;
+			}
+		}
+		this->nodeEdges[node] = edges;
+	}
+}
+
+int FlightLaneGraph::findNode(Vec3<int> position, int preferredAltitude) const
+{
+	int sectorX = clamp(position.x / SECTOR_SIZE, 0, this->sectorCount.x - 1);
+	int sectorY = clamp(position.y / SECTOR_SIZE, 0, this->sectorCount.y - 1);
+	int closestNode = -1;
+	int closestDistance = std::numeric_limits<int>::max();
+	for (int lane = 0; lane < (int)this->lanes.size(); lane++)
+	{
+		int node = this->getNodeIndex(lane, sectorX, sectorY);
+		int distance = std::abs(this->lanes[lane] - preferredAltitude);
+		if (this->nodeOpen[node] && this->nodeEdges[node] != 0 && distance < closestDistance)
+		{
+			closestNode = node;
+			closestDistance = distance;
+		}
+	}
+	return closestNode;
+}
+
+std::vector<int> FlightLaneGraph::findNodePath(int startNode, int endNode) const
+{
+	using QueueEntry = std::pair<float, int>;
+	std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry>> fringe;
+	std::vector<float> costs(this->nodeOpen.size(), std::numeric_limits<float>::max());
+	std::vector<int> parents(this->nodeOpen.size(), -1);
+	std::vector<bool> expanded(this->nodeOpen.size(), false);
+	Vec3<float> goal{this->getNodePosition(endNode)};
+	int sectorsPerLane = this->sectorCount.x * this->sectorCount.y;
+
+	costs[startNode] = 0.0f;
+	fringe.emplace(glm::length(Vec3<float>{this->getNodePosition(startNode)} - goal), startNode);
+	while (!fringe.empty())
+	{
+		auto node = fringe.top().second;
+		fringe.pop();
+		if (node == endNode)
+			break;
+		if (expanded[node])
+			continue;
+		expanded[node] = true;
+		Vec3<float> position{this->getNodePosition(node)};
+		for (int edge = 0; edge < 10; edge++)
+		{
+			if (!(this->nodeEdges[node] & (1 << edge)))
+				continue;
+			int other;
+			if (edge < 8)
+			{
+				auto offset = getNeighbourOffset(edge);
+				other = node + offset.y * this->sectorCount.x + offset.x;
+			}
+			else
+			{
+				other = (edge == 8) ? node + sectorsPerLane : node - sectorsPerLane;
+			}
+			Vec3<float> otherPosition{this->getNodePosition(other)};
+			float cost = costs[node] + glm::length(otherPosition - position);
+			if (cost < costs[other])
+			{
+				costs[other] = cost;
+				parents[other] = node;
+				fringe.emplace(cost + glm::length(goal - otherPosition), other);
+			}
+		}
+	}
+	std::vector<int> nodePath;
+	if (parents[endNode] == -1 && startNode != endNode)
+		return nodePath;
+	for (int node = endNode; node != -1; node = parents[node])
+	{
+		nodePath.push_back(node);
+	}
+	std::reverse(nodePath.begin(), nodePath.end());
+	return nodePath;
+}
+
+std::list<Vec3<int>> FlightLaneGraph::findPath(Vec3<int> origin, Vec3<int> target,
+                                               int preferredAltitude, unsigned int iterationLimit,
+                                               const CanEnterTileHelper &canEnterTile) const
+{
+	// Not worth it for short trips, the tile search will be just as quick
+	if (std::abs(origin.x - target.x) < 2 * SECTOR_SIZE &&
+	    std::abs(origin.y - target.y) < 2 * SECTOR_SIZE)
+	{
+		return this->map.findShortestPath(origin, target, iterationLimit, canEnterTile);
+	}
+	int startNode = this->findNode(origin, preferredAltitude);
+	int endNode = this->findNode(target, preferredAltitude);
+	if (startNode == -1 || endNode == -1)
+	{
+		return this->map.findShortestPath(origin, target, iterationLimit, canEnterTile);
+	}
+	auto nodePath = this->findNodePath(startNode, endNode);
+	if (nodePath.empty())
+	{
+		return this->map.findShortestPath(origin, target, iterationLimit, canEnterTile);
+	}
+
+	auto startPosition = this->getNodePosition(startNode);
+	auto path = this->map.findShortestPath(origin, startPosition, iterationLimit, canEnterTile);
+	if (path.empty() || path.back() != startPosition)
+	{
+		// Couldn't get onto the lane (something in the way?), so do it the slow way
+		return this->map.findShortestPath(origin, target, iterationLimit, canEnterTile);
+	}
+	for (size_t i = 1; i < nodePath.size(); i++)
+	{
+		auto position = this->getNodePosition(nodePath[i - 1]);
+		auto nextPosition = this->getNodePosition(nodePath[i]);
+		while (position != nextPosition)
+		{
+			position.x += (nextPosition.x > position.x) - (nextPosition.x < position.x);
+			position.y += (nextPosition.y > position.y) - (nextPosition.y < position.y);
+			position.z += (nextPosition.z > position.z) - (nextPosition.z < position.z);
+			path.push_back(position);
+		}
+	}
+	auto endPath = this->map.findShortestPath(path.back(), target, iterationLimit, canEnterTile);
+	if ((endPath.empty() ? path.back() : endPath.back()) != target)
+	{
+		// Couldn't get off the lane to the target, so that's the slow way too
+		return this->map.findShortestPath(origin, target, iterationLimit, canEnterTile);
+	}
+	// The end path starts at the lane node, which is already in the path
+	if (!endPath.empty())
+		endPath.pop_front();
+	path.splice(path.end(), endPath);
+	return path;
+}
+
+}; // namespace OpenApoc
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "library/vec.h"
+#include <cstdint>
+#include <list>
+#include <vector>
+
+namespace OpenApoc
+{
+
+class TileMap;
+class CanEnterTileHelper;
+
+// A coarse navigation graph over the open sky of a city, used to route vehicles over long
+// distances without searching every tile on the way.
+// The map is split into SECTOR_SIZE x SECTOR_SIZE sectors, and each sector gets a node at the
+// centre of each altitude lane. Nodes are linked to the same lane in the 8 neighbouring sectors,
+// and to the lanes above and below, wherever every tile in between is free of scenery.
+// Vehicles are ignored, as they move - paths are still checked tile by tile as they are followed.
+class FlightLaneGraph
+{
+  public:
+	static const int SECTOR_SIZE = 5;
+
+	FlightLaneGraph(TileMap &map, const std::vector<int> &laneAltitudes);
+
+	// Marks the sector containing 'position' to be rebuilt, call when scenery there changes
+	void invalidate(Vec3<int> position);
+	// Rebuilds any invalidated sectors. This reads the tile map so must not run at the same time
+	// as anything changing it, or alongside findPath()
+	void update();
+
+	// Returns a path in the same form as TileMap::findShortestPath(). The route between the lanes
+	// nearest to 'origin' and 'target' comes from the graph, and only the ends are searched tile
+	// by tile. Short routes, or ones the graph can't help with, fall back to a full tile search.
+	std::list<Vec3<int>> findPath(Vec3<int> origin, Vec3<int> target, int preferredAltitude,
+	                              unsigned int iterationLimit,
+	                              const CanEnterTileHelper &canEnterTile) const;
+
+  private:
+	enum Edge : uint16_t
+	{
+		// Bits 0-7 are the horizontal neighbours, in the order of getNeighbourOffset()
+		LaneUp = 1 << 8,
+		LaneDown = 1 << 9,
+	};
+
+	TileMap &map;
+	std::vector<int> lanes;
+	Vec2<int> sectorCount;
+	std::vector<bool> nodeOpen;
+	std::vector<uint16_t> nodeEdges;
+	std::vector<bool> sectorDirty;
+	bool anySectorDirty = false;
+
+	static Vec2<int> getNeighbourOffset(int direction);
+	int getNodeIndex(int lane, int sectorX, int sectorY) const;
+	Vec3<int> getNodePosition(int node) const;
+	bool tileBlocked(Vec3<int> position) const;
+	// Returns true if every tile moving from 'from' to 'to' one step at a time is unblocked
+	bool lineClear(Vec3<int> from, Vec3<int> to) const;
+	void buildSector(int sectorX, int sectorY);
+	void buildSectorEdges(int sectorX, int sectorY);
+	// Returns the open node closest to 'preferredAltitude' in the sector containing 'position',
+	// or -1 if there is none
+	int findNode(Vec3<int> position, int preferredAltitude) const;
+	std::vector<int> findNodePath(int startNode, int endNode) const;
+};
+
+}; // namespace OpenApoc
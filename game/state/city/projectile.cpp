@@ -146,28 +146,33 @@ void Projectile::update(GameState &state, unsigned int ticks)
 	}
 }
 
-Collision Projectile::checkProjectileCollision(TileMap &map)
+sp<TileObject> Projectile::getIgnoredObject()
 {
-	if (!this->tileObject)
-	{
-		// It's possible the projectile reached the end of it's lifetime this frame
-		// so ignore stuff without a tile
-		return {};
-	}
-
-	sp<TileObject> ignoredObject = nullptr;
 	if (ownerInvulnerableTicks > 0)
 	{
 		if (firerVehicle)
 		{
-			ignoredObject = firerVehicle->tileObject;
+			return firerVehicle->tileObject;
 		}
 		else if (firerUnit)
 		{
-			ignoredObject = firerUnit->tileObject;
+			return firerUnit->tileObject;
 		}
 	}
-	Collision c = map.findCollision(this->previousPosition, this->position, {}, ignoredObject);
+	return nullptr;
+}
+
+Collision Projectile::checkProjectileCollision(TileMap &map)
+{
+	if (!this->tileObject)
+	{
+		// It's possible the projectile reached the end of it's lifetime this frame
+		// so ignore stuff without a tile
+		return {};
+	}
+
+	Collision c =
+	    map.findCollision(this->previousPosition, this->position, {}, this->getIgnoredObject());
 	if (!c)
 		return {};
 
@@ -67,6 +67,8 @@ class Projectile : public std::enable_shared_from_this<Projectile>
 	int getDamage() const { return this->damage; }
 	Vec3<float> getPosition() const { return this->position; }
 
+	// The object the projectile can't hit yet, as it's only just left it
+	sp<TileObject> getIgnoredObject();
 	Collision checkProjectileCollision(TileMap &map);
 
 	virtual ~Projectile();
@@ -74,6 +76,8 @@ class Projectile : public std::enable_shared_from_this<Projectile>
 	sp<TileObjectProjectile> tileObject;
 
 	Type type;
+	// Order the projectile was fired in, projectiles are always updated in this order
+	uint64_t sequence = 0;
 	Vec3<float> position;
 	Vec3<float> velocity;
 	int turnRate = 0;
@@ -0,0 +1,106 @@
+#include "game/state/city/projectilebatch.h"
+#include "framework/data.h"
+#include "framework/framework.h"
+#include "framework/trace.h"
+#include "game/state/city/projectile.h"
+#include "game/state/tileview/tile.h"
+#include "game/state/tileview/tileobject_projectile.h"
+#include <algorithm>
+
+namespace OpenApoc
+{
+
+static bool firedBefore(const sp<Projectile> &a, const sp<Projectile> &b)
+{
+	return a->sequence < b->sequence;
+}
+
+void ProjectileBatch::castSegments(TileMap &map, size_t first, size_t last)
+{
+	for (size_t i = first; i < last; i++)
+	{
+		this->hits[i] = map.findCollision(this->segmentStart[i], this->segmentEnd[i], {},
+		                                  this->ignoredObject[i]);
+	}
+}
+
+void ProjectileBatch::update(GameState &state, TileMap &map,
+                             std::set<sp<Projectile>> &projectiles, unsigned int ticks,
+                             std::function<void(Collision &)> handleCollision)
+{
+	if (projectiles.empty())
+		return;
+	TRACE_FN_ARGS1("count", Strings::fromInteger((int)projectiles.size()));
+
+	this->active.assign(projectiles.begin(), projectiles.end());
+	std::sort(this->active.begin(), this->active.end(), firedBefore);
+
+	// Moving changes the map, so has to be done here rather than alongside the casts
+	for (auto &p : this->active)
+	{
+		p->update(state, ticks);
+	}
+	// Projectiles that reached the end of their life have already removed themselves
+	this->active.erase(std::remove_if(this->active.begin(), this->active.end(),
+	                                  [](const sp<Projectile> &p) { return !p->tileObject; }),
+	                   this->active.end());
+
+	auto count = this->active.size();
+	this->segmentStart.resize(count);
+	this->segmentEnd.resize(count);
+	this->ignoredObject.resize(count);
+	this->hits.assign(count, {});
+	for (size_t i = 0; i < count; i++)
+	{
+		auto &p = this->active[i];
+		this->segmentStart[i] = p->previousPosition;
+		this->segmentEnd[i] = p->position;
+		this->ignoredObject[i] = p->getIgnoredObject();
+	}
+
+	// Nothing changes the map while the casts run, so they can safely share it
+	if (count <= (size_t)PROJECTILES_PER_TASK)
+	{
+		this->castSegments(map, 0, count);
+	}
+	else
+	{
+		std::vector<std::function<void()>> casts;
+		for (size_t first = 0; first < count; first += PROJECTILES_PER_TASK)
+		{
+			auto last = std::min(count, first + PROJECTILES_PER_TASK);
+			casts.push_back([this, &map, first, last]() { this->castSegments(map, first, last); });
+		}
+		// wait() runs any casts no pool thread has picked up itself, so this can't deadlock when
+		// the update is already running on the pool
+		fw().data->prefetch(std::move(casts))->wait();
+	}
+
+	for (size_t i = 0; i < count; i++)
+	{
+		if (!this->hits[i])
+			continue;
+		auto &p = this->active[i];
+		auto c = this->hits[i];
+		if (!c.obj->getOwningTile())
+		{
+			// A collision handled earlier this tick destroyed what this one hit, so see if it
+			// carries on to hit something else
+			c = p->checkProjectileCollision(map);
+			if (!c)
+				continue;
+		}
+		// Handling an earlier collision may have already got rid of this projectile
+		if (projectiles.erase(p) == 0)
+			continue;
+		c.projectile = p;
+		handleCollision(c);
+	}
+
+	// Keep the storage, but don't hold on to anything that's been removed
+	this->active.clear();
+	this->ignoredObject.clear();
+	this->hits.clear();
+}
+
+}; // namespace OpenApoc
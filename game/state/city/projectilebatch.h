@@ -0,0 +1,44 @@
+#pragma once
+
+#include "game/state/tileview/collision.h"
+#include "library/sp.h"
+#include "library/vec.h"
+#include <functional>
+#include <set>
+#include <vector>
+
+namespace OpenApoc
+{
+
+class GameState;
+class Projectile;
+class TileMap;
+class TileObject;
+
+// Steps all the projectiles of a city or battle at once.
+// Projectiles are gathered into flat arrays in the order they were fired (so the result doesn't
+// depend on where they happen to live in memory), moved, and then have the segments they moved
+// along cast against the map in parallel. Collisions are then handled one at a time in firing
+// order. The arrays are kept between updates, so a busy firefight doesn't reallocate every tick.
+class ProjectileBatch
+{
+  public:
+	// Below this many projectiles the casts aren't worth handing to the thread pool
+	static const int PROJECTILES_PER_TASK = 32;
+
+	// Moves every projectile in 'projectiles' on by 'ticks' and calls 'handleCollision' for each
+	// one that hit something. Projectiles that hit are removed from 'projectiles' first.
+	void update(GameState &state, TileMap &map, std::set<sp<Projectile>> &projectiles,
+	            unsigned int ticks, std::function<void(Collision &)> handleCollision);
+
+  private:
+	std::vector<sp<Projectile>> active;
+	std::vector<Vec3<float>> segmentStart;
+	std::vector<Vec3<float>> segmentEnd;
+	std::vector<sp<TileObject>> ignoredObject;
+	std::vector<Collision> hits;
+
+	void castSegments(TileMap &map, size_t first, size_t last);
+};
+
+}; // namespace OpenApoc
@@ -2,6 +2,7 @@
 #include "framework/logger.h"
 #include "game/state/city/city.h"
 #include "game/state/city/doodad.h"
+#include "game/state/city/flightlanegraph.h"
 #include "game/state/gamestate.h"
 #include "game/state/rules/scenery_tile_type.h"
 #include "game/state/tileview/tile.h"
@@ -43,6 +44,7 @@ void Scenery::handleCollision(GameState &state, Collision &c)
 		// Don't destroy bottom tiles, else everything will leak out
 		if (this->initialPosition.z != 1)
 		{
+			this->city->flightLanes->invalidate(this->initialPosition);
 			this->tileObject->removeFromMap();
 			this->tileObject.reset();
 		}
@@ -64,6 +66,8 @@ void Scenery::collapse(GameState &state)
 	if (this->type->isLandingPad)
 		return;
 	this->falling = true;
+	this->city->activeScenery.push_back(shared_from_this());
+	this->city->flightLanes->invalidate(this->initialPosition);
 
 	for (auto &s : this->supports)
 		s->collapse(state);
@@ -100,6 +104,7 @@ void Scenery::update(GameState &state, unsigned int ticks)
 				this->falling = false;
 				auto doodad = city->placeDoodad(StateRef<DoodadType>{&state, "DOODAD_EXPLOSION_3"},
 				                                currentPos);
+				this->city->flightLanes->invalidate(this->initialPosition);
 				this->tileObject->removeFromMap();
 				this->tileObject.reset();
 				if (this->overlayDoodad)
@@ -158,6 +163,7 @@ void Scenery::repair(GameState &state)
 		this->overlayDoodad->remove(state);
 	this->overlayDoodad = nullptr;
 	map->addObjectToMap(shared_from_this());
+	this->city->flightLanes->invalidate(this->initialPosition);
 	if (type->overlaySprite)
 	{
 		this->overlayDoodad =
@@ -3,6 +3,7 @@
 #include "game/state/city/building.h"
 #include "game/state/city/city.h"
 #include "game/state/city/projectile.h"
+#include "game/state/city/vehiclegrid.h"
 #include "game/state/city/vehiclemission.h"
 #include "game/state/city/vequipment.h"
 #include "game/state/gamestate.h"
@@ -45,6 +46,9 @@ const UString &Vehicle::getId(const GameState &state, const sp<Vehicle> ptr)
 	return emptyString;
 }
 
+// Vehicles with a hostile this close are always simulated exactly, even in turbo
+static const float FAST_FORWARD_SAFE_RANGE = 32 * VELOCITY_SCALE_CITY.x;
+
 class FlyingVehicleMover : public VehicleMover
 {
   public:
@@ -53,8 +57,75 @@ class FlyingVehicleMover : public VehicleMover
 	    : VehicleMover(v), goalPosition(initialGoal)
 	{
 	}
+	// Moves the vehicle along its planned path, only updating the tile map once at the end.
+	// This skips the per-step collision and path shortcut checks, so is only used when nothing
+	// nearby can interrupt the route.
+	// It stops short of the last node, or of any node it can no longer fly on from, and leaves
+	// that to the normal update, so the mission finishes (or re-routes) exactly as it would
+	// otherwise. Returns the ticks that were not used.
+	unsigned int fastForward(unsigned int ticks)
+	{
+		static const Vec3<float> offset{0.5f, 0.5f, 0.5f};
+
+		auto &path = vehicle.missions.front()->currentPlannedPath;
+		if (path.empty() ||
+		    goalPosition != Vec3<float>{path.front().x, path.front().y, path.front().z} + offset)
+		{
+			return ticks;
+		}
+		float speed = vehicle.getSpeed();
+		if (speed <= 0)
+		{
+			return ticks;
+		}
+		float distanceLeft = speed * ticks;
+		distanceLeft /= TICK_SCALE;
+		auto position = vehicle.getPosition();
+		auto dir = vehicle.tileObject->getDirection();
+		while (true)
+		{
+			Vec3<float> vectorToGoal = goalPosition - position;
+			float distanceToGoal = glm::length(vectorToGoal * VELOCITY_SCALE_CITY);
+			if (distanceToGoal > 0)
+			{
+				dir = glm::normalize(vectorToGoal);
+			}
+			if (distanceToGoal > distanceLeft)
+			{
+				position += distanceLeft * dir / VELOCITY_SCALE_CITY;
+				distanceLeft = 0;
+				break;
+			}
+			// Arriving at the goal is left to the normal update if it's the last node, or if the
+			// step after it has become impassable (so advanceAlongPath() picks a new path)
+			auto next = ++path.begin();
+			if (path.size() <= 2 ||
+			    !VehicleMission::canStepBetween(vehicle, path.front(), *next))
+			{
+				break;
+			}
+			distanceLeft -= distanceToGoal;
+			position = goalPosition;
+			path.pop_front();
+			goalPosition = Vec3<float>{path.front().x, path.front().y, path.front().z} + offset;
+		}
+		if (position != vehicle.getPosition())
+		{
+			vehicle.setPosition(position);
+			vehicle.tileObject->setDirection(dir);
+		}
+		return static_cast<unsigned int>(distanceLeft * TICK_SCALE / speed);
+	}
 	void update(GameState &state, unsigned int ticks) override
 	{
+		if (state.turboUpdate && vehicle.canFastForward())
+		{
+			ticks = fastForward(ticks);
+			if (ticks == 0)
+			{
+				return;
+			}
+		}
 		float speed = vehicle.getSpeed();
 		if (!vehicle.missions.empty())
 		{
@@ -161,6 +232,7 @@ void Vehicle::launch(TileMap &map, GameState &state, Vec3<float> initialPosition
 	this->position = initialPosition;
 	this->mover.reset(new FlyingVehicleMover(*this, initialPosition));
 	map.addObjectToMap(shared_from_this());
+	this->city->vehicleGrid->update(shared_from_this());
 }
 
 void Vehicle::land(GameState &state, StateRef<Building> b)
@@ -178,6 +250,7 @@ void Vehicle::land(GameState &state, StateRef<Building> b)
 	}
 	this->currentlyLandedBuilding = b;
 	b->landed_vehicles.insert({&state, shared_from_this()});
+	this->city->vehicleGrid->remove(*this);
 	this->tileObject->removeFromMap();
 	this->tileObject.reset();
 	this->shadowObject->removeFromMap();
@@ -271,7 +344,7 @@ void Vehicle::update(GameState &state, unsigned int ticks)
 			}
 			else
 			{
-				enemy = findClosestEnemy(state, vehicleTile);
+				enemy = findClosestEnemy(getFiringRange());
 			}
 
 			if (enemy)
@@ -297,6 +370,35 @@ void Vehicle::update(GameState &state, unsigned int ticks)
 	}
 }
 
+bool Vehicle::canFastForward() const
+{
+	if (!this->tileObject || !this->mover || this->isCrashed() || this->missions.empty())
+	{
+		return false;
+	}
+	if (this->missions.front()->type != VehicleMission::MissionType::GotoLocation)
+	{
+		return false;
+	}
+	for (auto &mission : this->missions)
+	{
+		switch (mission->type)
+		{
+			case VehicleMission::MissionType::GotoLocation:
+			case VehicleMission::MissionType::GotoBuilding:
+			case VehicleMission::MissionType::Snooze:
+				break;
+			default:
+				return false;
+		}
+	}
+	if (!this->city->projectiles.empty())
+	{
+		return false;
+	}
+	return !this->city->vehicleGrid->findClosestHostile(*this, FAST_FORWARD_SAFE_RANGE);
+}
+
 bool Vehicle::isCrashed() const { return this->health < this->type->crash_health; }
 /* // Test code to make UFOs crash immediately upon hit,
 // may be useful in the future as crashing is not yet perfect
@@ -404,6 +506,7 @@ void Vehicle::handleCollision(GameState &state, Collision &c)
 			auto doodad = city->placeDoodad(StateRef<DoodadType>{&state, "DOODAD_3_EXPLOSION"},
 			                                this->tileObject->getCenter());
 
+			this->city->vehicleGrid->remove(*this);
 			this->shadowObject->removeFromMap();
 			this->tileObject->removeFromMap();
 			this->shadowObject.reset();
@@ -414,50 +517,15 @@ void Vehicle::handleCollision(GameState &state, Collision &c)
 	}
 }
 
-sp<TileObjectVehicle> Vehicle::findClosestEnemy(GameState &state, sp<TileObjectVehicle> vehicleTile)
+sp<TileObjectVehicle> Vehicle::findClosestEnemy(float range)
 {
 	// Find the closest enemy within the firing arc
-	float closestEnemyRange = std::numeric_limits<float>::max();
-	sp<TileObjectVehicle> closestEnemy;
-	for (auto &pair : state.vehicles)
+	auto closestEnemy = this->city->vehicleGrid->findClosestHostile(*this, range);
+	if (!closestEnemy)
 	{
-		auto otherVehicle = pair.second;
-		if (otherVehicle.get() == this)
-		{
-			/* Can't fire at yourself */
-			continue;
-		}
-		if (otherVehicle->isCrashed())
-		{
-			// Can't fire at crashed vehicles
-			continue;
-		}
-		if (otherVehicle->city != this->city)
-		{
-			/* Can't fire on things a world away */
-			continue;
-		}
-		if (this->owner->isRelatedTo(otherVehicle->owner) != Organisation::Relation::Hostile)
-		{
-			/* Not hostile, skip */
-			continue;
-		}
-		auto otherVehicleTile = otherVehicle->tileObject;
-		if (!otherVehicleTile)
-		{
-			/* Not in the map, ignore */
-			continue;
-		}
-		float distance = vehicleTile->getDistanceTo(otherVehicleTile);
-
-		// FIXME: Check weapon arc against otherVehicle
-		if (distance < closestEnemyRange)
-		{
-			closestEnemyRange = distance;
-			closestEnemy = otherVehicleTile;
-		}
+		return nullptr;
 	}
-	return closestEnemy;
+	return closestEnemy->tileObject;
 }
 
 void Vehicle::attackTarget(GameState &state, sp<TileObjectVehicle> vehicleTile,
@@ -488,6 +556,7 @@ void Vehicle::attackTarget(GameState &state, sp<TileObjectVehicle> vehicleTile,
 		auto projectile = equipment->fire(target, {&state, enemyTile->getVehicle()});
 		if (projectile)
 		{
+			projectile->sequence = getNextObjectID(state, "PROJECTILE_");
 			vehicleTile->map.addObjectToMap(projectile);
 			this->city->projectiles.insert(projectile);
 		}
@@ -535,6 +604,7 @@ void Vehicle::setPosition(const Vec3<float> &pos)
 	else
 	{
 		this->tileObject->setPosition(pos);
+		this->city->vehicleGrid->update(shared_from_this());
 	}
 
 	if (!this->shadowObject)
@@ -4,6 +4,7 @@
 #include "library/sp.h"
 #include "library/strings.h"
 #include "library/vec.h"
+#include <limits>
 #include <list>
 #include <map>
 
@@ -25,6 +26,7 @@ class VehicleType;
 class City;
 class TileMap;
 class Collision;
+class VehicleGrid;
 
 class VehicleMover
 {
@@ -82,6 +84,10 @@ class Vehicle : public StateObject, public std::enable_shared_from_this<Vehicle>
 
 	up<VehicleMover> mover;
 
+	// The city grid this vehicle is currently indexed in, see VehicleGrid
+	wp<VehicleGrid> indexedGrid;
+	int indexedCell = -1;
+
 	/* 'launch' the vehicle into the city */
 	void launch(TileMap &map, GameState &state, Vec3<float> initialPosition);
 	/* 'land' the vehicle in a building*/
@@ -94,9 +100,12 @@ class Vehicle : public StateObject, public std::enable_shared_from_this<Vehicle>
 	void removeEquipment(sp<VEquipment> object);
 
 	bool isCrashed() const;
+	// True if the vehicle is just flying along a route with nothing around that could interrupt
+	// it, so turbo can move it along the whole path at once
+	bool canFastForward() const;
 	bool applyDamage(GameState &state, int damage, float armour);
 	void handleCollision(GameState &state, Collision &c);
-	sp<TileObjectVehicle> findClosestEnemy(GameState &state, sp<TileObjectVehicle> vehicleTile);
+	sp<TileObjectVehicle> findClosestEnemy(float range = std::numeric_limits<float>::max());
 	void attackTarget(GameState &state, sp<TileObjectVehicle> vehicleTile,
 	                  sp<TileObjectVehicle> enemyTile);
 	float getFiringRange() const;
@@ -0,0 +1,176 @@
+#include "game/state/city/vehiclegrid.h"
+#include "framework/logger.h"
+#include "game/state/city/vehicle.h"
+#include "game/state/organisation.h"
+#include "game/state/tileview/tileobject_vehicle.h"
+#include <algorithm>
+#include <cmath>
+
+namespace OpenApoc
+{
+
+VehicleGrid::VehicleGrid(Vec3<int> mapSize, Vec3<float> velocityScale)
+    : cellCount((mapSize.x + CELL_SIZE - 1) / CELL_SIZE, (mapSize.y + CELL_SIZE - 1) / CELL_SIZE),
+      velocityScale(velocityScale)
+{
+	this->cells.resize(this->cellCount.x * this->cellCount.y);
+}
+
+int VehicleGrid::getCellIndex(Vec3<float> position) const
+{
+	int x = clamp((int)position.x / CELL_SIZE, 0, this->cellCount.x - 1);
+	int y = clamp((int)position.y / CELL_SIZE, 0, this->cellCount.y - 1);
+	return y * this->cellCount.x + x;
+}
+
+int VehicleGrid::getCellReach(float range) const
+{
+	int maxReach = std::max(this->cellCount.x, this->cellCount.y);
+	// Distances are measured between tile object centres, which can be up to a tile away from the
+	// position the vehicle was indexed at
+	float tiles = range / std::min(this->velocityScale.x, this->velocityScale.y) + 1.0f;
+	if (tiles >= (float)(maxReach * CELL_SIZE))
+		return maxReach;
+	return (int)ceilf(tiles / (float)CELL_SIZE);
+}
+
+void VehicleGrid::getCellVehicles(int x, int y, std::vector<sp<Vehicle>> &vehicles) const
+{
+	for (auto &entry : this->cells[y * this->cellCount.x + x])
+	{
+		auto vehicle = entry.lock();
+		if (vehicle && vehicle->tileObject)
+			vehicles.push_back(vehicle);
+	}
+}
+
+void VehicleGrid::update(sp<Vehicle> vehicle)
+{
+	auto cellIndex = this->getCellIndex(vehicle->position);
+	auto currentGrid = vehicle->indexedGrid.lock();
+	if (currentGrid.get() == this && vehicle->indexedCell == cellIndex)
+		return;
+	if (currentGrid)
+		currentGrid->remove(*vehicle);
+
+	auto &cell = this->cells[cellIndex];
+	// Vehicles destroyed without leaving the map leave expired entries behind, so clean them up
+	// whenever a cell is added to
+	cell.erase(std::remove_if(cell.begin(), cell.end(),
+	                          [](const wp<Vehicle> &entry) { return entry.expired(); }),
+	           cell.end());
+	cell.push_back(vehicle);
+	vehicle->indexedGrid = shared_from_this();
+	vehicle->indexedCell = cellIndex;
+}
+
+void VehicleGrid::remove(Vehicle &vehicle)
+{
+	if (vehicle.indexedGrid.lock().get() != this)
+	{
+		LogError("Vehicle \"%s\" is not in this grid", vehicle.name);
+		return;
+	}
+	auto &cell = this->cells[vehicle.indexedCell];
+	for (auto it = cell.begin(); it != cell.end();)
+	{
+		auto v = it->lock();
+		if (!v || v.get() == &vehicle)
+			it = cell.erase(it);
+		else
+			++it;
+	}
+	vehicle.indexedGrid.reset();
+	vehicle.indexedCell = -1;
+}
+
+std::vector<sp<Vehicle>> VehicleGrid::findInRadius(Vec3<float> position, float range) const
+{
+	std::vector<sp<Vehicle>> found;
+	std::vector<sp<Vehicle>> candidates;
+	int reach = this->getCellReach(range);
+	int cellX = clamp((int)position.x / CELL_SIZE, 0, this->cellCount.x - 1);
+	int cellY = clamp((int)position.y / CELL_SIZE, 0, this->cellCount.y - 1);
+	for (int y = std::max(0, cellY - reach); y <= std::min(this->cellCount.y - 1, cellY + reach);
+	     y++)
+	{
+		for (int x = std::max(0, cellX - reach);
+		     x <= std::min(this->cellCount.x - 1, cellX + reach); x++)
+		{
+			this->getCellVehicles(x, y, candidates);
+		}
+	}
+	for (auto &vehicle : candidates)
+	{
+		if (vehicle->tileObject->getDistanceTo(position) <= range)
+			found.push_back(vehicle);
+	}
+	return found;
+}
+
+sp<Vehicle> VehicleGrid::findClosestHostile(const Vehicle &vehicle, float range) const
+{
+	if (!vehicle.tileObject)
+	{
+		LogError("Vehicle \"%s\" not in the map", vehicle.name);
+		return nullptr;
+	}
+	auto position = vehicle.tileObject->getCenter();
+	int cellX = clamp((int)position.x / CELL_SIZE, 0, this->cellCount.x - 1);
+	int cellY = clamp((int)position.y / CELL_SIZE, 0, this->cellCount.y - 1);
+	int reach = this->getCellReach(range);
+	float minScale = std::min(this->velocityScale.x, this->velocityScale.y);
+
+	float closestRange = range;
+	sp<Vehicle> closest;
+	std::vector<sp<Vehicle>> candidates;
+	// Search outwards a ring of cells at a time, stopping once nothing in the next ring could be
+	// closer than what we've already found
+	for (int ring = 0; ring <= reach; ring++)
+	{
+		if (closest && closestRange <= (float)((ring - 1) * CELL_SIZE - 1) * minScale)
+			break;
+		candidates.clear();
+		for (int y = cellY - ring; y <= cellY + ring; y++)
+		{
+			if (y < 0 || y >= this->cellCount.y)
+				continue;
+			bool edgeRow = (y == cellY - ring || y == cellY + ring);
+			for (int x = cellX - ring; x <= cellX + ring; x += edgeRow ? 1 : 2 * ring)
+			{
+				if (x >= 0 && x < this->cellCount.x)
+					this->getCellVehicles(x, y, candidates);
+				if (ring == 0)
+					break;
+			}
+		}
+		for (auto &other : candidates)
+		{
+			if (other.get() == &vehicle)
+			{
+				/* Can't fire at yourself */
+				continue;
+			}
+			if (other->isCrashed())
+			{
+				// Can't fire at crashed vehicles
+				continue;
+			}
+			if (vehicle.owner->isRelatedTo(other->owner) != Organisation::Relation::Hostile)
+			{
+				/* Not hostile, skip */
+				continue;
+			}
+			float distance = vehicle.tileObject->getDistanceTo(other->tileObject);
+			// FIXME: Check weapon arc against other
+			if (distance < closestRange || (!closest && distance <= range))
+			{
+				closestRange = distance;
+				closest = other;
+			}
+		}
+	}
+	return closest;
+}
+
+}; // namespace OpenApoc
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "library/sp.h"
+#include "library/vec.h"
+#include <vector>
+
+namespace OpenApoc
+{
+
+class Vehicle;
+
+// A uniform grid over the city map holding every vehicle that is currently in the map, so
+// range and nearest-enemy queries only have to look at the vehicles in nearby cells.
+// Each cell covers CELL_SIZE x CELL_SIZE tiles and the full height of the map.
+// Vehicles are (re-)indexed by Vehicle::setPosition(), and removed when they leave the map.
+// Ranges are in the same units as TileObject::getDistanceTo().
+class VehicleGrid : public std::enable_shared_from_this<VehicleGrid>
+{
+  public:
+	static const int CELL_SIZE = 8;
+
+	VehicleGrid(Vec3<int> mapSize, Vec3<float> velocityScale);
+
+	void update(sp<Vehicle> vehicle);
+	void remove(Vehicle &vehicle);
+
+	// Returns all vehicles with their centre within 'range' of 'position'
+	std::vector<sp<Vehicle>> findInRadius(Vec3<float> position, float range) const;
+	// Returns the closest vehicle within 'range' that is hostile to 'vehicle' and not crashed
+	sp<Vehicle> findClosestHostile(const Vehicle &vehicle, float range) const;
+
+  private:
+	Vec2<int> cellCount;
+	Vec3<float> velocityScale;
+	std::vector<std::vector<wp<Vehicle>>> cells;
+
+	int getCellIndex(Vec3<float> position) const;
+	// The number of cells a query of 'range' has to look out from the centre cell
+	int getCellReach(float range) const;
+	// Appends the vehicles in cell x,y that are still alive and in the map to 'vehicles'
+	void getCellVehicles(int x, int y, std::vector<sp<Vehicle>> &vehicles) const;
+};
+
+}; // namespace OpenApoc
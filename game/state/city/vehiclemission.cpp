@@ -1,10 +1,15 @@
 #include "game/state/city/vehiclemission.h"
+#include "framework/data.h"
+#include "framework/framework.h"
 #include "framework/logger.h"
+#include "framework/trace.h"
 #include "game/state/city/building.h"
 #include "game/state/city/city.h"
 #include "game/state/city/doodad.h"
+#include "game/state/city/flightlanegraph.h"
 #include "game/state/city/scenery.h"
 #include "game/state/city/vehicle.h"
+#include "game/state/city/vehiclegrid.h"
 #include "game/state/gamestate.h"
 #include "game/state/rules/scenery_tile_type.h"
 #include "game/state/rules/vehicle_type.h"
@@ -14,6 +19,7 @@
 #include "game/state/tileview/tileobject_shadow.h"
 #include "game/state/tileview/tileobject_vehicle.h"
 #include "library/strings_format.h"
+#include <functional>
 #include <glm/glm.hpp>
 
 namespace OpenApoc
@@ -440,6 +446,10 @@ bool VehicleMission::getNextDestination(GameState &state, Vehicle &v, Vec3<float
 			return advanceAlongPath(state, dest, v);
 		}
 		case MissionType::Patrol:
+			if (this->pathRequest)
+			{
+				return false;
+			}
 			if (!advanceAlongPath(state, dest, v))
 			{
 				if (missionCounter == 0)
@@ -629,7 +639,7 @@ void VehicleMission::update(GameState &state, Vehicle &v, unsigned int ticks, bo
 			float range = v.getFiringRange();
 			if (v.tileObject && range > 0)
 			{
-				auto enemy = v.findClosestEnemy(state, v.tileObject);
+				auto enemy = v.findClosestEnemy();
 				if (enemy)
 				{
 					StateRef<Vehicle> vehicleRef(&state, enemy->getVehicle());
@@ -649,6 +659,7 @@ void VehicleMission::update(GameState &state, Vehicle &v, unsigned int ticks, bo
 				{
 					if (city.second != v.city.getSp())
 					{
+						v.city->vehicleGrid->remove(v);
 						v.shadowObject->removeFromMap();
 						v.tileObject->removeFromMap();
 						v.shadowObject.reset();
@@ -681,7 +692,7 @@ void VehicleMission::update(GameState &state, Vehicle &v, unsigned int ticks, bo
 		case MissionType::GotoLocation:
 		{
 			auto vTile = v.tileObject;
-			if (vTile && !finished && this->currentPlannedPath.empty())
+			if (vTile && !finished && this->currentPlannedPath.empty() && !this->pathRequest)
 			{
 				if (reRouteAttempts > 0)
 				{
@@ -756,7 +767,7 @@ bool VehicleMission::isFinishedInternal(GameState &, Vehicle &v)
 		case MissionType::Crash:
 		{
 			auto vTile = v.tileObject;
-			if (vTile && this->currentPlannedPath.empty() &&
+			if (vTile && this->currentPlannedPath.empty() && !this->pathRequest &&
 			    (pickNearest || vTile->getOwningTile()->position == this->targetLocation))
 				return true;
 			return false;
@@ -766,7 +777,8 @@ bool VehicleMission::isFinishedInternal(GameState &, Vehicle &v)
 			return missionCounter > 1;
 		}
 		case MissionType::Patrol:
-			return this->missionCounter == 0 && this->currentPlannedPath.empty();
+			return this->missionCounter == 0 && this->currentPlannedPath.empty() &&
+			       !this->pathRequest;
 		case MissionType::GotoBuilding:
 			return this->targetBuilding == v.currentlyLandedBuilding;
 		case MissionType::AttackVehicle:
@@ -1304,6 +1316,18 @@ void VehicleMission::setPathTo(GameState &state, Vehicle &v, Vec3<int> target, i
 			}
 		}
 
+		if (type == MissionType::GotoLocation || type == MissionType::Patrol)
+		{
+			// Not urgent, so let the city search for this along with everything else
+			auto request = mksp<VehiclePathRequest>();
+			request->vehicle = v.shared_from_this();
+			request->target = target;
+			request->maxIterations = maxIterations;
+			this->pathRequest = request;
+			v.city->pathRequests.push_back(request);
+			return;
+		}
+
 		auto path = map.findShortestPath(vehicleTile->getOwningTile()->position, target,
 		                                 maxIterations, FlyingVehicleTileHelper{map, v});
 
@@ -1320,6 +1344,101 @@ void VehicleMission::setPathTo(GameState &state, Vehicle &v, Vec3<int> target, i
 	}
 }
 
+void VehicleMission::processPathRequests(City &city)
+{
+	if (city.pathRequests.empty())
+	{
+		return;
+	}
+	TRACE_FN_ARGS1("requests",
+	               Strings::fromInteger(static_cast<int>(city.pathRequests.size())));
+
+	std::vector<sp<VehiclePathRequest>> requests;
+	// The mission each request is for, nothing changes the vehicles' missions until they're used
+	std::vector<VehicleMission *> missions;
+	for (auto &request : city.pathRequests)
+	{
+		auto v = request->vehicle.lock();
+		if (!v)
+		{
+			continue;
+		}
+		// Skip requests for missions that have since been removed or asked for another path
+		VehicleMission *requestMission = nullptr;
+		for (auto &mission : v->missions)
+		{
+			if (mission->pathRequest == request)
+			{
+				requestMission = mission.get();
+				break;
+			}
+		}
+		if (!requestMission)
+		{
+			continue;
+		}
+		if (!v->tileObject || v->city != &city)
+		{
+			// Dropped, so let the mission ask again once the vehicle's back on this map, rather
+			// than wait for a path that's never coming
+			requestMission->pathRequest = nullptr;
+			continue;
+		}
+		// The vehicle may have moved on from its last goal since the path was requested
+		request->origin = v->tileObject->getOwningTile()->position;
+		requests.push_back(request);
+		missions.push_back(requestMission);
+	}
+	city.pathRequests.clear();
+
+	// Nothing changes the map until all the searches are done, so they can safely share it
+	auto &map = *city.map;
+	auto &flightLanes = *city.flightLanes;
+	flightLanes.update();
+	std::vector<std::function<void()>> searches;
+	for (auto &request : requests)
+	{
+		searches.push_back([&map, &flightLanes, request]() {
+			auto v = request->vehicle.lock();
+			request->path = flightLanes.findPath(request->origin, request->target,
+			                                     static_cast<int>(v->altitude),
+			                                     request->maxIterations,
+			                                     FlyingVehicleTileHelper{map, *v});
+		});
+	}
+	// wait() runs any search no pool thread has started itself, so this is safe to call from a
+	// pool thread
+	fw().data->prefetch(std::move(searches))->wait();
+
+	for (size_t i = 0; i < requests.size(); i++)
+	{
+		auto &request = requests[i];
+		auto mission = missions[i];
+		mission->pathRequest = nullptr;
+		mission->currentPlannedPath.clear();
+		// Always start with the current position
+		mission->currentPlannedPath.push_back(request->origin);
+		for (auto &p : request->path)
+		{
+			mission->currentPlannedPath.push_back(p);
+		}
+	}
+}
+
+bool VehicleMission::canStepBetween(Vehicle &v, Vec3<int> from, Vec3<int> to)
+{
+	if (from == to)
+	{
+		return true;
+	}
+	if (std::abs(from.x - to.x) > 1 || std::abs(from.y - to.y) > 1 || std::abs(from.z - to.z) > 1)
+	{
+		return false;
+	}
+	auto &map = v.tileObject->map;
+	return FlyingVehicleTileHelper{map, v}.canEnterTile(map.getTile(from), map.getTile(to));
+}
+
 bool VehicleMission::advanceAlongPath(GameState &state, Vec3<float> &dest, Vehicle &v)
 {
 	// Add {0.5,0.5,0.5} to make it route to the center of the tile
@@ -1347,11 +1466,7 @@ bool VehicleMission::advanceAlongPath(GameState &state, Vec3<float> &dest, Vehic
 
 	// See if we can actually go there
 	auto tFrom = v.tileObject->getOwningTile();
-	auto tTo = tFrom->map.getTile(pos);
-	if (tFrom->position != pos &&
-	    (std::abs(tFrom->position.x - pos.x) > 1 || std::abs(tFrom->position.y - pos.y) > 1 ||
-	     std::abs(tFrom->position.z - pos.z) > 1 ||
-	     !FlyingVehicleTileHelper{tFrom->map, v}.canEnterTile(tFrom, tTo)))
+	if (!canStepBetween(v, tFrom->position, pos))
 	{
 		// Next tile became impassable, pick a new path
 		currentPlannedPath.clear();
@@ -1368,15 +1483,10 @@ bool VehicleMission::advanceAlongPath(GameState &state, Vec3<float> &dest, Vehic
 	// Start with position after next
 	// If next position has a node and we can go directly to that node
 	// Then update current position and iterator
-	while (it != currentPlannedPath.end() &&
-	       (tFrom->position == *it ||
-	        (std::abs(tFrom->position.x - it->x) <= 1 && std::abs(tFrom->position.y - it->y) <= 1 &&
-	         std::abs(tFrom->position.z - it->z) <= 1 &&
-	         FlyingVehicleTileHelper{tFrom->map, v}.canEnterTile(tFrom, tFrom->map.getTile(*it)))))
+	while (it != currentPlannedPath.end() && canStepBetween(v, tFrom->position, *it))
 	{
 		currentPlannedPath.pop_front();
 		pos = currentPlannedPath.front();
-		tTo = tFrom->map.getTile(pos);
 		it = ++currentPlannedPath.begin();
 	}
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "game/state/stateobject.h"
+#include "library/sp.h"
 #include "library/strings.h"
 #include "library/vec.h"
 #include <list>
@@ -14,6 +15,22 @@ class Tile;
 class TileMap;
 class Building;
 class UString;
+class City;
+class VehicleMission;
+
+// A route search queued by VehicleMission::setPathTo(). The city runs all of the requests queued
+// during a tick together at the start of its next update, see processPathRequests()
+class VehiclePathRequest
+{
+  public:
+	// The mission it's for is whichever of the vehicle's missions has its pathRequest pointing
+	// here, if any still does
+	wp<Vehicle> vehicle;
+	Vec3<int> origin = {0, 0, 0};
+	Vec3<int> target = {0, 0, 0};
+	int maxIterations = 0;
+	std::list<Vec3<int>> path;
+};
 
 class VehicleMission
 {
@@ -39,6 +56,11 @@ class VehicleMission
 	void setPathTo(GameState &state, Vehicle &v, Vec3<int> target, int maxIterations = 500,
 	               bool checkValidity = true, bool giveUpIfInvalid = false);
 	bool advanceAlongPath(GameState &state, Vec3<float> &dest, Vehicle &v);
+	// Whether the vehicle can still fly straight from one path node to the next
+	static bool canStepBetween(Vehicle &v, Vec3<int> from, Vec3<int> to);
+	// Runs all queued path requests for the city on the thread pool, then hands the paths to
+	// their missions in the order they were requested
+	static void processPathRequests(City &city);
 	bool isTakingOff(Vehicle &v);
 
 	// Methods to create new missions
@@ -96,5 +118,7 @@ class VehicleMission
 	bool subvert = false;
 
 	std::list<Vec3<int>> currentPlannedPath;
+	// Set while waiting for the city to find a path, the vehicle hovers in place until then
+	sp<VehiclePathRequest> pathRequest;
 };
 } // namespace OpenApoc
@@ -1,5 +1,7 @@
 #include "game/state/gamestate.h"
+#include "framework/data.h"
 #include "framework/framework.h"
+#include "framework/sound.h"
 #include "framework/trace.h"
 #include "game/state/base/base.h"
 #include "game/state/base/facility.h"
@@ -16,6 +18,7 @@
 #include "game/state/city/projectile.h"
 #include "game/state/city/scenery.h"
 #include "game/state/city/vehicle.h"
+#include "game/state/city/vehiclegrid.h"
 #include "game/state/city/vehiclemission.h"
 #include "game/state/gameevent.h"
 #include "game/state/gametime.h"
@@ -102,6 +105,8 @@ void GameState::initState()
 {
 	// FIXME: reseed rng when game starts
 
+	this->updateOrganisationRelations();
+
 	if (current_battle)
 		current_battle->initBattle(*this);
 
@@ -115,6 +120,7 @@ void GameState::initState()
 			if (vehicle->city == city && !vehicle->currentlyLandedBuilding)
 			{
 				city->map->addObjectToMap(vehicle);
+				city->vehicleGrid->update(vehicle);
 			}
 		}
 		for (auto &p : c.second->projectiles)
@@ -170,6 +176,31 @@ void GameState::initState()
 	}
 	// Run nessecary methods for different types
 	research.updateTopicList();
+	// Everything the game can play has been loaded by now, so get it ready to play in one go
+	if (fw().soundBackend)
+		fw().soundBackend->prepareSamples(fw().data->getLoadedSamples());
+}
+
+void GameState::updateOrganisationRelations()
+{
+	int index = 0;
+	for (auto &o : this->organisations)
+	{
+		o.second->relationIndex = index++;
+	}
+	for (auto &o : this->organisations)
+	{
+		auto &org = o.second;
+		org->relationCache.resize(this->organisations.size());
+		org->relationTypeCache.resize(this->organisations.size());
+		for (auto &other : this->organisations)
+		{
+			float relation = org->calculateRelationTo({this, other.first});
+			org->relationCache[other.second->relationIndex] = relation;
+			org->relationTypeCache[other.second->relationIndex] =
+			    Organisation::getRelationFromValue(relation);
+		}
+	}
 }
 
 void GameState::startGame()
@@ -446,6 +477,8 @@ void GameState::updateEndOfDay()
 	}
 	Trace::end("GameState::updateEndOfDay::cities");
 
+	this->updateOrganisationRelations();
+
 	for (int i = 0; i < 5; i++)
 	{
 		StateRef<City> city = {this, "CITYMAP_HUMAN"};
@@ -548,7 +581,9 @@ void GameState::updateTurbo()
 	{
 		ticksToUpdate -= align;
 	}
+	this->turboUpdate = true;
 	this->update(ticksToUpdate);
+	this->turboUpdate = false;
 }
 
 void GameState::logEvent(GameEvent *ev)
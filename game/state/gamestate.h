@@ -109,6 +109,8 @@ class GameState : public std::enable_shared_from_this<GameState>
 	bool showTileOrigin = false;
 	bool showVehiclePath = false;
 	bool showSelectableBounds = false;
+	// Set while updateTurbo() is running, see Vehicle::canFastForward()
+	bool turboUpdate = false;
 
 	Xorshift128Plus<uint32_t> rng;
 
@@ -145,6 +147,8 @@ class GameState : public std::enable_shared_from_this<GameState>
 	// that is serialized but not serialized itself). This should also be called on starting a new
 	// game after startGame()
 	void initState();
+	// Rebuilds every organisation's relation cache, call after changing any current_relations
+	void updateOrganisationRelations();
 
 	// Fills out initial player property
 	void fillPlayerStartingProperty();
@@ -8,6 +8,16 @@ namespace OpenApoc
 Organisation::Organisation() : balance(0), income(0), tech_level(1), average_guards(1) {}
 
 float Organisation::getRelationTo(const StateRef<Organisation> &other) const
+{
+	int otherIndex = other->relationIndex;
+	if (otherIndex >= 0 && otherIndex < (int)this->relationCache.size())
+	{
+		return this->relationCache[otherIndex];
+	}
+	return this->calculateRelationTo(other);
+}
+
+float Organisation::calculateRelationTo(const StateRef<Organisation> &other) const
 {
 	if (other == this)
 	{
@@ -36,7 +46,16 @@ float Organisation::getRelationTo(const StateRef<Organisation> &other) const
 
 Organisation::Relation Organisation::isRelatedTo(const StateRef<Organisation> &other) const
 {
-	float x = this->getRelationTo(other);
+	int otherIndex = other->relationIndex;
+	if (otherIndex >= 0 && otherIndex < (int)this->relationTypeCache.size())
+	{
+		return this->relationTypeCache[otherIndex];
+	}
+	return getRelationFromValue(this->calculateRelationTo(other));
+}
+
+Organisation::Relation Organisation::getRelationFromValue(float x)
+{
 	// FIXME: Make the thresholds read from serialized GameState?
 	if (x <= -50)
 	{
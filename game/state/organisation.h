@@ -48,6 +48,17 @@ class Organisation : public StateObject
 	bool isNegativeTo(const StateRef<Organisation> &other) const;
 	float getRelationTo(const StateRef<Organisation> &other) const;
 	std::map<StateRef<Organisation>, float> current_relations;
+
+	// Calculates the relation from current_relations, bypassing the relation cache
+	float calculateRelationTo(const StateRef<Organisation> &other) const;
+	static Relation getRelationFromValue(float relation);
+
+	// The relation to every other organisation, indexed by the other's relationIndex.
+	// Built by GameState::updateOrganisationRelations(), which must be called whenever
+	// current_relations changes.
+	int relationIndex = -1;
+	std::vector<float> relationCache;
+	std::vector<Relation> relationTypeCache;
 };
 
 }; // namespace OpenApoc
@@ -23,6 +23,7 @@
 #include "game/state/tileview/tileobject_vehicle.h"
 #include "library/sp.h"
 #include <algorithm>
+#include <cmath>
 #include <random>
 #include <unordered_map>
 
@@ -31,7 +32,8 @@ namespace OpenApoc
 
 TileMap::TileMap(Vec3<int> size, Vec3<float> velocityScale, Vec3<int> voxelMapSize,
                  std::vector<std::set<TileObject::Type>> layerMap)
-    : layerMap(layerMap), size(size), voxelMapSize(voxelMapSize), velocityScale(velocityScale)
+    : layerMap(layerMap), size(size), voxelMapSize(voxelMapSize), velocityScale(velocityScale),
+      navGrid(size)
 {
 	tiles.reserve(size.x * size.y * size.z);
 	for (int z = 0; z < size.z; z++)
@@ -62,6 +64,157 @@ TileMap::TileMap(Vec3<int> size, Vec3<float> velocityScale, Vec3<int> voxelMapSi
 
 TileMap::~TileMap() = default;
 
+NavGrid::NavGrid(Vec3<int> size)
+    : size(size), movementCostIn(size.x * size.y * size.z, 4),
+      movementCostLeft(size.x * size.y * size.z, 0), movementCostRight(size.x * size.y * size.z, 0),
+      height(size.x * size.y * size.z, 0), flags(size.x * size.y * size.z, 0)
+{
+}
+
+float NavGrid::getHeight(int index) const { return (float)height[index] / (float)TILE_Z_BATTLE; }
+
+void NavGrid::update(const Tile &tile)
+{
+	auto index = getIndex(tile.position);
+	movementCostIn[index] = std::min(tile.movementCostIn, 255);
+	movementCostLeft[index] = std::min(tile.movementCostLeft, 255);
+	movementCostRight[index] = std::min(tile.movementCostRight, 255);
+	height[index] = static_cast<uint8_t>(std::lround(tile.height * TILE_Z_BATTLE));
+	uint8_t newFlags = flags[index] & UnitPresent;
+	if (tile.closedDoorLeft)
+		newFlags |= ClosedDoorLeft;
+	if (tile.closedDoorRight)
+		newFlags |= ClosedDoorRight;
+	if (tile.solidGround)
+		newFlags |= SolidGround;
+	if (tile.canStand)
+		newFlags |= CanStand;
+	if (tile.hasLift)
+		newFlags |= HasLift;
+	flags[index] = newFlags;
+}
+
+void NavGrid::updateUnitPresent(const Tile &tile)
+{
+	auto index = getIndex(tile.position);
+	if (tile.firstUnitPresent)
+		flags[index] |= UnitPresent;
+	else
+		flags[index] &= ~UnitPresent;
+}
+
+bool NavGrid::getCanStand(Vec3<int> pos, bool large) const
+{
+	if (large)
+	{
+		if (pos.x < 1 || pos.y < 1)
+		{
+			LogError(
+			    "Trying to get standing ability for a large unit when it can't fit! %d, %d, %d",
+			    pos.x, pos.y, pos.z);
+			return false;
+		}
+		return getCanStand(getIndex(pos.x, pos.y, pos.z)) ||
+		       getCanStand(getIndex(pos.x - 1, pos.y, pos.z)) ||
+		       getCanStand(getIndex(pos.x, pos.y - 1, pos.z)) ||
+		       getCanStand(getIndex(pos.x - 1, pos.y - 1, pos.z));
+	}
+	return getCanStand(getIndex(pos));
+}
+
+bool NavGrid::getPassable(Vec3<int> pos, bool large, int height) const
+{
+	auto index = getIndex(pos);
+	if (movementCostIn[index] == 255)
+		return false;
+
+	if (large)
+	{
+		if (movementCostLeft[index] == 255)
+			return false;
+		if (movementCostRight[index] == 255)
+			return false;
+
+		if (pos.x < 1 || pos.y < 1 || pos.z >= size.z - 1)
+		{
+			return false;
+		}
+
+		auto tX = getIndex(pos.x - 1, pos.y, pos.z);
+		if (movementCostIn[tX] == 255)
+			return false;
+		if (movementCostRight[tX] == 255)
+			return false;
+
+		auto tY = getIndex(pos.x, pos.y - 1, pos.z);
+		if (movementCostIn[tY] == 255)
+			return false;
+		if (movementCostLeft[tY] == 255)
+			return false;
+
+		if (movementCostIn[getIndex(pos.x - 1, pos.y - 1, pos.z)] == 255)
+			return false;
+
+		auto tZ = getIndex(pos.x, pos.y, pos.z + 1);
+		if (movementCostIn[tZ] == 255)
+			return false;
+		if (movementCostLeft[tZ] == 255)
+			return false;
+		if (movementCostRight[tZ] == 255)
+			return false;
+
+		auto tXZ = getIndex(pos.x - 1, pos.y, pos.z + 1);
+		if (movementCostIn[tXZ] == 255)
+			return false;
+		if (movementCostRight[tXZ] == 255)
+			return false;
+
+		auto tYZ = getIndex(pos.x, pos.y - 1, pos.z + 1);
+		if (movementCostIn[tYZ] == 255)
+			return false;
+		if (movementCostLeft[tYZ] == 255)
+			return false;
+
+		if (movementCostIn[getIndex(pos.x - 1, pos.y - 1, pos.z + 1)] == 255)
+			return false;
+	}
+
+	return height == 0 || getHeadFits(pos, large, height);
+}
+
+bool NavGrid::getHeadFits(Vec3<int> pos, bool large, int height) const
+{
+	if (pos.z + (large ? 2 : 1) >= size.z)
+		return true;
+	if (large)
+	{
+		// Check four tiles above our "to"'s head
+		if (getSolidGround(getIndex(pos.x, pos.y, pos.z + 2)) ||
+		    getSolidGround(getIndex(pos.x - 1, pos.y, pos.z + 2)) ||
+		    getSolidGround(getIndex(pos.x, pos.y - 1, pos.z + 2)) ||
+		    getSolidGround(getIndex(pos.x - 1, pos.y - 1, pos.z + 2)))
+		{
+			float maxHeight = getHeight(getIndex(pos));
+			maxHeight = std::max(maxHeight, getHeight(getIndex(pos.x - 1, pos.y, pos.z)));
+			maxHeight = std::max(maxHeight, getHeight(getIndex(pos.x, pos.y - 1, pos.z)));
+			maxHeight = std::max(maxHeight, getHeight(getIndex(pos.x - 1, pos.y - 1, pos.z)));
+			if (height + maxHeight * 40 - 1 > 80)
+			{
+				return false;
+			}
+		}
+	}
+	else
+	{
+		if (getSolidGround(getIndex(pos.x, pos.y, pos.z + 1)) &&
+		    height + getHeight(getIndex(pos)) * 40 - 1 > 40)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
 Tile::Tile(TileMap &map, Vec3<int> position, int layerCount)
     : map(map), position(position), drawnObjects(layerCount)
 {
@@ -121,33 +274,7 @@ bool Tile::getSolidGround(bool large)
 	return false;
 }
 
-bool Tile::getCanStand(bool large)
-{
-	if (large)
-	{
-		if (position.x < 1 || position.y < 1)
-		{
-			LogError(
-			    "Trying to get standing ability for a large unit when it can't fit! %d, %d, %d",
-			    position.x, position.y, position.z);
-			return false;
-		}
-		if (canStand || map.getTile(position.x - 1, position.y, position.z)->canStand ||
-		    map.getTile(position.x, position.y - 1, position.z)->canStand ||
-		    map.getTile(position.x - 1, position.y - 1, position.z)->canStand)
-		{
-			return true;
-		}
-	}
-	else
-	{
-		if (canStand)
-		{
-			return true;
-		}
-	}
-	return false;
-}
+bool Tile::getCanStand(bool large) { return map.navGrid.getCanStand(position, large); }
 
 bool Tile::getHasExit(bool large)
 {
@@ -178,98 +305,12 @@ bool Tile::getHasExit(bool large)
 
 bool Tile::getPassable(bool large, int height)
 {
-	if (movementCostIn == 255)
-		return false;
-
-	if (large)
-	{
-		if (movementCostLeft == 255)
-			return false;
-		if (movementCostRight == 255)
-			return false;
-
-		if (position.x < 1 || position.y < 1 || position.z >= map.size.z - 1)
-		{
-			return false;
-		}
-
-		auto tX = map.getTile(position.x - 1, position.y, position.z);
-		if (tX->movementCostIn == 255)
-			return false;
-		if (tX->movementCostRight == 255)
-			return false;
-
-		auto tY = map.getTile(position.x, position.y - 1, position.z);
-		if (tY->movementCostIn == 255)
-			return false;
-		if (tY->movementCostLeft == 255)
-			return false;
-
-		if (map.getTile(position.x - 1, position.y - 1, position.z)->movementCostIn == 255)
-			return false;
-
-		auto tZ = map.getTile(position.x, position.y, position.z + 1);
-		if (tZ->movementCostIn == 255)
-			return false;
-		if (tZ->movementCostLeft == 255)
-			return false;
-		if (tZ->movementCostRight == 255)
-			return false;
-
-		auto tXZ = map.getTile(position.x - 1, position.y, position.z + 1);
-		if (tXZ->movementCostIn == 255)
-			return false;
-		if (tXZ->movementCostRight == 255)
-			return false;
-
-		auto tYZ = map.getTile(position.x, position.y - 1, position.z + 1);
-		if (tYZ->movementCostIn == 255)
-			return false;
-		if (tYZ->movementCostLeft == 255)
-			return false;
-
-		if (map.getTile(position.x - 1, position.y - 1, position.z + 1)->movementCostIn == 255)
-			return false;
-	}
-
-	return height == 0 || getHeadFits(large, height);
+	return map.navGrid.getPassable(position, large, height);
 }
 
 bool Tile::getHeadFits(bool large, int height)
 {
-	if (position.z + (large ? 2 : 1) >= map.size.z)
-		return true;
-	if (large)
-	{
-		// Check four tiles above our "to"'s head
-		if (map.getTile(Vec3<int>{position.x, position.y, position.z + 2})->solidGround ||
-		    map.getTile(Vec3<int>{position.x - 1, position.y, position.z + 2})->solidGround ||
-		    map.getTile(Vec3<int>{position.x, position.y - 1, position.z + 2})->solidGround ||
-		    map.getTile(Vec3<int>{position.x - 1, position.y - 1, position.z + 2})->solidGround)
-		{
-			auto toX1 = map.getTile(Vec3<int>{position.x - 1, position.y, position.z});
-			auto toY1 = map.getTile(Vec3<int>{position.x, position.y - 1, position.z});
-			auto toXY1 = map.getTile(Vec3<int>{position.x - 1, position.y - 1, position.z});
-
-			float maxHeight = this->height;
-			maxHeight = std::max(maxHeight, toX1->height);
-			maxHeight = std::max(maxHeight, toY1->height);
-			maxHeight = std::max(maxHeight, toXY1->height);
-			if (height + maxHeight * 40 - 1 > 80)
-			{
-				return false;
-			}
-		}
-	}
-	else
-	{
-		if (map.getTile(Vec3<int>{position.x, position.y, position.z + 1})->solidGround &&
-		    height + this->height * 40 - 1 > 40)
-		{
-			return false;
-		}
-	}
-	return true;
+	return map.navGrid.getHeadFits(position, large, height);
 }
 
 void Tile::updateBattlescapeUIDrawOrder()
@@ -329,6 +370,7 @@ void Tile::updateBattlescapeUnitPresent()
 	{
 		doorOpeningUnitPresent = false;
 	}
+	map.navGrid.updateUnitPresent(*this);
 }
 
 void Tile::updateBattlescapeParameters()
@@ -428,10 +470,12 @@ void Tile::updateBattlescapeParameters()
 			{
 				t->canStand = true;
 				t->movementCostIn = std::max(movementCostOver, t->movementCostIn);
+				map.navGrid.update(*t);
 			}
 		}
 	}
 	height = height / (float)TILE_Z_BATTLE;
+	map.navGrid.update(*this);
 }
 
 bool Tile::updateVisionBlockage(int value)
@@ -614,6 +658,26 @@ void TileMap::addObjectToMap(sp<BattleMapPart> map_part)
 	map_part->tileObject = obj;
 }
 
+void TileMap::addObjectsToMap(const std::list<sp<BattleMapPart>> &mapParts)
+{
+	TRACE_FN_ARGS1("count", Strings::fromInteger((int)mapParts.size()));
+	this->drawOrderSortDeferred = true;
+	for (auto &mapPart : mapParts)
+	{
+		this->addObjectToMap(mapPart);
+	}
+	this->drawOrderSortDeferred = false;
+
+	for (auto &tile : this->tiles)
+	{
+		for (auto &layer : tile.drawnObjects)
+		{
+			TileObject::sortByZOrder(layer);
+		}
+		tile.updateBattlescapeUIDrawOrder();
+	}
+}
+
 void TileMap::addObjectToMap(sp<BattleItem> item)
 {
 	if (item->tileObject)
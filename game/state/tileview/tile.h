@@ -6,6 +6,8 @@
 #include "library/colour.h"
 #include "library/rect.h"
 #include "library/sp.h"
+#include <cstdint>
+#include <list>
 #include <map>
 #include <set>
 #include <vector>
@@ -197,11 +199,71 @@ class CanEnterTileHelper
 	virtual float pathOverheadAlloawnce() const { return 1.0f; }
 };
 
+// Packed copy of the battlescape tile parameters that pathfinding reads. Each parameter is kept
+// in its own array, indexed the same way as the map's tiles, so expanding a node doesn't have to
+// chase pointers through Tile objects.
+// Kept in sync by Tile::updateBattlescapeParameters() and Tile::updateBattlescapeUnitPresent()
+class NavGrid
+{
+  public:
+	enum Flag : uint8_t
+	{
+		ClosedDoorLeft = 1 << 0,
+		ClosedDoorRight = 1 << 1,
+		SolidGround = 1 << 2,
+		CanStand = 1 << 3,
+		HasLift = 1 << 4,
+		UnitPresent = 1 << 5,
+	};
+
+	Vec3<int> size;
+	std::vector<uint8_t> movementCostIn;
+	std::vector<uint8_t> movementCostLeft;
+	std::vector<uint8_t> movementCostRight;
+	// Height of the tile's ground and feature, in voxels
+	std::vector<uint8_t> height;
+	std::vector<uint8_t> flags;
+
+	NavGrid(Vec3<int> size);
+
+	int getIndex(int x, int y, int z) const { return z * size.x * size.y + y * size.x + x; }
+	int getIndex(Vec3<int> pos) const { return getIndex(pos.x, pos.y, pos.z); }
+	Vec3<int> getPosition(int index) const
+	{
+		return {index % size.x, (index / size.x) % size.y, index / (size.x * size.y)};
+	}
+
+	int getMovementCostIn(int index) const { return movementCostIn[index]; }
+	int getMovementCostLeft(int index) const { return movementCostLeft[index]; }
+	int getMovementCostRight(int index) const { return movementCostRight[index]; }
+	bool getClosedDoorLeft(int index) const { return flags[index] & ClosedDoorLeft; }
+	bool getClosedDoorRight(int index) const { return flags[index] & ClosedDoorRight; }
+	bool getSolidGround(int index) const { return flags[index] & SolidGround; }
+	bool getCanStand(int index) const { return flags[index] & CanStand; }
+	bool getHasLift(int index) const { return flags[index] & HasLift; }
+	// Quick check if any unit intersects the tile, Tile::getUnitIfPresent() has the details
+	bool getUnitPresent(int index) const { return flags[index] & UnitPresent; }
+	// Same value as Tile::height
+	float getHeight(int index) const;
+
+	// These match the Tile methods of the same name
+	bool getPassable(Vec3<int> pos, bool large, int height) const;
+	bool getHeadFits(Vec3<int> pos, bool large, int height) const;
+	bool getCanStand(Vec3<int> pos, bool large) const;
+
+	void update(const Tile &tile);
+	void updateUnitPresent(const Tile &tile);
+};
+
 class TileMap
 {
   private:
 	std::vector<Tile> tiles;
 	std::vector<std::set<TileObject::Type>> layerMap;
+	// Set while adding objects in bulk, so the drawn objects are only sorted once at the end
+	bool drawOrderSortDeferred = false;
+
+	friend class TileObject;
 
   public:
 	const Tile *getTile(int x, int y, int z) const
@@ -239,6 +301,7 @@ class TileMap
 	Vec3<int> size;
 	Vec3<int> voxelMapSize;
 	Vec3<float> velocityScale;
+	NavGrid navGrid;
 
 	TileMap(Vec3<int> size, Vec3<float> velocityScale, Vec3<int> voxelMapSize,
 	        std::vector<std::set<TileObject::Type>> layerMap);
@@ -277,6 +340,8 @@ class TileMap
 	void addObjectToMap(sp<BattleItem>);
 	void addObjectToMap(sp<BattleUnit>);
 	void addObjectToMap(sp<BattleHazard>);
+	// Same as adding each map part in turn, but much quicker when filling a whole map
+	void addObjectsToMap(const std::list<sp<BattleMapPart>> &mapParts);
 
 	unsigned int getLayer(TileObject::Type type) const;
 	unsigned int getLayerCount() const;
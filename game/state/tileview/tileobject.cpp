@@ -168,8 +168,17 @@ void TileObject::addToDrawnTiles(Tile *tile)
 	this->drawOnTile = tile;
 	int layer = map.getLayer(this->type);
 	this->drawOnTile->drawnObjects[layer].push_back(shared_from_this());
-	std::sort(this->drawOnTile->drawnObjects[layer].begin(),
-	          this->drawOnTile->drawnObjects[layer].end(), TileObjectZComparer{});
+	if (!map.drawOrderSortDeferred)
+	{
+		sortByZOrder(this->drawOnTile->drawnObjects[layer]);
+	}
+}
+
+void TileObject::sortByZOrder(std::vector<sp<TileObject>> &objects)
+{
+	// Stable, so objects at the same depth are drawn in the order they were added whether they
+	// were sorted one at a time or all at once
+	std::stable_sort(objects.begin(), objects.end(), TileObjectZComparer{});
 }
 
 } // namespace OpenApoc
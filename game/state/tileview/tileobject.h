@@ -79,6 +79,9 @@ class TileObject : public std::enable_shared_from_this<TileObject>
 
 	virtual ~TileObject();
 
+	// Sorts a tile's drawn objects back to front
+	static void sortByZOrder(std::vector<sp<TileObject>> &objects);
+
 	TileMap &map;
 
 	static void drawTinted(Renderer &r, sp<Image> sprite, Vec2<float> position, bool visible);
@@ -102,12 +102,12 @@ void BaseGraphics::renderBase(Vec2<int> renderPos, sp<Base> base)
 				fw().renderer->draw(circleL, pos);
 			}
 			// Draw time remaining
-			auto textImage = font->getString(Strings::fromInteger(facility->buildTime));
+			auto text = Strings::fromInteger(facility->buildTime);
 			Vec2<int> textPos = {TILE_SIZE, TILE_SIZE};
 			textPos *= facility->type->size;
-			textPos -= textImage->size;
+			textPos -= font->getLayout(text)->size;
 			textPos /= 2;
-			fw().renderer->draw(textImage, pos + textPos);
+			font->drawString(*fw().renderer, text, pos + textPos);
 		}
 	}
 
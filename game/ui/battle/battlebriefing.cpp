@@ -5,6 +5,7 @@
 #include "forms/ui.h"
 #include "framework/event.h"
 #include "framework/framework.h"
+#include "game/state/battle/battle.h"
 #include "game/state/battle/battlecommonimagelist.h"
 #include "game/state/gamestate.h"
 #include "game/ui/battle/battleprestart.h"
@@ -58,6 +59,11 @@ void BattleBriefing::update()
 	{
 		case std::future_status::ready:
 		{
+			// Start loading the unit graphics while the player reads the briefing
+			if (this->state->current_battle)
+			{
+				this->state->current_battle->prefetchResources(*this->state);
+			}
 			menuform->findControlTyped<GraphicButton>("BUTTON_REAL_TIME")->setVisible(true);
 			menuform->findControlTyped<GraphicButton>("BUTTON_TURN_BASED")->setVisible(true);
 		}
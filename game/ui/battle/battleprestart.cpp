@@ -4,6 +4,7 @@
 #include "forms/ui.h"
 #include "framework/event.h"
 #include "framework/framework.h"
+#include "game/state/battle/battle.h"
 #include "game/state/battle/battlecommonimagelist.h"
 #include "game/state/gamestate.h"
 #include "game/ui/battle/battleview.h"
@@ -29,13 +30,20 @@ BattlePreStart::BattlePreStart(sp<GameState> state)
 	    ->addCallback(FormEventType::ButtonClick, [this, state](Event *) {
 
 		    auto gameState = this->state;
+		    auto battle = gameState->current_battle;
 
 		    fw().stageQueueCommand(
 		        {StageCmd::Command::PUSH,
 		         mksp<LoadingScreen>(enterBattle(gameState),
 		                             [gameState]() { return mksp<BattleView>(gameState); },
-		                             this->state->battle_common_image_list->loadingImage, 1)});
+		                             this->state->battle_common_image_list->loadingImage, 1, true,
+		                             [battle]() { return battle->getPrefetchProgress(); })});
 		});
+	// Normally already started by the briefing
+	if (this->state->current_battle)
+	{
+		this->state->current_battle->prefetchResources(*this->state);
+	}
 }
 
 void BattlePreStart::begin() {}
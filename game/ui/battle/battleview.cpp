@@ -1744,7 +1744,7 @@ void BattleView::eventOccurred(Event *e)
 						auto set = mksp<std::set<BattleMapPart *>>();
 						set->insert(mp.get());
 						mp->queueCollapse();
-						BattleMapPart::attemptReLinkSupports(set);
+						BattleMapPart::attemptReLinkSupports(*state, set);
 					}
 				}
 				break;
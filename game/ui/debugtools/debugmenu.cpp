@@ -1,5 +1,6 @@
 #include "game/ui/debugtools/debugmenu.h"
 #include "forms/form.h"
+#include "forms/label.h"
 #include "forms/ui.h"
 #include "framework/data.h"
 #include "framework/event.h"
@@ -7,9 +8,11 @@
 #include "framework/image.h"
 #include "framework/keycodes.h"
 #include "framework/renderer.h"
+#include "framework/resourcecache.h"
 #include "game/ui/debugtools/formpreview.h"
 #include "game/ui/debugtools/imagepreview.h"
 #include "library/sp.h"
+#include "library/strings_format.h"
 
 namespace OpenApoc
 {
@@ -18,7 +21,7 @@ DebugMenu::DebugMenu() : Stage(), menuform(ui().getForm("debugmenu")) {}
 
 DebugMenu::~DebugMenu() = default;
 
-void DebugMenu::begin() {}
+void DebugMenu::begin() { updateCacheStats(); }
 
 void DebugMenu::pause() {}
 
@@ -62,7 +65,11 @@ void DebugMenu::eventOccurred(Event *e)
 	}
 }
 
-void DebugMenu::update() { menuform->update(); }
+void DebugMenu::update()
+{
+	updateCacheStats();
+	menuform->update();
+}
 
 void DebugMenu::render()
 {
@@ -75,6 +82,20 @@ void DebugMenu::render()
 
 bool DebugMenu::isTransition() { return false; }
 
+void DebugMenu::updateCacheStats()
+{
+	UString text;
+	for (auto &stats : fw().data->getCacheStats())
+	{
+		text += format("%s: %uKB/%uKB (%u pinned) hits %llu misses %llu evictions %llu\n",
+		               stats.name, static_cast<unsigned>(stats.bytesUsed / 1024),
+		               static_cast<unsigned>(stats.bytesBudget / 1024),
+		               static_cast<unsigned>(stats.entries), (unsigned long long)stats.hits,
+		               (unsigned long long)stats.misses, (unsigned long long)stats.evictions);
+	}
+	menuform->findControlTyped<Label>("TEXT_CACHE_STATS")->setText(text);
+}
+
 void DebugMenu::bulkExportPcks()
 {
 	std::vector<UString> PaletteNames;
@@ -14,6 +14,7 @@ class DebugMenu : public Stage
 	sp<Form> menuform;
 
 	void bulkExportPcks();
+	void updateCacheStats();
 
   public:
 	DebugMenu();
@@ -19,9 +19,11 @@ ConfigOptionBool asyncLoading("Game", "ASyncLoading",
                               "Load in background while displaying animated loading screen", true);
 
 LoadingScreen::LoadingScreen(std::future<void> task, std::function<sp<Stage>()> nextScreenFn,
-                             sp<Image> background, int scaleDivisor, bool showRotatingImage)
+                             sp<Image> background, int scaleDivisor, bool showRotatingImage,
+                             std::function<float()> progressFn)
     : Stage(), loadingTask(std::move(task)), nextScreenFn(std::move(nextScreenFn)),
-      backgroundimage(background), showRotatingImage(showRotatingImage), scaleDivisor(scaleDivisor)
+      backgroundimage(background), showRotatingImage(showRotatingImage), scaleDivisor(scaleDivisor),
+      progressFn(std::move(progressFn))
 {
 }
 
@@ -96,6 +98,15 @@ void LoadingScreen::render()
 		    Vec2<float>{fw().displayGetWidth() - 50, fw().displayGetHeight() - 50},
 		    loadingimageangle);
 	}
+	if (progressFn)
+	{
+		float progress = clamp(progressFn(), 0.0f, 1.0f);
+		Vec2<float> barPosition{fw().displayGetWidth() / 4, fw().displayGetHeight() - 40};
+		Vec2<float> barSize{fw().displayGetWidth() / 2, 8};
+		fw().renderer->drawFilledRect(barPosition, Vec2<float>{barSize.x * progress, barSize.y},
+		                              Colour{255, 255, 255, 255});
+		fw().renderer->drawRect(barPosition, barSize, Colour{255, 255, 255, 255});
+	}
 }
 
 bool LoadingScreen::isTransition() { return false; }
@@ -21,11 +21,12 @@ class LoadingScreen : public Stage
 	float loadingimageangle;
 	bool showRotatingImage = false;
 	int scaleDivisor = 0;
+	std::function<float()> progressFn;
 
   public:
 	LoadingScreen(std::future<void> task, std::function<sp<Stage>()> nextScreenFn,
 	              sp<Image> background = nullptr, int scaleDivisor = 3,
-	              bool showRotatingImage = true);
+	              bool showRotatingImage = true, std::function<float()> progressFn = nullptr);
 	// Stage control
 	void begin() override;
 	void pause() override;
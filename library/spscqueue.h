@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace OpenApoc
+{
+
+// A fixed size queue for passing things from exactly one thread to exactly one other without
+// locking, so neither side can ever be left waiting on the other (the audio callback must never
+// wait on the game thread, for example).
+// 'capacity' is rounded up to a power of two. Pushing to a full queue fails rather than blocking.
+template <typename T> class SPSCQueue
+{
+  public:
+	SPSCQueue(size_t capacity) : head(0), tail(0)
+	{
+		size_t size = 1;
+		while (size < capacity)
+			size <<= 1;
+		this->slots.resize(size);
+		this->mask = size - 1;
+	}
+
+	// Only to be called from the producing thread. 'value' is only moved from if it fits, so a
+	// failed push can be retried
+	bool tryPush(T &&value)
+	{
+		auto currentTail = this->tail.load(std::memory_order_relaxed);
+		if (currentTail - this->head.load(std::memory_order_acquire) > this->mask)
+			return false;
+		this->slots[currentTail & this->mask] = std::move(value);
+		this->tail.store(currentTail + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Only to be called from the consuming thread
+	bool tryPop(T &value)
+	{
+		auto currentHead = this->head.load(std::memory_order_relaxed);
+		if (currentHead == this->tail.load(std::memory_order_acquire))
+			return false;
+		// Move out, so the slot doesn't keep anything alive until it's reused
+		value = std::move(this->slots[currentHead & this->mask]);
+		this->slots[currentHead & this->mask] = T();
+		this->head.store(currentHead + 1, std::memory_order_release);
+		return true;
+	}
+
+	size_t capacity() const { return this->slots.size(); }
+
+  private:
+	std::vector<T> slots;
+	size_t mask;
+	// Total number ever popped and pushed, the positions in 'slots' are these masked
+	std::atomic<size_t> head;
+	std::atomic<size_t> tail;
+};
+
+}; // namespace OpenApoc
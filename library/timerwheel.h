@@ -0,0 +1,126 @@
+#pragma once
+
+#include "library/sp.h"
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace OpenApoc
+{
+
+// A hierarchical timer wheel, for objects that only need to do something at a known tick in the
+// future (an animation frame changing, a lifetime running out) rather than every tick.
+// Timers due within the next SLOTS ticks sit in the bottom level slot for the tick they are due,
+// and longer ones in a coarser level, moving down a level each time the level below wraps around.
+// This keeps both scheduling and advancing proportional to the number of timers that fire,
+// rather than the number waiting.
+// Objects are held weakly, so anything destroyed while waiting just doesn't fire.
+template <typename T> class TimerWheel
+{
+  public:
+	static const unsigned int SLOT_BITS = 6;
+	static const unsigned int SLOTS = 1 << SLOT_BITS;
+	static const unsigned int LEVELS = 4;
+
+	TimerWheel() : levels(LEVELS, std::vector<std::vector<Entry>>(SLOTS)) {}
+
+	// The number of ticks advanced since the wheel was created
+	uint64_t getTick() const { return this->currentTick; }
+
+	// Fires 'object' 'delay' ticks from now. A delay of 0 is treated as 1, as the current tick has
+	// already been handled
+	void schedule(sp<T> object, uint64_t delay)
+	{
+		this->insert({this->currentTick + (delay > 0 ? delay : 1), object});
+	}
+
+	// Moves time on by 'ticks', calling 'fire' for every timer that comes due. Timers due on the
+	// same tick fire in a fixed order. 'fire' may schedule new timers
+	void advance(uint64_t ticks, std::function<void(const sp<T> &)> fire)
+	{
+		std::vector<Entry> due;
+		for (uint64_t i = 0; i < ticks; i++)
+		{
+			this->currentTick++;
+			// Move anything coming due into finer levels, coarsest first as they might move into a
+			// slot that is about to be cascaded as well
+			for (unsigned int level = LEVELS - 1; level > 0; level--)
+			{
+				if ((this->currentTick & ((uint64_t(1) << (level * SLOT_BITS)) - 1)) != 0)
+					continue;
+				if (level == LEVELS - 1)
+				{
+					due.clear();
+					due.swap(this->overflow);
+					for (auto &entry : due)
+					{
+						this->insert(entry);
+					}
+				}
+				due.clear();
+				due.swap(this->levels[level][this->getSlot(this->currentTick, level)]);
+				for (auto &entry : due)
+				{
+					this->insert(entry);
+				}
+			}
+			auto &slot = this->levels[0][this->currentTick & (SLOTS - 1)];
+			if (slot.empty())
+				continue;
+			due.clear();
+			due.swap(slot);
+			for (auto &entry : due)
+			{
+				auto object = entry.object.lock();
+				if (object)
+					fire(object);
+			}
+		}
+	}
+
+	void clear()
+	{
+		for (auto &level : this->levels)
+		{
+			for (auto &slot : level)
+			{
+				slot.clear();
+			}
+		}
+		this->overflow.clear();
+	}
+
+  private:
+	class Entry
+	{
+	  public:
+		uint64_t due;
+		wp<T> object;
+	};
+
+	uint64_t currentTick = 0;
+	std::vector<std::vector<std::vector<Entry>>> levels;
+	// Timers too far in the future for even the top level
+	std::vector<Entry> overflow;
+
+	static unsigned int getSlot(uint64_t tick, unsigned int level)
+	{
+		return (tick >> (level * SLOT_BITS)) & (SLOTS - 1);
+	}
+
+	void insert(const Entry &entry)
+	{
+		auto delay = entry.due > this->currentTick ? entry.due - this->currentTick : 0;
+		for (unsigned int level = 0; level < LEVELS; level++)
+		{
+			if (delay < (uint64_t(1) << ((level + 1) * SLOT_BITS)))
+			{
+				this->levels[level][getSlot(entry.due, level)].push_back(entry);
+				return;
+			}
+		}
+		this->overflow.push_back(entry);
+	}
+};
+
+}; // namespace OpenApoc
@@ -0,0 +1,138 @@
+#include "framework/configfile.h"
+#include "framework/data.h"
+#include "framework/framework.h"
+#include "framework/logger.h"
+#include <chrono>
+#include <fstream>
+#include <vector>
+
+using namespace OpenApoc;
+
+ConfigOptionString extractedCDOption("Test", "ExtractedCD",
+                                     "Directory holding the contents of the CD, to check and time "
+                                     "reads through the CD image against (empty to skip)",
+                                     "");
+
+// Most of the loaders read a few bytes at a time, so do the same
+static const size_t READ_SIZE = 4096;
+
+static void listFiles(const UString &path, std::vector<UString> &files)
+{
+	auto entries = fw().data->fs.enumerateDirectory(path, "");
+	if (entries.empty())
+	{
+		files.push_back(path);
+	}
+	for (auto &entry : entries)
+	{
+		listFiles(path + "/" + entry, files);
+	}
+}
+
+static bool readImage(const UString &path, std::vector<char> &contents)
+{
+	auto file = fw().data->fs.open(path);
+	if (!file)
+	{
+		LogError("Failed to open \"%s\"", path);
+		return false;
+	}
+	contents.clear();
+	char buffer[READ_SIZE];
+	while (file.read(buffer, READ_SIZE) || file.gcount())
+	{
+		contents.insert(contents.end(), buffer, buffer + file.gcount());
+	}
+	return true;
+}
+
+static bool readExtracted(const UString &path, std::vector<char> &contents)
+{
+	std::ifstream file(path.str(), std::ios::in | std::ios::binary);
+	if (!file)
+	{
+		LogError("Failed to open \"%s\"", path);
+		return false;
+	}
+	contents.clear();
+	char buffer[READ_SIZE];
+	while (file.read(buffer, READ_SIZE) || file.gcount())
+	{
+		contents.insert(contents.end(), buffer, buffer + file.gcount());
+	}
+	return true;
+}
+
+int main(int argc, char **argv)
+{
+	if (config().parseOptions(argc, argv))
+	{
+		return EXIT_FAILURE;
+	}
+	Framework fw("OpenApoc", false);
+
+	std::vector<UString> files;
+	listFiles("xcom3/ufodata", files);
+	listFiles("xcom3/tacdata", files);
+	if (files.size() < 2)
+	{
+		LogError("No files found on the CD");
+		return EXIT_FAILURE;
+	}
+
+	// The second pass shows how much the sector cache (or the OS's) helps
+	std::vector<char> contents;
+	uint64_t totalSize = 0;
+	for (int pass = 1; pass <= 2; pass++)
+	{
+		totalSize = 0;
+		auto start = std::chrono::high_resolution_clock::now();
+		for (auto &path : files)
+		{
+			if (!readImage(path, contents))
+				return EXIT_FAILURE;
+			totalSize += contents.size();
+		}
+		auto end = std::chrono::high_resolution_clock::now();
+		auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+		LogInfo("Pass %d: read %u files, %llu bytes from \"%s\" in %lld ms", pass,
+		        (unsigned int)files.size(), (unsigned long long)totalSize, fw.getCDPath(),
+		        (long long)millis);
+	}
+
+	auto extractedPath = extractedCDOption.get();
+	if (extractedPath.empty())
+	{
+		LogInfo("No extracted CD given, skipping comparison");
+		return EXIT_SUCCESS;
+	}
+
+	std::vector<char> extractedContents;
+	totalSize = 0;
+	auto start = std::chrono::high_resolution_clock::now();
+	for (auto &path : files)
+	{
+		// Paths on the CD are all under "xcom3/"
+		if (!readExtracted(extractedPath + "/" + path.substr(6), extractedContents))
+			return EXIT_FAILURE;
+		totalSize += extractedContents.size();
+	}
+	auto end = std::chrono::high_resolution_clock::now();
+	auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+	LogInfo("Read %u files, %llu bytes from \"%s\" in %lld ms", (unsigned int)files.size(),
+	        (unsigned long long)totalSize, extractedPath, (long long)millis);
+
+	for (auto &path : files)
+	{
+		if (!readImage(path, contents) ||
+		    !readExtracted(extractedPath + "/" + path.substr(6), extractedContents))
+			return EXIT_FAILURE;
+		if (contents != extractedContents)
+		{
+			LogError("\"%s\" differs between the CD and \"%s\"", path, extractedPath);
+			return EXIT_FAILURE;
+		}
+	}
+
+	return EXIT_SUCCESS;
+}
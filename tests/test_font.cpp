@@ -0,0 +1,121 @@
+#include "framework/apocresources/apocfont.h"
+#include "framework/configfile.h"
+#include "framework/font.h"
+#include "framework/framework.h"
+#include "framework/image.h"
+#include "framework/logger.h"
+#include "library/strings_format.h"
+#include <algorithm>
+#include <chrono>
+
+using namespace OpenApoc;
+
+// Check the layout and the string image against each character's glyph, placed one after another
+static bool testLayout(sp<BitmapFont> font, const UString &text)
+{
+	// Before the layout's cached, so this is worked out separately
+	auto fontWidth = font->getFontWidth(text);
+	auto layout = font->getLayout(text);
+	auto img = font->getString(text);
+
+	// The test strings are all ASCII, so one glyph per byte
+	auto characters = text.str();
+	if (layout->glyphs.size() != characters.size())
+	{
+		LogWarning("Layout has %u glyphs for %u characters in \"%s\"",
+		           (unsigned int)layout->glyphs.size(), (unsigned int)characters.size(), text);
+		return false;
+	}
+
+	PaletteImageLock imgLock(img, ImageLockUse::Read);
+	int x = 0;
+	for (size_t i = 0; i < characters.size(); i++)
+	{
+		auto glyph = font->getGlyph((UniChar)characters[i]);
+		auto &positioned = layout->glyphs[i];
+		if (positioned.glyph != glyph || positioned.offset != Vec2<int>{x, 0})
+		{
+			LogWarning("Glyph %u of \"%s\" at %s, expected at {%d,0}", (unsigned int)i, text,
+			           positioned.offset, x);
+			return false;
+		}
+		PaletteImageLock glyphLock(glyph, ImageLockUse::Read);
+		for (unsigned int gy = 0; gy < std::min(glyph->size.y, img->size.y); gy++)
+		{
+			for (unsigned int gx = 0; gx < glyph->size.x; gx++)
+			{
+				if (imgLock.get({(unsigned int)x + gx, gy}) != glyphLock.get({gx, gy}))
+				{
+					LogWarning("String image differs from glyph %u at {%d,%d} for \"%s\"",
+					           (unsigned int)i, gx, gy, text);
+					return false;
+				}
+			}
+		}
+		x += glyph->size.x;
+	}
+
+	if (layout->size != Vec2<int>{x, font->getFontHeight()} ||
+	    img->size != Vec2<unsigned int>{(unsigned int)x, (unsigned int)font->getFontHeight()})
+	{
+		LogWarning("Layout size %s and string image size %s for \"%s\", expected {%d,%d}",
+		           layout->size, img->size, text, x, font->getFontHeight());
+		return false;
+	}
+	if (fontWidth != x)
+	{
+		LogWarning("Font width %d for \"%s\", expected %d", fontWidth, text, x);
+		return false;
+	}
+	return true;
+}
+
+int main(int argc, char **argv)
+{
+	if (config().parseOptions(argc, argv))
+	{
+		return EXIT_FAILURE;
+	}
+
+	Framework fw("OpenApoc", false);
+
+	auto font = ApocalypseFont::loadFont("fonts/smalfont.font");
+	if (!font)
+	{
+		LogError("Failed to load font");
+		return EXIT_FAILURE;
+	}
+
+	for (auto &text : {"Hello world", "0123456789", "TU: 42/60", "Alien Building"})
+	{
+		if (!testLayout(font, text))
+		{
+			LogError("Layout for \"%s\" didn't match its glyphs", text);
+			return EXIT_FAILURE;
+		}
+	}
+
+	// Simulate a counter that changes every frame, so nothing is ever re-used from the caches
+	const int iterations = 10000;
+	auto startTime = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < iterations; i++)
+	{
+		font->getString(format("Time units: %d", i));
+	}
+	auto imageTime = std::chrono::high_resolution_clock::now() - startTime;
+
+	startTime = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < iterations; i++)
+	{
+		font->getLayout(format("Time units: %d", i + iterations));
+	}
+	auto layoutTime = std::chrono::high_resolution_clock::now() - startTime;
+
+	LogInfo("%d strings: getString() %lldus, getLayout() %lldus", iterations,
+	        static_cast<long long>(
+	            std::chrono::duration_cast<std::chrono::microseconds>(imageTime).count()),
+	        static_cast<long long>(
+	            std::chrono::duration_cast<std::chrono::microseconds>(layoutTime).count()));
+
+	return EXIT_SUCCESS;
+}
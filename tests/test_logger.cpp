@@ -0,0 +1,96 @@
+#include "framework/configfile.h"
+#include "framework/logger.h"
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace OpenApoc;
+
+static const int THREAD_COUNT = 4;
+// More than fits in a thread's queue, so the writer has to catch up along the way
+static const int MESSAGE_COUNT = 5000;
+
+static void time_logging()
+{
+	auto start = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < MESSAGE_COUNT; i++)
+	{
+		LogInfo("Timing message %d", i);
+	}
+	auto end = std::chrono::high_resolution_clock::now();
+	LogFlush();
+	auto flushed = std::chrono::high_resolution_clock::now();
+	auto micros = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+	auto flushMicros = std::chrono::duration_cast<std::chrono::microseconds>(flushed - end).count();
+	LogWarning("Logged %d messages: %f us per message, then %lld us to flush", MESSAGE_COUNT,
+	           (float)micros / MESSAGE_COUNT, (long long)flushMicros);
+}
+
+int main(int argc, char **argv)
+{
+	if (config().parseOptions(argc, argv))
+	{
+		return EXIT_FAILURE;
+	}
+	auto logFile = config().getString("Logger.File");
+	if (logFile.empty() || config().getInt("Logger.FileLevel") < (int)LogLevel::Info)
+	{
+		LogWarning("Not logging info messages to a file, nothing to check");
+		return EXIT_SUCCESS;
+	}
+
+	std::vector<std::thread> threads;
+	for (int t = 0; t < THREAD_COUNT; t++)
+	{
+		threads.emplace_back([t]() {
+			for (int i = 0; i < MESSAGE_COUNT; i++)
+			{
+				LogInfo("Thread %d message %d", t, i);
+			}
+		});
+	}
+	for (auto &thread : threads)
+	{
+		thread.join();
+	}
+	LogFlush();
+
+	// Every message should be there, in the order each thread logged them
+	std::ifstream file(logFile.str());
+	std::map<int, int> nextMessage;
+	std::string line;
+	while (std::getline(file, line))
+	{
+		auto position = line.find(": Thread ");
+		if (position == std::string::npos)
+			continue;
+		int thread, message;
+		std::string word;
+		std::istringstream words(line.substr(position + 2));
+		words >> word >> thread >> word >> message;
+		if (message != nextMessage[thread])
+		{
+			LogError("Thread %d logged message %d, expected %d", thread, message,
+			         nextMessage[thread]);
+			return EXIT_FAILURE;
+		}
+		nextMessage[thread]++;
+	}
+	for (int t = 0; t < THREAD_COUNT; t++)
+	{
+		if (nextMessage[t] != MESSAGE_COUNT)
+		{
+			LogError("Only %d of %d messages from thread %d written", nextMessage[t], MESSAGE_COUNT,
+			         t);
+			return EXIT_FAILURE;
+		}
+	}
+
+	time_logging();
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,230 @@
+#include "framework/configfile.h"
+#include "framework/logger.h"
+#include "framework/sound/mixer.h"
+#include "library/xorshift.h"
+#include <chrono>
+#include <random>
+#include <thread>
+
+using namespace OpenApoc;
+
+static sp<MixerSampleData> make_sample(unsigned int length, int16_t value)
+{
+	auto data = mksp<MixerSampleData>();
+	data->samples.resize(length, value);
+	return data;
+}
+
+static bool check_kernels()
+{
+	Xorshift128Plus<uint32_t> rng{};
+	std::uniform_int_distribution<int> valueDist(INT16_MIN, INT16_MAX);
+	// Odd sizes, so the non-vectorised tail gets used too
+	for (unsigned int count : {1u, 7u, 8u, 9u, 63u, 1024u, 1031u})
+	{
+		std::vector<int16_t> first(count), second(count), output(count);
+		for (unsigned int i = 0; i < count; i++)
+		{
+			first[i] = (int16_t)valueDist(rng);
+			second[i] = (int16_t)valueDist(rng);
+		}
+		std::vector<int32_t> accumulator(count, 0);
+		SoftwareMixer::accumulate(accumulator.data(), first.data(), count, 256);
+		SoftwareMixer::accumulate(accumulator.data(), second.data(), count, 200);
+		SoftwareMixer::clampToOutput(output.data(), accumulator.data(), count);
+		for (unsigned int i = 0; i < count; i++)
+		{
+			int expected = (first[i] * 256 + second[i] * 200) >> SoftwareMixer::GAIN_BITS;
+			expected = std::min(std::max(expected, (int)INT16_MIN), (int)INT16_MAX);
+			if (output[i] != expected)
+			{
+				LogError("Mixed value %u of %u was %d, expected %d", i, count, (int)output[i],
+				         expected);
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+static bool check_voices()
+{
+	SoftwareMixer mixer;
+	std::vector<int16_t> output(16);
+
+	// A short sample should stop partway through a buffer, and free its voice
+	mixer.playSample(make_sample(10, 1000), 1.0f);
+	mixer.mix(output.data(), output.size(), 1.0f, nullptr, 1.0f);
+	if (output[9] != 1000 || output[10] != 0 || mixer.getVoicesPlaying() != 0)
+	{
+		LogError("Short sample not mixed correctly");
+		return false;
+	}
+
+	// Fill every voice with silence at half volume
+	for (int i = 0; i < SoftwareMixer::VOICE_COUNT; i++)
+	{
+		mixer.playSample(make_sample(100000, 0), 0.5f);
+	}
+	mixer.mix(output.data(), output.size(), 1.0f, nullptr, 1.0f);
+	if (mixer.getVoicesPlaying() != SoftwareMixer::VOICE_COUNT)
+	{
+		LogError("Expected all %d voices playing, got %d", SoftwareMixer::VOICE_COUNT,
+		         mixer.getVoicesPlaying());
+		return false;
+	}
+	// Something quieter than everything playing gets dropped
+	mixer.playSample(make_sample(100, 1000), 0.25f);
+	mixer.mix(output.data(), output.size(), 1.0f, nullptr, 1.0f);
+	if (output[0] != 0)
+	{
+		LogError("Quiet sample should have been dropped");
+		return false;
+	}
+	// But something louder takes a voice
+	mixer.playSample(make_sample(100, 1000), 1.0f);
+	mixer.mix(output.data(), output.size(), 1.0f, nullptr, 1.0f);
+	if (output[0] != 1000 || mixer.getVoicesPlaying() != SoftwareMixer::VOICE_COUNT)
+	{
+		LogError("Loud sample should have stolen a voice");
+		return false;
+	}
+	return true;
+}
+
+static bool check_threaded()
+{
+	// The game thread submitting while the audio thread mixes
+	SoftwareMixer mixer;
+	std::atomic<bool> finished(false);
+	std::thread producer([&mixer, &finished]() {
+		auto sample = make_sample(300, 10);
+		for (int i = 0; i < 20000; i++)
+		{
+			while (!mixer.playSample(sample, 1.0f))
+			{
+				std::this_thread::yield();
+			}
+		}
+		finished = true;
+	});
+	std::vector<int16_t> output(512);
+	while (!finished)
+	{
+		mixer.mix(output.data(), output.size(), 1.0f, nullptr, 1.0f);
+	}
+	producer.join();
+	// Mix until everything queued has finished playing
+	for (int i = 0; i < 10; i++)
+	{
+		mixer.mix(output.data(), output.size(), 1.0f, nullptr, 1.0f);
+	}
+	if (mixer.getVoicesPlaying() != 0 || output[0] != 0)
+	{
+		LogError("Voices left playing after threaded test");
+		return false;
+	}
+	return true;
+}
+
+static bool check_ring_buffer()
+{
+	MusicRingBuffer ring(1000);
+	if (ring.capacity() != 1024)
+	{
+		LogError("Ring buffer capacity %u, expected 1024", (unsigned int)ring.capacity());
+		return false;
+	}
+
+	// Stream a run of values through it while reading on another thread, in odd sized pieces so
+	// they wrap round at different places
+	const int total = 200000;
+	std::thread writer([&ring]() {
+		std::vector<int16_t> values(300);
+		int next = 0;
+		while (next < total)
+		{
+			size_t count = std::min((size_t)(total - next), (size_t)(next % 299 + 1));
+			for (size_t i = 0; i < count; i++)
+				values[i] = (int16_t)(next + i);
+			auto written = ring.write(values.data(), count);
+			next += (int)written;
+			if (written == 0)
+				std::this_thread::yield();
+		}
+	});
+	std::vector<int16_t> values(300);
+	int expected = 0;
+	while (expected < total)
+	{
+		auto count = ring.read(values.data(), expected % 257 + 1);
+		for (size_t i = 0; i < count; i++)
+		{
+			if (values[i] != (int16_t)expected)
+			{
+				LogError("Read %d from ring buffer, expected %d", (int)values[i], expected);
+				writer.join();
+				return false;
+			}
+			expected++;
+		}
+	}
+	writer.join();
+
+	// Flushing drops what's been written so far, but not what's written after
+	std::vector<int16_t> first(100, 1), second(50, 2);
+	ring.write(first.data(), first.size());
+	ring.flush();
+	ring.write(second.data(), second.size());
+	if (ring.getAvailable() != second.size() ||
+	    ring.read(values.data(), values.size()) != second.size() || values[0] != 2)
+	{
+		LogError("Flushed ring buffer didn't just return the values written after");
+		return false;
+	}
+	return true;
+}
+
+static void time_mixing()
+{
+	// No device, the output just gets thrown away
+	SoftwareMixer mixer;
+	const unsigned int buffer_size = 1024;
+	const int buffers = 2000;
+	std::vector<int16_t> output(buffer_size);
+	std::vector<int16_t> music(buffer_size, 100);
+	auto sample = make_sample(buffer_size * buffers, 100);
+	for (int i = 0; i < SoftwareMixer::VOICE_COUNT; i++)
+	{
+		mixer.playSample(sample, 0.5f);
+	}
+	auto start = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < buffers; i++)
+	{
+		mixer.mix(output.data(), buffer_size, 1.0f, music.data(), 1.0f);
+	}
+	auto end = std::chrono::high_resolution_clock::now();
+	auto micros = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+	LogInfo("Mixed %d voices plus music: %f us per %u value buffer",
+	        SoftwareMixer::VOICE_COUNT, (float)micros / buffers, buffer_size);
+}
+
+int main(int argc, char **argv)
+{
+	if (config().parseOptions(argc, argv))
+	{
+		return EXIT_FAILURE;
+	}
+
+	if (!check_kernels())
+		return EXIT_FAILURE;
+	if (!check_voices())
+		return EXIT_FAILURE;
+	if (!check_threaded())
+		return EXIT_FAILURE;
+	if (!check_ring_buffer())
+		return EXIT_FAILURE;
+	time_mixing();
+
+	return EXIT_SUCCESS;
+}
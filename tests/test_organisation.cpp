@@ -0,0 +1,118 @@
+#include "framework/configfile.h"
+#include "framework/logger.h"
+#include "game/state/gamestate.h"
+#include "game/state/organisation.h"
+#include "library/strings_format.h"
+#include <chrono>
+
+using namespace OpenApoc;
+
+static void check_relation(const StateRef<Organisation> &org, const StateRef<Organisation> &other,
+                           Organisation::Relation expected)
+{
+	auto relation = org->isRelatedTo(other);
+	if (relation != expected)
+	{
+		LogError("%s to %s has relation %d, expected %d", org.id, other.id, (int)relation,
+		         (int)expected);
+		exit(EXIT_FAILURE);
+	}
+	auto uncached = Organisation::getRelationFromValue(org->calculateRelationTo(other));
+	if (relation != uncached)
+	{
+		LogError("%s to %s has cached relation %d, but calculated %d", org.id, other.id,
+		         (int)relation, (int)uncached);
+		exit(EXIT_FAILURE);
+	}
+}
+
+// Returns the time taken for 'iterations' passes over every pair of organisations
+static std::chrono::duration<double> time_relations(GameState &state, int iterations)
+{
+	std::vector<StateRef<Organisation>> orgs;
+	for (auto &o : state.organisations)
+	{
+		orgs.emplace_back(&state, o.first);
+	}
+	int hostileCount = 0;
+	auto start = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < iterations; i++)
+	{
+		for (auto &org : orgs)
+		{
+			for (auto &other : orgs)
+			{
+				if (org->isRelatedTo(other) == Organisation::Relation::Hostile)
+				{
+					hostileCount++;
+				}
+			}
+		}
+	}
+	auto end = std::chrono::high_resolution_clock::now();
+	LogInfo("%d hostile relations", hostileCount);
+	return end - start;
+}
+
+int main(int argc, char **argv)
+{
+	if (config().parseOptions(argc, argv))
+	{
+		return EXIT_FAILURE;
+	}
+
+	auto state = mksp<GameState>();
+	for (auto &id : {"ORG_ALIEN", "ORG_X-COM", "ORG_MEGAPOL", "ORG_CULT"})
+	{
+		auto org = mksp<Organisation>();
+		org->name = id;
+		state->organisations[id] = org;
+	}
+	state->organisations["ORG_ALIEN"]->name = "Alien";
+
+	StateRef<Organisation> alien{state.get(), "ORG_ALIEN"};
+	StateRef<Organisation> xcom{state.get(), "ORG_X-COM"};
+	StateRef<Organisation> megapol{state.get(), "ORG_MEGAPOL"};
+	StateRef<Organisation> cult{state.get(), "ORG_CULT"};
+
+	xcom->current_relations[megapol] = 30.0f;
+	xcom->current_relations[cult] = -60.0f;
+	megapol->current_relations[cult] = -30.0f;
+
+	state->updateOrganisationRelations();
+
+	check_relation(xcom, xcom, Organisation::Relation::Friendly);
+	check_relation(xcom, alien, Organisation::Relation::Hostile);
+	check_relation(alien, megapol, Organisation::Relation::Hostile);
+	check_relation(xcom, megapol, Organisation::Relation::Friendly);
+	check_relation(xcom, cult, Organisation::Relation::Hostile);
+	check_relation(megapol, cult, Organisation::Relation::Unfriendly);
+	check_relation(cult, xcom, Organisation::Relation::Neutral);
+
+	// Changes are only picked up once the cache is rebuilt
+	cult->current_relations[xcom] = -100.0f;
+	state->updateOrganisationRelations();
+	check_relation(cult, xcom, Organisation::Relation::Hostile);
+
+	// Compare against the uncached lookup, with enough organisations to resemble a city
+	for (int i = 0; i < 32; i++)
+	{
+		auto id = format("ORG_TEST_%d", i);
+		auto org = mksp<Organisation>();
+		org->name = id;
+		state->organisations[id] = org;
+		org->current_relations[xcom] = (float)(i * 7 % 200) - 100.0f;
+	}
+	state->updateOrganisationRelations();
+	auto cachedTime = time_relations(*state, 1000);
+	for (auto &o : state->organisations)
+	{
+		o.second->relationCache.clear();
+		o.second->relationTypeCache.clear();
+	}
+	auto uncachedTime = time_relations(*state, 1000);
+	LogInfo("Relation lookups took %fs cached, %fs uncached", cachedTime.count(),
+	        uncachedTime.count());
+
+	return EXIT_SUCCESS;
+}
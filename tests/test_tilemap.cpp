@@ -53,6 +53,53 @@ static void test_collision(const TileMap &map, Vec3<float> line_start, Vec3<floa
 	}
 }
 
+static void test_nav_grid(TileMap &map)
+{
+	auto &nav = map.navGrid;
+	Vec3<int> pos = {10, 20, 3};
+	auto index = nav.getIndex(pos);
+	if (nav.getPosition(index) != pos)
+	{
+		LogError("Nav grid index %d maps back to %s, expected %s", index, nav.getPosition(index),
+		         pos);
+		exit(EXIT_FAILURE);
+	}
+
+	auto tile = map.getTile(pos);
+	tile->movementCostIn = 8;
+	tile->movementCostLeft = 255;
+	tile->closedDoorRight = true;
+	tile->canStand = true;
+	tile->height = 27.0f / 40.0f;
+	nav.update(*tile);
+	if (nav.getMovementCostIn(index) != 8 || nav.getMovementCostLeft(index) != 255 ||
+	    nav.getMovementCostRight(index) != 0 || nav.getClosedDoorLeft(index) ||
+	    !nav.getClosedDoorRight(index) || !nav.getCanStand(index) || nav.getSolidGround(index) ||
+	    nav.getHasLift(index) || nav.getUnitPresent(index) || nav.getHeight(index) != tile->height)
+	{
+		LogError("Nav grid doesn't match tile at %s", pos);
+		exit(EXIT_FAILURE);
+	}
+	if (!nav.getPassable(pos, false, 0) || !nav.getCanStand(pos, false))
+	{
+		LogError("Tile at %s should be passable", pos);
+		exit(EXIT_FAILURE);
+	}
+	// Large units also need the left wall to be passable
+	if (nav.getPassable(pos, true, 0))
+	{
+		LogError("Tile at %s should not be passable for large units", pos);
+		exit(EXIT_FAILURE);
+	}
+	tile->movementCostIn = 255;
+	nav.update(*tile);
+	if (nav.getPassable(pos, false, 0) || tile->getPassable(false, 0))
+	{
+		LogError("Tile at %s should not be passable", pos);
+		exit(EXIT_FAILURE);
+	}
+}
+
 int main(int argc, char **argv)
 {
 	if (config().parseOptions(argc, argv))
@@ -123,5 +170,7 @@ int main(int argc, char **argv)
 		test_collision(map, collision.first[0], collision.first[1], collision.second);
 	}
 
+	test_nav_grid(map);
+
 	return EXIT_SUCCESS;
 }
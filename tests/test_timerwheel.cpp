@@ -0,0 +1,110 @@
+#include "framework/configfile.h"
+#include "framework/logger.h"
+#include "library/timerwheel.h"
+#include "library/xorshift.h"
+#include <random>
+
+using namespace OpenApoc;
+
+class TestTimer
+{
+  public:
+	uint64_t due = 0;
+	int fired = 0;
+	// If non-zero, reschedule this many ticks after firing, once
+	uint64_t repeatDelay = 0;
+};
+
+static bool check_fired(const std::vector<sp<TestTimer>> &timers, uint64_t tick)
+{
+	for (auto &t : timers)
+	{
+		int expected = t->due <= tick ? 1 : 0;
+		if (t->fired != expected)
+		{
+			LogError("Timer due at %llu fired %d times by tick %llu", (unsigned long long)t->due,
+			         t->fired, (unsigned long long)tick);
+			return false;
+		}
+	}
+	return true;
+}
+
+int main(int argc, char **argv)
+{
+	if (config().parseOptions(argc, argv))
+	{
+		return EXIT_FAILURE;
+	}
+
+	Xorshift128Plus<uint32_t> rng{};
+	TimerWheel<TestTimer> wheel;
+	std::vector<sp<TestTimer>> timers;
+	auto fire = [&wheel](const sp<TestTimer> &t) {
+		if (t->due != wheel.getTick())
+		{
+			LogError("Timer due at %llu fired at %llu", (unsigned long long)t->due,
+			         (unsigned long long)wheel.getTick());
+			exit(EXIT_FAILURE);
+		}
+		t->fired++;
+		if (t->repeatDelay)
+		{
+			t->due += t->repeatDelay;
+			t->repeatDelay = 0;
+			t->fired--;
+			wheel.schedule(t, t->due - wheel.getTick());
+		}
+	};
+
+	// Delays covering every level of the wheel, and past the top of it
+	std::vector<uint64_t> delays = {0, 1, 2, 63, 64, 65, 4095, 4096, 4097, 262143, 262144, 262145,
+	                                16777215, 16777216, 16777217, 20000000};
+	std::uniform_int_distribution<uint32_t> delayDist(1, 300000);
+	for (int i = 0; i < 1000; i++)
+	{
+		delays.push_back(delayDist(rng));
+	}
+	for (auto delay : delays)
+	{
+		auto t = mksp<TestTimer>();
+		t->due = delay > 0 ? delay : 1;
+		wheel.schedule(t, delay);
+		timers.push_back(t);
+	}
+	// Some timers reschedule themselves when they fire
+	for (int i = 0; i < 50; i++)
+	{
+		timers[i]->repeatDelay = delayDist(rng);
+	}
+	// Timers whose object has gone should never fire
+	for (int i = 0; i < 10; i++)
+	{
+		auto t = mksp<TestTimer>();
+		wheel.schedule(t, delayDist(rng));
+	}
+
+	std::uniform_int_distribution<uint32_t> stepDist(1, 5000);
+	while (wheel.getTick() < 20400000)
+	{
+		wheel.advance(stepDist(rng), fire);
+		if (!check_fired(timers, wheel.getTick()))
+		{
+			return EXIT_FAILURE;
+		}
+	}
+	// A single long advance should fire everything scheduled in it too
+	for (auto &t : timers)
+	{
+		t->fired = 0;
+		t->due = wheel.getTick() + delayDist(rng);
+		wheel.schedule(t, t->due - wheel.getTick());
+	}
+	wheel.advance(400000, fire);
+	if (!check_fired(timers, wheel.getTick()))
+	{
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
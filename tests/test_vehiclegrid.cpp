@@ -0,0 +1,196 @@
+#include "framework/configfile.h"
+#include "framework/logger.h"
+#include "game/state/city/city.h"
+#include "game/state/city/vehicle.h"
+#include "game/state/city/vehiclegrid.h"
+#include "game/state/gamestate.h"
+#include "game/state/organisation.h"
+#include "game/state/rules/vehicle_type.h"
+#include "game/state/tileview/tile.h"
+#include "game/state/tileview/tileobject_vehicle.h"
+#include "library/strings_format.h"
+#include <algorithm>
+#include <cfloat>
+
+using namespace OpenApoc;
+
+static sp<Vehicle> add_vehicle(GameState &state, const UString &id,
+                               const StateRef<Organisation> &owner, Vec3<float> position)
+{
+	auto v = mksp<Vehicle>();
+	v->name = id;
+	v->type = {&state, "VEHICLETYPE_TEST"};
+	v->owner = owner;
+	v->city = {&state, "CITYMAP_TEST"};
+	// The vehicle's tile object picks its voxel map facing from the velocity
+	v->velocity = {1, 0, 0};
+	v->health = 100;
+	v->position = position;
+	state.vehicles[id] = v;
+	v->city->map->addObjectToMap(v);
+	v->setPosition(position);
+	return v;
+}
+
+static void check_closest(const VehicleGrid &grid, const sp<Vehicle> &vehicle, float range,
+                          const sp<Vehicle> &expected)
+{
+	auto closest = grid.findClosestHostile(*vehicle, range);
+	if (closest != expected)
+	{
+		LogError("Closest hostile to %s in range %f was %s, expected %s", vehicle->name, range,
+		         closest ? closest->name : "NONE", expected ? expected->name : "NONE");
+		exit(EXIT_FAILURE);
+	}
+}
+
+static void check_in_radius(const VehicleGrid &grid, Vec3<float> position, float range,
+                            const std::vector<sp<Vehicle>> &expected)
+{
+	auto found = grid.findInRadius(position, range);
+	bool match = found.size() == expected.size();
+	for (auto &v : expected)
+	{
+		if (std::find(found.begin(), found.end(), v) == found.end())
+			match = false;
+	}
+	if (!match)
+	{
+		LogError("Found %u vehicles within %f of {%f,%f,%f}, expected %u", (unsigned)found.size(),
+		         range, position.x, position.y, position.z, (unsigned)expected.size());
+		exit(EXIT_FAILURE);
+	}
+}
+
+// Compares the grid search against checking every vehicle in the city
+static void check_against_all(GameState &state, const VehicleGrid &grid, float range)
+{
+	for (auto &vp : state.vehicles)
+	{
+		auto &vehicle = vp.second;
+		float closestDistance = FLT_MAX;
+		for (auto &op : state.vehicles)
+		{
+			auto &other = op.second;
+			if (other == vehicle || !other->tileObject || other->isCrashed() ||
+			    vehicle->owner->isRelatedTo(other->owner) != Organisation::Relation::Hostile)
+				continue;
+			closestDistance =
+			    std::min(closestDistance, vehicle->tileObject->getDistanceTo(other->tileObject));
+		}
+		auto closest = grid.findClosestHostile(*vehicle, range);
+		if (closestDistance > range)
+		{
+			if (closest)
+			{
+				LogError("Found %s for %s in range %f, but nothing is in range", closest->name,
+				         vehicle->name, range);
+				exit(EXIT_FAILURE);
+			}
+		}
+		else if (!closest ||
+		         vehicle->tileObject->getDistanceTo(closest->tileObject) != closestDistance)
+		{
+			LogError("Found %s for %s in range %f, expected something %f away",
+			         closest ? closest->name : "NONE", vehicle->name, range, closestDistance);
+			exit(EXIT_FAILURE);
+		}
+	}
+}
+
+int main(int argc, char **argv)
+{
+	if (config().parseOptions(argc, argv))
+	{
+		return EXIT_FAILURE;
+	}
+
+	auto state = mksp<GameState>();
+	for (auto &id : {"ORG_ALIEN", "ORG_X-COM", "ORG_CIVILIAN"})
+	{
+		auto org = mksp<Organisation>();
+		org->name = id;
+		state->organisations[id] = org;
+	}
+	StateRef<Organisation> alien{state.get(), "ORG_ALIEN"};
+	StateRef<Organisation> xcom{state.get(), "ORG_X-COM"};
+	StateRef<Organisation> civilian{state.get(), "ORG_CIVILIAN"};
+	xcom->current_relations[alien] = -100.0f;
+	alien->current_relations[xcom] = -100.0f;
+	state->updateOrganisationRelations();
+
+	auto type = mksp<VehicleType>();
+	type->name = "TEST";
+	type->size[{1, 0, 0}] = {1, 1, 1};
+	type->crash_health = 10;
+	state->vehicle_types["VEHICLETYPE_TEST"] = type;
+
+	auto city = mksp<City>();
+	city->size = {64, 64, 10};
+	state->cities["CITYMAP_TEST"] = city;
+	city->initMap();
+	auto &grid = *city->vehicleGrid;
+
+	// Distances are in city units, 32 per tile horizontally
+	auto xcom1 = add_vehicle(*state, "VEHICLE_XCOM_1", xcom, {10.5f, 10.5f, 5.5f});
+	auto neutral = add_vehicle(*state, "VEHICLE_CIVILIAN_1", civilian, {11.5f, 10.5f, 5.5f});
+	auto alien1 = add_vehicle(*state, "VEHICLE_ALIEN_1", alien, {14.5f, 10.5f, 5.5f});
+	auto alien2 = add_vehicle(*state, "VEHICLE_ALIEN_2", alien, {30.5f, 10.5f, 5.5f});
+
+	check_closest(grid, xcom1, 1000.0f, alien1);
+	check_closest(grid, xcom1, 128.0f, alien1);
+	check_closest(grid, xcom1, 100.0f, nullptr);
+	// Neither itself nor the other alien is hostile
+	check_closest(grid, alien1, 1000.0f, xcom1);
+	check_closest(grid, neutral, 1000.0f, nullptr);
+
+	// Crashed vehicles are skipped
+	alien1->health = 5;
+	check_closest(grid, xcom1, 1000.0f, alien2);
+	check_closest(grid, xcom1, 500.0f, nullptr);
+	alien1->health = 100;
+
+	check_in_radius(grid, xcom1->position, 40.0f, {xcom1, neutral});
+	check_in_radius(grid, xcom1->position, 1000.0f, {xcom1, neutral, alien1, alien2});
+
+	// Moving between cells re-indexes the vehicle
+	auto oldCell = alien2->indexedCell;
+	alien2->setPosition({11.5f, 12.5f, 5.5f});
+	if (alien2->indexedCell == oldCell || alien2->indexedGrid.lock() != city->vehicleGrid)
+	{
+		LogError("%s still indexed in cell %d after moving", alien2->name, oldCell);
+		return EXIT_FAILURE;
+	}
+	check_closest(grid, xcom1, 1000.0f, alien2);
+	check_in_radius(grid, {30.5f, 10.5f, 5.5f}, 40.0f, {});
+
+	// Removed vehicles are no longer found
+	grid.remove(*alien2);
+	if (alien2->indexedCell != -1 || alien2->indexedGrid.lock())
+	{
+		LogError("%s still indexed in cell %d after removal", alien2->name, alien2->indexedCell);
+		return EXIT_FAILURE;
+	}
+	check_closest(grid, xcom1, 1000.0f, alien1);
+	check_in_radius(grid, xcom1->position, 1000.0f, {xcom1, neutral, alien1});
+	// ... until they next move
+	alien2->setPosition({11.5f, 11.5f, 5.5f});
+	check_closest(grid, xcom1, 1000.0f, alien2);
+
+	// Spread enough vehicles over the map to cover every ring of the search
+	for (int i = 0; i < 64; i++)
+	{
+		auto owner = (i % 3 == 0) ? alien : (i % 3 == 1) ? xcom : civilian;
+		Vec3<float> position = {(float)(i * 37 % 64) + 0.5f, (float)(i * 23 % 64) + 0.5f,
+		                        (float)(i % 8) + 0.5f};
+		auto v = add_vehicle(*state, format("VEHICLE_TEST_%d", i), owner, position);
+		if (i % 7 == 0)
+			v->health = 5;
+	}
+	for (auto range : {50.0f, 200.0f, 500.0f, 3000.0f})
+	{
+		check_against_all(*state, grid, range);
+	}
+
+	return EXIT_SUCCESS;
+}
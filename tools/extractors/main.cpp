@@ -8,13 +8,51 @@
 #include "game/state/gamestate.h"
 #include "library/strings_format.h"
 #include "tools/extractors/extractors.h"
+#include "tools/extractors/manifest.h"
 #include <SDL_main.h>
+#include <algorithm>
+#include <atomic>
 #include <list>
+#include <set>
+#include <thread>
+#include <vector>
 
 using namespace OpenApoc;
 
+// One independent piece of an extractor's work, which can run alongside any other
+class ExtractJob
+{
+  public:
+	UString name;
+	// Paths in the data filesystem (files, or whole directories) the job reads from. If none of
+	// them have changed since it last ran it's skipped
+	std::vector<UString> inputs;
+	// Adds each path it writes to 'outputs', so they can be checked for next time
+	std::function<void(std::vector<UString> &outputs)> run;
+	// Whole game states take far longer than anything else, so they get started first rather
+	// than being left to finish on their own at the end
+	bool large;
+	// Filled in once every job has been added
+	UString extractor;
+	UString inputHash;
+	ExtractJob(UString name, std::vector<UString> inputs,
+	           std::function<void(std::vector<UString> &outputs)> run, bool large = false)
+	    : name(name), inputs(inputs), run(run), large(large)
+	{
+	}
+};
+
+using ExtractorFn =
+    std::function<void(const InitialGameStateExtractor &e, std::vector<ExtractJob> &jobs)>;
+
+// Everything in battle comes from these, and the game states from those and the maps
+static const std::vector<UString> battleInputs = {"xcom3/tacdata", "xcom3/ufodata"};
+static const std::vector<UString> gameStateInputs = {"xcom3/tacdata", "xcom3/ufodata",
+                                                     "xcom3/maps", "common_patch"};
+
 static void extractDifficulty(const InitialGameStateExtractor &e, UString outputPath,
-                              InitialGameStateExtractor::Difficulty difficulty, UString patchPath)
+                              InitialGameStateExtractor::Difficulty difficulty, UString patchPath,
+                              std::vector<UString> &outputs)
 {
 	GameState s;
 	e.extract(s, difficulty);
@@ -23,226 +61,361 @@ static void extractDifficulty(const InitialGameStateExtractor &e, UString output
 	{
 		s.loadGame(patchPath);
 	}
-	s.saveGame(outputPath, true);
+	if (s.saveGame(outputPath, true))
+	{
+		outputs.push_back(outputPath);
+	}
+}
+
+static void addDifficulty(std::vector<ExtractJob> &jobs, const InitialGameStateExtractor &e,
+                          const UString &name, InitialGameStateExtractor::Difficulty difficulty)
+{
+	auto inputs = gameStateInputs;
+	inputs.push_back(name + "_patch");
+	jobs.emplace_back(name, inputs,
+	                  [&e, name, difficulty](std::vector<UString> &outputs) {
+		                  extractDifficulty(e, "data/" + name + "_patched", difficulty,
+		                                    "data/" + name + "_patch", outputs);
+		              },
+	                  true);
+}
+
+static void extractImagePack(const InitialGameStateExtractor &e, const UString &name,
+                             const UString &path, bool shadow, std::vector<UString> &outputs)
+{
+	GameState s;
+	LogInfo("Extracting image pack \"%s\"", name);
+
+	auto imagePack = e.extractImagePack(s, path, shadow);
+	if (!imagePack)
+	{
+		LogError("Failed to extract image pack \"%s\"", name);
+	}
+	else
+	{
+		auto outputPath = BattleUnitImagePack::getImagePackPath() + "/" + name;
+		if (!imagePack->saveImagePack(outputPath, true))
+		{
+			LogError("Failed to save image pack \"%s\"", name);
+		}
+		else
+		{
+			outputs.push_back(outputPath);
+		}
+	}
+}
+
+static void addImagePacks(std::vector<ExtractJob> &jobs, const InitialGameStateExtractor &e,
+                          const std::map<UString, UString> &paths, bool shadow)
+{
+	for (auto &imagePackStrings : paths)
+	{
+		auto name = imagePackStrings.first;
+		auto path = imagePackStrings.second;
+		jobs.emplace_back("image pack " + name, battleInputs,
+		                  [&e, name, path, shadow](std::vector<UString> &outputs) {
+			                  extractImagePack(e, name, path, shadow, outputs);
+			              });
+	}
+}
+
+static void extractItemImagePack(const InitialGameStateExtractor &e, int i,
+                                 std::vector<UString> &outputs)
+{
+	GameState s;
+	LogInfo("Extracting item image pack \"%d\"", i);
+
+	auto imagePack = e.extractItemImagePack(s, i);
+	if (!imagePack)
+	{
+		LogError("Failed to extract  item image pack \"%d\"", i);
+	}
+	else
+	{
+		auto outputPath = format("%s%s%d", BattleUnitImagePack::getImagePackPath(), "/item", i);
+		if (!imagePack->saveImagePack(outputPath, true))
+		{
+			LogError("Failed to save  item image pack \"%d\"", i);
+		}
+		else
+		{
+			outputs.push_back(outputPath);
+		}
+	}
+}
+
+static void extractAnimationPack(const InitialGameStateExtractor &e, const UString &name,
+                                 const UString &path, std::vector<UString> &outputs)
+{
+	GameState s;
+	LogInfo("Extracting animation pack \"%s\"", name);
+
+	auto animationPack = e.extractAnimationPack(s, path, name);
+	if (!animationPack)
+	{
+		LogError("Failed to extract animation pack \"%s\"", name);
+	}
+	else
+	{
+		auto outputPath = BattleUnitAnimationPack::getAnimationPackPath() + "/" + name;
+		if (!animationPack->saveAnimationPack(outputPath, true))
+		{
+			LogError("Failed to save animation pack \"%s\"", name);
+		}
+		else
+		{
+			outputs.push_back(outputPath);
+		}
+	}
+}
+
+static void extractTileSet(const InitialGameStateExtractor &e, const UString &tileSetName,
+                           std::vector<UString> &outputs)
+{
+	GameState s;
+	LogInfo("Extracting tileset \"%s\"", tileSetName);
+
+	auto tileSet = e.extractTileSet(s, tileSetName);
+	if (!tileSet)
+	{
+		LogError("Failed to extract tileset \"%s\"", tileSetName);
+	}
+	else
+	{
+		auto outputPath = BattleMapTileset::getTilesetPath() + "/" + tileSetName;
+		if (!tileSet->saveTileset(outputPath, true))
+		{
+			LogError("Failed to save tileset \"%s\"", tileSetName);
+		}
+		else
+		{
+			outputs.push_back(outputPath);
+		}
+	}
+}
+
+static void extractMapSectors(const InitialGameStateExtractor &e, const UString &mapName,
+                              std::vector<UString> &outputs)
+{
+	GameState s;
+	LogInfo("Extracting map sectors from \"%s\"", mapName);
+
+	auto sectors = e.extractMapSectors(s, mapName);
+	LogInfo("Extracted %u sectors from \"%s\"", (unsigned)sectors.size(), mapName);
+	if (sectors.empty())
+	{
+		LogError("Failed to sectors from map \"%s\"", mapName);
+	}
+	for (auto &sectorPair : sectors)
+	{
+		auto &sectorName = sectorPair.first;
+		auto &sector = sectorPair.second;
+		auto outputPath = BattleMapSectorTiles::getMapSectorPath() + "/" + sectorName;
+		if (!sector->saveSector(outputPath, true))
+		{
+			LogError("Failed to save map sector \"%s\"", sectorName);
+		}
+		else
+		{
+			outputs.push_back(outputPath);
+		}
+	}
 }
 
-std::map<UString, std::function<void(const InitialGameStateExtractor &e)>> thingsToExtract = {
+static void writeBulletSprites(const std::map<UString, sp<Image>> &bullet_sprites,
+                               sp<Palette> palette, std::vector<UString> &outputs)
+{
+	for (auto &sprite_pair : bullet_sprites)
+	{
+		auto path = "data/" + sprite_pair.first;
+		if (fw().data->writeImage(path, sprite_pair.second, palette))
+		{
+			outputs.push_back(path);
+		}
+	}
+}
+
+std::map<UString, ExtractorFn> thingsToExtract = {
     {"difficulty1",
-     [](const InitialGameStateExtractor &e) {
-	     extractDifficulty(e, "data/difficulty1_patched",
-	                       InitialGameStateExtractor::Difficulty::DIFFICULTY_1,
-	                       "data/difficulty1_patch");
+     [](const InitialGameStateExtractor &e, std::vector<ExtractJob> &jobs) {
+	     addDifficulty(jobs, e, "difficulty1", InitialGameStateExtractor::Difficulty::DIFFICULTY_1);
 	 }},
     {"difficulty2",
-     [](const InitialGameStateExtractor &e) {
-	     extractDifficulty(e, "data/difficulty2_patched",
-	                       InitialGameStateExtractor::Difficulty::DIFFICULTY_2,
-	                       "data/difficulty2_patch");
+     [](const InitialGameStateExtractor &e, std::vector<ExtractJob> &jobs) {
+	     addDifficulty(jobs, e, "difficulty2", InitialGameStateExtractor::Difficulty::DIFFICULTY_2);
 	 }},
     {"difficulty3",
-     [](const InitialGameStateExtractor &e) {
-	     extractDifficulty(e, "data/difficulty3_patched",
-	                       InitialGameStateExtractor::Difficulty::DIFFICULTY_3,
-	                       "data/difficulty3_patch");
+     [](const InitialGameStateExtractor &e, std::vector<ExtractJob> &jobs) {
+	     addDifficulty(jobs, e, "difficulty3", InitialGameStateExtractor::Difficulty::DIFFICULTY_3);
 	 }},
     {"difficulty4",
-     [](const InitialGameStateExtractor &e) {
-	     extractDifficulty(e, "data/difficulty4_patched",
-	                       InitialGameStateExtractor::Difficulty::DIFFICULTY_4,
-	                       "data/difficulty4_patch");
+     [](const InitialGameStateExtractor &e, std::vector<ExtractJob> &jobs) {
+	     addDifficulty(jobs, e, "difficulty4", InitialGameStateExtractor::Difficulty::DIFFICULTY_4);
 	 }},
     {"difficulty5",
-     [](const InitialGameStateExtractor &e) {
-	     extractDifficulty(e, "data/difficulty5_patched",
-	                       InitialGameStateExtractor::Difficulty::DIFFICULTY_5,
-	                       "data/difficulty5_patch");
+     [](const InitialGameStateExtractor &e, std::vector<ExtractJob> &jobs) {
+	     addDifficulty(jobs, e, "difficulty5", InitialGameStateExtractor::Difficulty::DIFFICULTY_5);
 	 }},
     {"common_gamestate",
-     [](const InitialGameStateExtractor &e) {
-	     GameState s;
-	     e.extractCommon(s);
-	     s.loadGame("data/common_patch");
-	     s.saveGame("data/gamestate_common");
+     [](const InitialGameStateExtractor &e, std::vector<ExtractJob> &jobs) {
+	     jobs.emplace_back("common_gamestate", gameStateInputs,
+	                       [&e](std::vector<UString> &outputs) {
+		                       GameState s;
+		                       e.extractCommon(s);
+		                       s.loadGame("data/common_patch");
+		                       if (s.saveGame("data/gamestate_common"))
+		                       {
+			                       outputs.push_back("data/gamestate_common");
+		                       }
+		                   },
+	                       true);
 	 }},
     {"city_bullet_sprites",
-     [](const InitialGameStateExtractor &e) {
-	     auto bullet_sprites = e.extractBulletSpritesCity();
-
-	     for (auto &sprite_pair : bullet_sprites)
-	     {
-		     auto path = "data/" + sprite_pair.first;
-		     fw().data->writeImage(path, sprite_pair.second);
-	     }
+     [](const InitialGameStateExtractor &e, std::vector<ExtractJob> &jobs) {
+	     jobs.emplace_back("city_bullet_sprites", battleInputs,
+	                       [&e](std::vector<UString> &outputs) {
+		                       writeBulletSprites(e.extractBulletSpritesCity(), nullptr, outputs);
+		                   });
 	 }},
     {"battle_bullet_sprites",
-     [](const InitialGameStateExtractor &e) {
-	     auto bullet_sprites = e.extractBulletSpritesBattle();
-
-	     for (auto &sprite_pair : bullet_sprites)
-	     {
-		     auto path = "data/" + sprite_pair.first;
-		     fw().data->writeImage(path, sprite_pair.second,
-		                           fw().data->loadPalette("xcom3/tacdata/tactical.pal"));
-	     }
+     [](const InitialGameStateExtractor &e, std::vector<ExtractJob> &jobs) {
+	     jobs.emplace_back("battle_bullet_sprites", battleInputs,
+	                       [&e](std::vector<UString> &outputs) {
+		                       writeBulletSprites(
+		                           e.extractBulletSpritesBattle(),
+		                           fw().data->loadPalette("xcom3/tacdata/tactical.pal"), outputs);
+		                   });
 	 }},
     {"unit_image_packs",
-     [](const InitialGameStateExtractor &e) {
-	     for (auto &imagePackStrings : e.unitImagePackPaths)
-	     {
-		     GameState s;
-		     LogInfo("Extracting image pack \"%s\"", imagePackStrings.first);
-
-		     auto imagePack = e.extractImagePack(s, imagePackStrings.second, false);
-		     if (!imagePack)
-		     {
-			     LogError("Failed to extract image pack \"%s\"", imagePackStrings.first);
-		     }
-		     else
-		     {
-			     if (!imagePack->saveImagePack(BattleUnitImagePack::getImagePackPath() + "/" +
-			                                       imagePackStrings.first,
-			                                   true))
-			     {
-				     LogError("Failed to save image pack \"%s\"", imagePackStrings.first);
-			     }
-		     }
-	     }
+     [](const InitialGameStateExtractor &e, std::vector<ExtractJob> &jobs) {
+	     addImagePacks(jobs, e, e.unitImagePackPaths, false);
 	 }},
     {"item_image_packs",
-     [](const InitialGameStateExtractor &e) {
+     [](const InitialGameStateExtractor &e, std::vector<ExtractJob> &jobs) {
 
 	     int itemImagePacksCount = e.getItemImagePacksCount();
 	     for (int i = 0; i < itemImagePacksCount; i++)
 	     {
-		     GameState s;
-		     LogInfo("Extracting item image pack \"%d\"", i);
-
-		     auto imagePack = e.extractItemImagePack(s, i);
-		     if (!imagePack)
-		     {
-			     LogError("Failed to extract  item image pack \"%d\"", i);
-		     }
-		     else
-		     {
-			     if (!imagePack->saveImagePack(
-			             format("%s%s%d", BattleUnitImagePack::getImagePackPath(), "/item", i),
-			             true))
-			     {
-				     LogError("Failed to save  item image pack \"%d\"", i);
-			     }
-		     }
+		     jobs.emplace_back(
+		         format("item image pack %d", i), battleInputs,
+		         [&e, i](std::vector<UString> &outputs) { extractItemImagePack(e, i, outputs); });
 	     }
 	 }},
     {"unit_shadow_packs",
-     [](const InitialGameStateExtractor &e) {
-	     for (auto &imagePackStrings : e.unitShadowPackPaths)
-	     {
-		     GameState s;
-		     LogInfo("Extracting image pack \"%s\"", imagePackStrings.first);
-
-		     auto imagePack = e.extractImagePack(s, imagePackStrings.second, true);
-		     if (!imagePack)
-		     {
-			     LogError("Failed to extract image pack \"%s\"", imagePackStrings.first);
-		     }
-		     else
-		     {
-			     if (!imagePack->saveImagePack(BattleUnitImagePack::getImagePackPath() + "/" +
-			                                       imagePackStrings.first,
-			                                   true))
-			     {
-				     LogError("Failed to save image pack \"%s\"", imagePackStrings.first);
-			     }
-		     }
-	     }
+     [](const InitialGameStateExtractor &e, std::vector<ExtractJob> &jobs) {
+	     addImagePacks(jobs, e, e.unitShadowPackPaths, true);
 	 }},
     {"unit_animation_packs",
-     [](const InitialGameStateExtractor &e) {
+     [](const InitialGameStateExtractor &e, std::vector<ExtractJob> &jobs) {
 	     for (auto &animationPackStrings : e.unitAnimationPackPaths)
 	     {
-		     GameState s;
-		     LogInfo("Extracting animation pack \"%s\"", animationPackStrings.first);
-
-		     auto animationPack =
-		         e.extractAnimationPack(s, animationPackStrings.second, animationPackStrings.first);
-		     if (!animationPack)
-		     {
-			     LogError("Failed to extract animation pack \"%s\"", animationPackStrings.first);
-		     }
-		     else
-		     {
-			     if (!animationPack->saveAnimationPack(
-			             BattleUnitAnimationPack::getAnimationPackPath() + "/" +
-			                 animationPackStrings.first,
-			             true))
-			     {
-				     LogError("Failed to save animation pack \"%s\"", animationPackStrings.first);
-			     }
-		     }
+		     auto name = animationPackStrings.first;
+		     auto path = animationPackStrings.second;
+		     jobs.emplace_back("animation pack " + name, battleInputs,
+		                       [&e, name, path](std::vector<UString> &outputs) {
+			                       extractAnimationPack(e, name, path, outputs);
+			                   });
 	     }
 	 }},
 
     {"battle_map_tilesets",
-     [](const InitialGameStateExtractor &e) {
+     [](const InitialGameStateExtractor &e, std::vector<ExtractJob> &jobs) {
 	     for (auto &tileSetName : e.battleMapPaths)
 	     {
 		     // Some indices are empty?
 		     if (tileSetName.empty())
 			     continue;
-		     GameState s;
-		     LogInfo("Extracting tileset \"%s\"", tileSetName);
-
-		     auto tileSet = e.extractTileSet(s, tileSetName);
-		     if (!tileSet)
-		     {
-			     LogError("Failed to extract tileset \"%s\"", tileSetName);
-		     }
-		     else
-		     {
-			     if (!tileSet->saveTileset(BattleMapTileset::getTilesetPath() + "/" + tileSetName,
-			                               true))
-			     {
-				     LogError("Failed to save tileset \"%s\"", tileSetName);
-			     }
-		     }
+		     auto inputs = battleInputs;
+		     inputs.push_back("xcom3/maps/" + tileSetName);
+		     jobs.emplace_back("tileset " + tileSetName, inputs,
+		                       [&e, tileSetName](std::vector<UString> &outputs) {
+			                       extractTileSet(e, tileSetName, outputs);
+			                   });
 	     }
 	 }},
     {"battle_map_sectors",
-     [](const InitialGameStateExtractor &e) {
+     [](const InitialGameStateExtractor &e, std::vector<ExtractJob> &jobs) {
 	     for (auto &mapName : e.battleMapPaths)
 	     {
 		     // Some indices are empty?
 		     if (mapName.empty())
 			     continue;
-		     GameState s;
-		     LogInfo("Extracting map sectors from \"%s\"", mapName);
-
-		     auto sectors = e.extractMapSectors(s, mapName);
-		     LogInfo("Extracted %u sectors from \"%s\"", (unsigned)sectors.size(), mapName);
-		     if (sectors.empty())
-		     {
-			     LogError("Failed to sectors from map \"%s\"", mapName);
-		     }
-		     for (auto &sectorPair : sectors)
-		     {
-			     auto &sectorName = sectorPair.first;
-			     auto &sector = sectorPair.second;
-			     auto path = BattleMapSectorTiles::getMapSectorPath();
-			     if (!sector->saveSector(path + "/" + sectorName, true))
-			     {
-				     LogError("Failed to save map sector \"%s\"", sectorName);
-			     }
-		     }
+		     auto inputs = battleInputs;
+		     inputs.push_back("xcom3/maps/" + mapName);
+		     jobs.emplace_back("map sectors " + mapName, inputs,
+		                       [&e, mapName](std::vector<UString> &outputs) {
+			                       extractMapSectors(e, mapName, outputs);
+			                   });
 	     }
 	 }},
 };
 
+// Each thread takes the next job not yet started, so one that finishes early just moves on to more
+// work rather than waiting on the others
+static void runJobs(unsigned int jobCount, unsigned int threadCount,
+                    std::function<void(unsigned int job)> run)
+{
+	std::atomic<unsigned int> nextJob(0);
+	auto worker = [jobCount, &nextJob, &run]() {
+		while (true)
+		{
+			auto jobIndex = nextJob++;
+			if (jobIndex >= jobCount)
+			{
+				return;
+			}
+			run(jobIndex);
+		}
+	};
+
+	std::vector<std::thread> threads;
+	for (unsigned int i = 1; i < threadCount; i++)
+	{
+		threads.emplace_back(worker);
+	}
+	// The main thread does its share too
+	worker();
+	for (auto &thread : threads)
+	{
+		thread.join();
+	}
+}
+
+// Hashes every job's inputs, reading each file once however many jobs use it
+static void hashInputs(std::vector<ExtractJob> &jobs, InputHasher &hasher,
+                       unsigned int threadCount)
+{
+	TRACE_FN;
+	std::set<UString> fileSet;
+	for (auto &job : jobs)
+	{
+		for (auto &input : job.inputs)
+		{
+			auto files = hasher.listFiles(input);
+			fileSet.insert(files.begin(), files.end());
+		}
+	}
+	std::vector<UString> files(fileSet.begin(), fileSet.end());
+	LogWarning("Hashing %u input files", (unsigned)files.size());
+	runJobs(files.size(), threadCount,
+	        [&files, &hasher](unsigned int file) { hasher.hashFile(files[file]); });
+	for (auto &job : jobs)
+	{
+		job.inputHash = hasher.hashInputs(job.inputs);
+	}
+}
+
 int main(int argc, char *argv[])
 {
 	ConfigOptionString extractList(
 	    "Extractor", "extract",
 	    "Comma-separated list of things to extract  - \"all\" is special meaning everything",
 	    "all");
+	ConfigOptionInt jobCount("Extractor", "jobs",
+	                         "Number of things to extract at once - 0 means one per CPU", 0);
+	ConfigOptionBool forceExtract("Extractor", "force",
+	                              "Extract everything, even if unchanged since the last run",
+	                              false);
 
 	if (config().parseOptions(argc, argv))
 	{
@@ -250,8 +423,7 @@ int main(int argc, char *argv[])
 	}
 	auto extractListString = extractList.get();
 
-	std::list<std::pair<UString, std::function<void(const InitialGameStateExtractor &e)>>>
-	    extractorsToRun;
+	std::list<std::pair<UString, ExtractorFn>> extractorsToRun;
 
 	if (extractListString == "all")
 	{
@@ -281,11 +453,66 @@ int main(int argc, char *argv[])
 	TraceObj mainTrace("main");
 	Framework fw(UString(argv[0]), false);
 	InitialGameStateExtractor initialGameStateExtractor;
+	std::vector<ExtractJob> jobs;
+	// Each extractor has its own manifest, as the build runs them as separate processes at once
+	std::map<UString, up<ExtractorManifest>> manifests;
 	for (auto ePair : extractorsToRun)
 	{
-		LogWarning("Running %s", ePair.first);
-		TraceObj exTrace(ePair.first);
-		ePair.second(initialGameStateExtractor);
+		LogWarning("Queueing %s", ePair.first);
+		auto firstJob = jobs.size();
+		ePair.second(initialGameStateExtractor, jobs);
+		for (auto i = firstJob; i < jobs.size(); i++)
+		{
+			jobs[i].extractor = ePair.first;
+		}
+		manifests[ePair.first].reset(new ExtractorManifest(
+		    fw.getDataDir() + "/extractor_manifests/" + ePair.first + ".manifest"));
+	}
+
+	unsigned int threadCount = std::thread::hardware_concurrency();
+	if (jobCount.get() > 0)
+	{
+		threadCount = jobCount.get();
+	}
+	threadCount = std::max(1u, threadCount);
+
+	InputHasher hasher(fw.data->fs);
+	hashInputs(jobs, hasher, threadCount);
+	if (!forceExtract.get())
+	{
+		auto dirty =
+		    std::stable_partition(jobs.begin(), jobs.end(), [&manifests](const ExtractJob &job) {
+			    return !manifests.at(job.extractor)->isClean(job.name, job.inputHash);
+			});
+		for (auto job = dirty; job != jobs.end(); job++)
+		{
+			LogInfo("Skipping %s, unchanged since last extracted", job->name);
+		}
+		LogWarning("Skipping %u jobs unchanged since last extracted",
+		           (unsigned)(jobs.end() - dirty));
+		jobs.erase(dirty, jobs.end());
+	}
+	std::stable_partition(jobs.begin(), jobs.end(),
+	                      [](const ExtractJob &job) { return job.large; });
+
+	threadCount = std::max(1u, std::min(threadCount, (unsigned int)jobs.size()));
+	LogWarning("Running %u jobs on %u threads", (unsigned)jobs.size(), threadCount);
+	std::atomic<unsigned int> jobsFinished(0);
+	runJobs(jobs.size(), threadCount, [&jobs, &jobsFinished, &manifests](unsigned int jobIndex) {
+		auto &job = jobs[jobIndex];
+		std::vector<UString> outputs;
+		{
+			TraceObj jobTrace(job.name);
+			job.run(outputs);
+		}
+		manifests.at(job.extractor)->update(job.name, job.inputHash, outputs);
+		auto finished = ++jobsFinished;
+		LogWarning("[%u/%u] Finished %s", finished, (unsigned)jobs.size(), job.name);
+	});
+
+	for (auto &manifest : manifests)
+	{
+		manifest.second->save();
 	}
 
 	return 0;
@@ -0,0 +1,200 @@
+#include "tools/extractors/manifest.h"
+#include "framework/filesystem.h"
+#include "framework/fs.h"
+#include "framework/logger.h"
+#include "framework/trace.h"
+#include "library/strings_format.h"
+#include <algorithm>
+#include <fstream>
+
+// Disable automatic #pragma linking for boost - only enabled in msvc and that should provide boost
+// symbols as part of the module that uses it
+#define BOOST_ALL_NO_LIB
+#include <boost/uuid/sha1.hpp>
+
+namespace OpenApoc
+{
+
+// Bump this whenever a change to the extractors means everything extracted before needs redoing
+static const int EXTRACTOR_VERSION = 1;
+
+static UString toHexDigest(boost::uuids::detail::sha1 &sha)
+{
+	UString hashString;
+	unsigned int hash[5];
+	sha.get_digest(hash);
+	for (int i = 0; i < 5; i++)
+	{
+		hashString += format("%08x", hash[i]).str();
+	}
+	return hashString;
+}
+
+ExtractorManifest::ExtractorManifest(const UString &path) : path(path)
+{
+	std::ifstream file(path.str());
+	if (!file)
+	{
+		LogInfo("No extractor manifest at \"%s\"", path);
+		return;
+	}
+	std::string line;
+	while (std::getline(file, line))
+	{
+		// Job name, input hash then each output, tab separated
+		auto fields = UString(line).split("\t");
+		if (fields.size() < 2)
+		{
+			LogWarning("Ignoring bad line \"%s\" in extractor manifest \"%s\"", line, path);
+			continue;
+		}
+		auto &entry = this->entries[fields[0]];
+		entry.inputHash = fields[1];
+		entry.outputs.assign(fields.begin() + 2, fields.end());
+	}
+}
+
+bool ExtractorManifest::isClean(const UString &job, const UString &inputHash) const
+{
+	std::lock_guard<std::mutex> l(this->lock);
+	auto entry = this->entries.find(job);
+	if (entry == this->entries.end() || entry->second.inputHash != inputHash)
+	{
+		return false;
+	}
+	// A job that wrote nothing failed, so is worth trying again
+	if (entry->second.outputs.empty())
+	{
+		return false;
+	}
+	for (auto &output : entry->second.outputs)
+	{
+		if (!fs::exists(output.str()))
+		{
+			LogInfo("Output \"%s\" of \"%s\" missing", output, job);
+			return false;
+		}
+	}
+	return true;
+}
+
+void ExtractorManifest::update(const UString &job, const UString &inputHash,
+                               const std::vector<UString> &outputs)
+{
+	std::lock_guard<std::mutex> l(this->lock);
+	auto &entry = this->entries[job];
+	entry.inputHash = inputHash;
+	entry.outputs = outputs;
+}
+
+bool ExtractorManifest::save() const
+{
+	std::lock_guard<std::mutex> l(this->lock);
+	auto outPath = fs::path(this->path.str());
+	try
+	{
+		fs::create_directories(outPath.parent_path());
+	}
+	catch (fs::filesystem_error e)
+	{
+		LogWarning("create_directories failed with \"%s\"", e.what());
+	}
+	// Write it all out before replacing the old one, so an interrupted run can't leave a manifest
+	// claiming outputs are up to date
+	auto tempPath = this->path + ".tmp";
+	{
+		std::ofstream file(tempPath.str(), std::ios::trunc);
+		if (!file)
+		{
+			LogWarning("Failed to open \"%s\" for writing", tempPath);
+			return false;
+		}
+		for (auto &entryPair : this->entries)
+		{
+			file << entryPair.first.str() << "\t" << entryPair.second.inputHash.str();
+			for (auto &output : entryPair.second.outputs)
+			{
+				file << "\t" << output.str();
+			}
+			file << "\n";
+		}
+		if (!file)
+		{
+			LogWarning("Failed writing \"%s\"", tempPath);
+			return false;
+		}
+	}
+	try
+	{
+		fs::rename(tempPath.str(), this->path.str());
+	}
+	catch (fs::filesystem_error e)
+	{
+		LogWarning("Failed to replace extractor manifest \"%s\": \"%s\"", this->path, e.what());
+		return false;
+	}
+	return true;
+}
+
+InputHasher::InputHasher(FileSystem &fs) : fs(fs) {}
+
+std::vector<UString> InputHasher::listFiles(const UString &path)
+{
+	auto cached = this->filesInPath.find(path);
+	if (cached != this->filesInPath.end())
+	{
+		return cached->second;
+	}
+	std::vector<UString> files;
+	auto entries = this->fs.enumerateDirectory(path, "");
+	if (entries.empty())
+	{
+		// Either a file or an empty directory, and the empty directory won't open
+		files.push_back(path);
+	}
+	for (auto &entry : entries)
+	{
+		auto subFiles = this->listFiles(path + "/" + entry);
+		files.insert(files.end(), subFiles.begin(), subFiles.end());
+	}
+	// Directory listings don't come in any particular order
+	std::sort(files.begin(), files.end());
+	this->filesInPath[path] = files;
+	return files;
+}
+
+void InputHasher::hashFile(const UString &path)
+{
+	TRACE_FN_ARGS1("PATH", path);
+	UString hashString;
+	auto file = this->fs.open(path);
+	if (file)
+	{
+		auto data = file.readAll();
+		boost::uuids::detail::sha1 sha;
+		sha.process_bytes(data.get(), file.size());
+		hashString = toHexDigest(sha);
+	}
+	std::lock_guard<std::mutex> l(this->lock);
+	this->fileHashes[path] = hashString;
+}
+
+UString InputHasher::hashInputs(const std::vector<UString> &inputs)
+{
+	boost::uuids::detail::sha1 sha;
+	auto version = format("version %d\n", EXTRACTOR_VERSION).str();
+	sha.process_bytes(version.c_str(), version.size());
+	for (auto &input : inputs)
+	{
+		for (auto &file : this->listFiles(input))
+		{
+			auto fileHash = this->fileHashes.find(file);
+			LogAssert(fileHash != this->fileHashes.end());
+			auto line = file.str() + " " + fileHash->second.str() + "\n";
+			sha.process_bytes(line.c_str(), line.size());
+		}
+	}
+	return toHexDigest(sha);
+}
+
+}; // namespace OpenApoc
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "library/strings.h"
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace OpenApoc
+{
+
+class FileSystem;
+
+// Records what each extraction job was last made from, so a later run can skip any whose inputs
+// haven't changed. Each job stores a hash of its input files (and the extractor version) along
+// with the outputs it wrote, which all have to still be there for it to be skipped.
+class ExtractorManifest
+{
+  public:
+	ExtractorManifest(const UString &path);
+
+	bool isClean(const UString &job, const UString &inputHash) const;
+	// Safe to call from any thread
+	void update(const UString &job, const UString &inputHash, const std::vector<UString> &outputs);
+	bool save() const;
+
+  private:
+	class Entry
+	{
+	  public:
+		UString inputHash;
+		std::vector<UString> outputs;
+	};
+
+	UString path;
+	mutable std::mutex lock;
+	std::map<UString, Entry> entries;
+};
+
+// Hashes the contents of files read through the data filesystem, each only once however many jobs
+// use it
+class InputHasher
+{
+  public:
+	InputHasher(FileSystem &fs);
+
+	// Every file under 'path', or just 'path' if it's a file
+	std::vector<UString> listFiles(const UString &path);
+	// Safe to call from any thread
+	void hashFile(const UString &path);
+	// Combines the hashes of everything in 'inputs', whose files must all have been hashed already
+	UString hashInputs(const std::vector<UString> &inputs);
+
+  private:
+	FileSystem &fs;
+	std::mutex lock;
+	std::map<UString, std::vector<UString>> filesInPath;
+	std::map<UString, UString> fileHashes;
+};
+
+}; // namespace OpenApoc